@@ -0,0 +1,137 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+
+namespace Ox {
+	// Backend behind 'inhale', 'respire' and 'exhale'.
+	// Sizes passed to an Allocator already include the block header, and
+	// 'free'/'realloc' always receive the size the block was created with.
+	class Allocator {
+		public:
+			virtual ~Allocator(void) {};
+
+			// Must return memory aligned to 16 bytes, zero-filled if 'zero'.
+			virtual void *alloc(ulong n, bool zero, const char **err) = 0;
+			virtual void *realloc(void *src, ulong old_n, ulong n, const char **err) = 0;
+			virtual void free(void *p, ulong n) = 0;
+	};
+
+	// calloc/malloc/realloc/free.
+	class HeapAllocator : public Allocator {
+		public:
+			void *alloc(ulong n, bool zero, const char **err);
+			void *realloc(void *src, ulong old_n, ulong n, const char **err);
+			void free(void *p, ulong n);
+
+			static HeapAllocator *instance(void);
+	};
+
+	// Bump allocator. Blocks are only given back all at once, by 'reset' or
+	// by destroying the arena; freeing the most recent block rewinds the
+	// pointer. Not thread-safe.
+	class Arena : public Allocator {
+		private:
+			struct chunk_t {
+				chunk_t *prev;
+				ulong capacity;
+				ulong used;
+			};
+
+			chunk_t *top = nullptr;
+			ulong chunk_size;
+
+			chunk_t *grow(ulong n, const char **err);
+
+		public:
+			Arena(void);
+			Arena(ulong chunk_size);
+			~Arena(void);
+
+			Arena(const Arena &) = delete;
+			Arena &operator=(const Arena &) = delete;
+
+			void *alloc(ulong n, bool zero, const char **err);
+			void *realloc(void *src, ulong old_n, ulong n, const char **err);
+			void free(void *p, ulong n);
+
+			// Forgets every block, keeps the newest chunk around.
+			void reset(void);
+			// Forgets every block, gives every chunk back to the heap.
+			void release(void);
+
+			bool owns(const void *p);
+			ulong used(void);
+			ulong capacity(void);
+	};
+
+	// Size-class allocator for small blocks (up to 'max_block' bytes, header
+	// included); anything bigger goes to the heap. Each thread keeps its own
+	// free lists and refills them in batches from a shared lock-free pool, so
+	// the common path takes no lock. Slabs are kept for the process lifetime.
+	class PoolAllocator : public Allocator {
+		public:
+			static const uint num_classes = 8;
+			static const ulong min_block = 32;
+			static const ulong max_block = min_block << (num_classes - 1);
+
+			typedef struct stats_t {
+				// Served from the calling thread's cache.
+				u64 hits = 0;
+				// Needed a refill from the shared pool or a new slab.
+				u64 misses = 0;
+				// Too big for any size class.
+				u64 oversized = 0;
+				u64 slabs = 0;
+			} stats_t;
+
+			void *alloc(ulong n, bool zero, const char **err);
+			void *realloc(void *src, ulong old_n, ulong n, const char **err);
+			void free(void *p, ulong n);
+
+			// Per-thread hits are folded in on every refill and at thread
+			// exit, so the numbers may lag slightly behind.
+			stats_t stats(void);
+
+			static uint size_class(ulong n);
+			static PoolAllocator *instance(void);
+	};
+
+	// Thread-local allocator picked up by 'inhale'. Never NULL.
+	Allocator *current_allocator(void);
+	// Returns the previous one; NULL restores the heap.
+	Allocator *use_allocator(Allocator *a);
+
+	// Sets the current allocator for the lifetime of the object.
+	class ScopedAllocator {
+		private:
+			Allocator *previous;
+
+		public:
+			ScopedAllocator(Allocator &a) {
+				previous = use_allocator(&a);
+			};
+
+			~ScopedAllocator(void) {
+				(void)use_allocator(previous);
+			};
+
+			ScopedAllocator(const ScopedAllocator &) = delete;
+			ScopedAllocator &operator=(const ScopedAllocator &) = delete;
+	};
+};
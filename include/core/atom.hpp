@@ -0,0 +1,91 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include "thread.hpp"
+
+namespace Ox {
+	class StringPool;
+
+	// Immutable, reference-counted string owned by a StringPool. Two atoms
+	// from the same pool are equal if and only if they share a handle.
+	class Atom {
+		private:
+			void *handle = nullptr;
+
+			Atom(void *entry) : handle(entry) {};
+
+			friend class StringPool;
+
+		public:
+			Atom(void) {};
+			Atom(const Atom &other);
+			Atom(Atom &&other);
+			~Atom(void);
+
+			Atom &operator=(const Atom &other);
+			Atom &operator=(Atom &&other);
+
+			bool is_null(void) const { return handle == nullptr; };
+			const char *c_str(void) const;
+			ulong length(void) const;
+			u64 hash(void) const;
+
+			bool operator==(const Atom &other) const { return handle == other.handle; };
+			bool operator!=(const Atom &other) const { return handle != other.handle; };
+
+			operator const char *(void) const { return c_str(); };
+	};
+
+	// Thread-safe string interner. Entries live on the heap whatever the
+	// current allocator is, and go away with their last Atom.
+	class StringPool {
+		private:
+			static const uint num_shards = 16;
+
+			typedef struct shard_t {
+				Mutex lock;
+				void **buckets = nullptr;
+				ulong num_buckets = 0;
+				ulong size = 0;
+			} shard_t;
+
+			shard_t shards[num_shards];
+
+			int rehash(shard_t &s, Error &err);
+			void remove(void *entry);
+
+			friend class Atom;
+
+		public:
+			StringPool(void) {};
+			~StringPool(void);
+
+			StringPool(const StringPool &) = delete;
+			StringPool &operator=(const StringPool &) = delete;
+
+			Atom intern(const char *s, Error &err);
+			Atom intern(const char *s, ulong len, Error &err);
+
+			// Number of distinct strings alive.
+			ulong size(void);
+
+			static u64 hash(const char *s, ulong len);
+			static StringPool *global(void);
+	};
+};
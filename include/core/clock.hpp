@@ -0,0 +1,101 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+
+namespace Ox {
+	// Monotonic time. Ticks come from the TSC on x86 CPUs with an invariant
+	// one, calibrated against the OS clock on first use; anywhere else they
+	// are plain nanoseconds from clock_gettime or std::chrono.
+	class Clock {
+		public:
+			// Cheapest timestamp available, only meaningful through 'to_ns'.
+			static u64 ticks(void);
+			// Length of 'n' ticks in nanoseconds.
+			static u64 to_ns(u64 n);
+
+			// Nanoseconds since an arbitrary, fixed origin.
+			static u64 now(void);
+
+			// Whether ticks are TSC cycles.
+			static bool is_tsc(void);
+			static double ticks_per_ns(void);
+	};
+
+	// Measures elapsed time, possibly over several start/stop spans.
+	// Starts running when built.
+	class Stopwatch {
+		private:
+			u64 started = 0;
+			u64 accumulated = 0;
+			bool running = false;
+
+		public:
+			Stopwatch(void) {
+				start();
+			};
+
+			void start(void) {
+				if(running)
+					return;
+
+				running = true;
+				started = Clock::ticks();
+			};
+
+			void stop(void) {
+				if(!running)
+					return;
+
+				accumulated += Clock::ticks() - started;
+				running = false;
+			};
+
+			// Back to zero, stopped.
+			void reset(void) {
+				accumulated = 0;
+				running = false;
+			};
+
+			// Back to zero, running.
+			void restart(void) {
+				reset();
+				start();
+			};
+
+			bool is_running(void) {
+				return running;
+			};
+
+			u64 elapsed_ns(void) {
+				u64 n = accumulated;
+				if(running)
+					n += Clock::ticks() - started;
+
+				return Clock::to_ns(n);
+			};
+
+			u64 elapsed_us(void) {
+				return elapsed_ns() / 1000;
+			};
+
+			double elapsed_s(void) {
+				return elapsed_ns() / 1e9;
+			};
+	};
+};
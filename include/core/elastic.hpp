@@ -17,39 +17,115 @@
 
 #pragma once
 #include "../nuclei.hpp"
+#include "stats.hpp"
+#include "span.hpp"
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace Ox {
-	// Dynamic array.
+	// Whether a T can be moved around with 'respire'/memcpy. Specialise it
+	// for types that are safe to relocate bytewise but not trivially
+	// copyable (e.g. a type owning a heap pointer that never points into
+	// itself).
 	template<typename T>
-	class Elastic {
-		private:
-			T *handle_data = nullptr;
-			T handle_invalid;
-			long handle_size = 0;
-			long handle_capacity = 0;
+	struct is_relocatable : std::is_trivially_copyable<T> {};
+
+	// Capacity strategies for Elastic. 'grow' returns a capacity of at least
+	// 'needed'; 'shrink' returns the capacity to settle on once 'size' items
+	// are left, 'capacity' meaning "leave it alone".
+	namespace ElasticPolicy {
+		// Grows by Num/Den; halves as soon as less than half is used.
+		template<long Num = 3, long Den = 2>
+		struct Geometric {
+			static long grow(long capacity, long needed) {
+				long s = capacity * Num / Den + 3;
+				return s < needed ? needed : s;
+			};
+
+			static long shrink(long size, long capacity) {
+				return size < (capacity >> 1) ? capacity * Den / Num : capacity;
+			};
+		};
+
+		// Grows by Num/Den and never gives memory back.
+		template<long Num = 3, long Den = 2>
+		struct NoShrink {
+			static long grow(long capacity, long needed) {
+				return Geometric<Num, Den>::grow(capacity, needed);
+			};
+
+			static long shrink(long size, long capacity) {
+				(void)size;
+				return capacity;
+			};
+		};
+
+		// Grows by Num/Den; shrinks only under a quarter of use, down to
+		// twice the size, so pushes and pops around one boundary never
+		// reallocate back and forth.
+		template<long Num = 3, long Den = 2>
+		struct Hysteresis {
+			static long grow(long capacity, long needed) {
+				return Geometric<Num, Den>::grow(capacity, needed);
+			};
 
-			long suggest_grow(void) {
-				long s	= handle_capacity
-						+ (handle_capacity >> 2)
-						+ (handle_capacity >> 4)
-						+ (handle_capacity >> 6)
-						+ (handle_capacity >> 8)
+			static long shrink(long size, long capacity) {
+				return size < (capacity >> 2) ? size << 1 : capacity;
+			};
+		};
+
+		// What Elastic used to do: ~1.33x growth, eager shrinking.
+		struct Legacy {
+			static long grow(long capacity, long needed) {
+				long s	= capacity
+						+ (capacity >> 2)
+						+ (capacity >> 4)
+						+ (capacity >> 6)
+						+ (capacity >> 8)
 						+ 3;
 
 				if(s < 0) s = 0;
-				return s;
+				return s < needed ? needed : s;
 			};
 
-			long suggest_shrink(void) {
-				long s	= handle_capacity
-						-((handle_capacity >> 2)
-						+ (handle_capacity >> 4)
-						+ (handle_capacity >> 6)
-						+ (handle_capacity >> 8));
+			static long shrink(long size, long capacity) {
+				if(size >= (capacity >> 1))
+					return capacity;
+
+				long s	= capacity
+						-((capacity >> 2)
+						+ (capacity >> 4)
+						+ (capacity >> 6)
+						+ (capacity >> 8));
 
 				if(s < 0) s = 0;
 				return s;
 			};
+		};
+	};
+
+	// Dynamic array.
+	template<typename T, typename Policy = ElasticPolicy::Hysteresis<>>
+	class Elastic {
+		private:
+			T *handle_data = nullptr;
+			T handle_invalid;
+			long handle_size = 0;
+			long handle_capacity = 0;
+
+			void destroy(long from, long to) {
+				if constexpr(!std::is_trivially_destructible<T>::value)
+					for(long i = from; i < to; i++)
+						handle_data[i].~T();
+			};
+
+			T invalid(void) {
+				if constexpr(std::is_copy_constructible<T>::value)
+					return handle_invalid;
+				else
+					return T();
+			};
 
 		public:
 			Ox::Error error;
@@ -60,7 +136,31 @@ namespace Ox {
 
 			Elastic(T default_invalid) {
 				clear();
-				handle_invalid = default_invalid;
+				handle_invalid = std::move(default_invalid);
+			};
+
+			Elastic(const Elastic &) = delete;
+			Elastic &operator=(const Elastic &) = delete;
+
+			Elastic(Elastic &&other) {
+				*this = std::move(other);
+			};
+
+			Elastic &operator=(Elastic &&other) {
+				if(this == &other)
+					return *this;
+
+				clear();
+
+				handle_data = other.handle_data;
+				handle_size = other.handle_size;
+				handle_capacity = other.handle_capacity;
+				handle_invalid = std::move(other.handle_invalid);
+
+				other.handle_data = nullptr;
+				other.handle_size = other.handle_capacity = 0;
+
+				return *this;
 			};
 
 			~Elastic(void) {
@@ -68,46 +168,113 @@ namespace Ox {
 			};
 
 			void clear(void) {
-				if(handle_data != nullptr)
+				if(handle_data != nullptr) {
+					destroy(0, handle_size);
 					exhale(handle_data);
+				}
 
 				handle_data = nullptr;
 				handle_size = handle_capacity = 0;
 			};
 
-			long fill(T item) {
-				for(long i = 0; i < handle_capacity; i++)
-					handle_data[i] = item;
+			// Trivially copyable items fill the whole capacity, as they always
+			// did; anything else only overwrites the items in use.
+			long fill(const T &item) {
+				if constexpr(std::is_trivially_copyable<T>::value) {
+					for(long i = 0; i < handle_capacity; i++)
+						handle_data[i] = item;
 
-				return handle_capacity;
+					return handle_capacity;
+				} else {
+					for(long i = 0; i < handle_size; i++)
+						handle_data[i] = item;
+
+					return handle_size;
+				}
 			};
 
-			long push_end(T item, Ox::Error &err) {
+			template<typename... Args>
+			long emplace_end(Ox::Error &err, Args &&...args) {
 				if(err != nullptr)
 					return -1;
 
-				if(handle_size >= handle_capacity)
-					if(resize(suggest_grow(), err) < 0)
+				if(handle_size >= handle_capacity) {
+					// 'args' may point into the array, build the item first.
+					T item(std::forward<Args>(args)...);
+
+					if(resize(Policy::grow(handle_capacity, handle_size + 1), err) < 0)
 						return -1;
 
-				handle_data[handle_size] = item;
+					new (&handle_data[handle_size]) T(std::move(item));
+				} else {
+					new (&handle_data[handle_size]) T(std::forward<Args>(args)...);
+				}
+
 				handle_size++;
 				return handle_size;
+			}
+
+			long push_end(const T &item, Ox::Error &err) {
+				return emplace_end(err, item);
+			};
+
+			long push_end(T &&item, Ox::Error &err) {
+				return emplace_end(err, std::move(item));
+			};
+
+			// Copies 'n' items with a single growth step.
+			long append(const T *items, long n, Ox::Error &err) {
+				if(err != nullptr)
+					return -1;
+
+				if(n < 0 || (items == nullptr && n > 0)) {
+					err = "Invalid 'items' or 'n'";
+					return -1;
+				}
+
+				if(handle_size + n > handle_capacity) {
+					long s = Policy::grow(handle_capacity, handle_size + n);
+
+					// 'items' may point into the array.
+					if(items >= handle_data && items < handle_data + handle_size) {
+						Elastic<T, Policy> copy;
+						if(copy.append(items, n, err) < 0)
+							return -1;
+
+						return append(copy.handle_data, n, err);
+					}
+
+					if(resize(s, err) < 0)
+						return -1;
+				}
+
+				if constexpr(std::is_trivially_copyable<T>::value) {
+					for(long i = 0; i < n; i++)
+						handle_data[handle_size + i] = items[i];
+				} else {
+					for(long i = 0; i < n; i++)
+						new (&handle_data[handle_size + i]) T(items[i]);
+				}
+
+				handle_size += n;
+				return handle_size;
 			};
 
 			T pop_end(Ox::Error &err) {
 				if(handle_size <= 0) {
 					err = "Out of bonds";
-					return handle_invalid;
+					return invalid();
 				}
 
-				T item = handle_data[handle_size];
-				handle_data[handle_size] = handle_invalid;
 				handle_size--;
+				T item = std::move(handle_data[handle_size]);
+				destroy(handle_size, handle_size + 1);
 
-				if(handle_size < (handle_capacity >> 1)) {
+				// Emptying out keeps the block around, 'clear' gives it back.
+				long s = Policy::shrink(handle_size, handle_capacity);
+				if(s != handle_capacity && s > 0) {
 					Ox::Error meh;
-					(void)resize(suggest_shrink(), meh);
+					(void)resize(s < handle_size ? handle_size : s, meh);
 					(void)meh;
 				}
 
@@ -143,19 +310,39 @@ namespace Ox {
 				if(n == handle_capacity)
 					return 0;
 
-				T *dest = handle_data == nullptr
-					? inhale<T>(n, err)
-					: respire<T>(handle_data, n, err);
+				OX_ALLOC_TAG("elastic");
 
-				if(dest == nullptr)
-					return -1;
+				if(n < handle_size) {
+					destroy(n, handle_size);
+					handle_size = n;
+				}
+
+				T *dest;
+
+				if constexpr(is_relocatable<T>::value) {
+					dest = handle_data == nullptr
+						? inhale_raw<T>(n, err)
+						: respire<T>(handle_data, n, err);
+
+					if(dest == nullptr)
+						return -1;
+				} else {
+					dest = inhale_raw<T>(n, err);
+					if(dest == nullptr)
+						return -1;
+
+					for(long i = 0; i < handle_size; i++) {
+						new (&dest[i]) T(std::move(handle_data[i]));
+						handle_data[i].~T();
+					};
+
+					if(handle_data != nullptr)
+						exhale(handle_data);
+				}
 
 				handle_data = dest;
 				handle_capacity = n;
 
-				if(handle_capacity < handle_size)
-					handle_size = handle_capacity;
-
 				return 0;
 			};
 
@@ -166,8 +353,26 @@ namespace Ox {
 				return resize(n, err);
 			};
 
-			// Sets this->error
-			T &operator[](long n) { return at(n, error); };
+			int shrink_to_fit(Ox::Error &err) {
+				return resize(handle_size, err);
+			};
+
+			// Checked in debug builds, setting this->error; unchecked otherwise.
+			// Same builds as ox_assert.
+			T &operator[](long n) {
+				#if defined(OX_DEBUG) || !defined(NDEBUG) || defined(OX_ENABLE_ASSERT)
+					return at(n, error);
+				#else
+					return handle_data[n];
+				#endif
+			};
+
+			T *begin(void) { return handle_data; };
+			T *end(void) { return handle_data + handle_size; };
+
+			Span<T> span(void) {
+				return Span<T>(handle_data, handle_size);
+			};
 
 			bool is_empty(void) {
 				return handle_size <= 0;
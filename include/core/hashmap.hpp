@@ -0,0 +1,450 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include "stats.hpp"
+#include "string.hpp"
+#include "atom.hpp"
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if !defined(OX_DISABLE_SIMD) && defined(__SSE2__) && ox_has_include(<emmintrin.h>)
+	#define OX_HASHMAP_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace Ox {
+	// Default hashes for HashMap; specialise it, or pass any functor with a
+	// 'u64 operator()(const K &) const', for other keys. The map mixes the
+	// result again, so an identity-like hash is fine.
+	template<typename K, typename = void>
+	struct Hash;
+
+	template<typename K>
+	struct Hash<K, typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value>::type> {
+		u64 operator()(const K &key) const { return (u64)key; };
+	};
+
+	template<typename K>
+	struct Hash<K *> {
+		u64 operator()(K *key) const { return (u64)(pointer_t)key; };
+	};
+
+	template<>
+	struct Hash<String> {
+		u64 operator()(const String &key) const {
+			return StringPool::hash(key.c_str(), key.length());
+		};
+	};
+
+	template<>
+	struct Hash<Atom> {
+		u64 operator()(const Atom &key) const { return key.hash(); };
+	};
+
+	// Control bytes of 16 slots, looked at together (SSE2 where available).
+	// A byte is either empty, deleted or the top 7 bits of a slot's hash.
+	struct __ox_hashmap_group_t {
+		static const i8 empty = -128;
+		static const i8 deleted = -2;
+		static const long width = 16;
+
+		#ifdef OX_HASHMAP_SSE2
+			__m128i ctrl;
+
+			__ox_hashmap_group_t(const i8 *p) {
+				ctrl = _mm_load_si128((const __m128i *)p);
+			};
+
+			uint match(i8 h2) const {
+				return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+			};
+
+			uint match_empty(void) const {
+				return match(empty);
+			};
+
+			uint match_free(void) const {
+				return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+			};
+		#else
+			const i8 *ctrl;
+
+			__ox_hashmap_group_t(const i8 *p) : ctrl(p) {};
+
+			uint match(i8 h2) const {
+				uint m = 0;
+				for(long i = 0; i < width; i++)
+					m |= (uint)(ctrl[i] == h2) << i;
+				return m;
+			};
+
+			uint match_empty(void) const {
+				return match(empty);
+			};
+
+			uint match_free(void) const {
+				uint m = 0;
+				for(long i = 0; i < width; i++)
+					m |= (uint)(ctrl[i] < -1) << i;
+				return m;
+			};
+		#endif
+	};
+
+	// Open-addressing hash map, SwissTable style: slots come in groups of 16
+	// whose control bytes are probed at once, groups being visited in
+	// triangular order. Keeps at most 7/8 of the slots in use.
+	template<typename K, typename V, typename H = Hash<K>>
+	class HashMap {
+		public:
+			typedef struct entry_t {
+				K key;
+				V value;
+			} entry_t;
+
+		private:
+			typedef __ox_hashmap_group_t group_t;
+
+			i8 *handle_ctrl = nullptr;
+			entry_t *handle_slots = nullptr;
+			long handle_size = 0;
+			long handle_capacity = 0;
+			long handle_tombstones = 0;
+			V handle_invalid;
+			H hasher;
+
+			static_assert(alignof(entry_t) <= 16, "HashMap entries can't be over-aligned");
+
+			u64 hash(const K &key) const {
+				u64 h = hasher(key);
+				h ^= h >> 33;
+				h *= 0xff51afd7ed558ccd;
+				h ^= h >> 33;
+				return h;
+			};
+
+			static i8 h2(u64 h) {
+				return (i8)(h >> 57);
+			};
+
+			long find_index(const K &key, u64 h) const {
+				if(handle_capacity == 0)
+					return -1;
+
+				long mask = handle_capacity / group_t::width - 1;
+				long g = (long)(h >> 7) & mask;
+
+				for(long step = 1; step <= mask + 1; step++) {
+					const i8 *ctrl = handle_ctrl + g * group_t::width;
+					group_t group(ctrl);
+
+					for(uint m = group.match(h2(h)); m != 0; m &= m - 1) {
+						long i = g * group_t::width + __builtin_ctz(m);
+						if(handle_slots[i].key == key)
+							return i;
+					};
+
+					if(group.match_empty() != 0)
+						return -1;
+
+					g = (g + step) & mask;
+				};
+
+				return -1;
+			};
+
+			// First empty or deleted slot along the probe sequence.
+			long find_free(u64 h) const {
+				long mask = handle_capacity / group_t::width - 1;
+				long g = (long)(h >> 7) & mask;
+
+				for(long step = 1; ; step++) {
+					uint m = group_t(handle_ctrl + g * group_t::width).match_free();
+					if(m != 0)
+						return g * group_t::width + __builtin_ctz(m);
+
+					g = (g + step) & mask;
+				};
+			};
+
+			int rehash(long capacity, Error &err) {
+				if(err != nullptr)
+					return -1;
+
+				OX_ALLOC_TAG("hashmap");
+
+				// Control bytes first, the slots right after them.
+				u8 *block = inhale_raw<u8>(capacity + capacity * sizeof(entry_t), err);
+				if(block == nullptr)
+					return -1;
+
+				i8 *old_ctrl = handle_ctrl;
+				entry_t *old_slots = handle_slots;
+				long old_capacity = handle_capacity;
+
+				handle_ctrl = (i8 *)block;
+				handle_slots = (entry_t *)(block + capacity);
+				handle_capacity = capacity;
+				handle_tombstones = 0;
+
+				for(long i = 0; i < capacity; i++)
+					handle_ctrl[i] = group_t::empty;
+
+				for(long i = 0; i < old_capacity; i++) {
+					if(old_ctrl[i] < 0)
+						continue;
+
+					u64 h = hash(old_slots[i].key);
+					long j = find_free(h);
+
+					handle_ctrl[j] = h2(h);
+					new (&handle_slots[j]) entry_t(std::move(old_slots[i]));
+					old_slots[i].~entry_t();
+				};
+
+				if(old_ctrl != nullptr)
+					exhale(old_ctrl);
+
+				return 0;
+			};
+
+			// Slot for a key that isn't in the map yet.
+			long claim(u64 h, Error &err) {
+				if((handle_size + handle_tombstones + 1) * 8 > handle_capacity * 7) {
+					long capacity = handle_capacity < group_t::width ? group_t::width : handle_capacity;
+
+					// Mostly tombstones: cleaning up at the same size will do.
+					if((handle_size + 1) * 16 > capacity * 7)
+						capacity <<= 1;
+
+					if(rehash(capacity, err) < 0)
+						return -1;
+				}
+
+				long i = find_free(h);
+				if(handle_ctrl[i] == group_t::deleted)
+					handle_tombstones--;
+
+				handle_ctrl[i] = h2(h);
+				handle_size++;
+
+				return i;
+			};
+
+		public:
+			class iterator {
+				private:
+					HashMap *map;
+					long index;
+
+					void skip(void) {
+						while(index < map->handle_capacity && map->handle_ctrl[index] < 0)
+							index++;
+					};
+
+				public:
+					iterator(HashMap *m, long i) : map(m), index(i) { skip(); };
+
+					entry_t &operator*(void) const { return map->handle_slots[index]; };
+					entry_t *operator->(void) const { return &map->handle_slots[index]; };
+
+					iterator &operator++(void) {
+						index++;
+						skip();
+						return *this;
+					};
+
+					bool operator==(const iterator &other) const { return index == other.index; };
+					bool operator!=(const iterator &other) const { return index != other.index; };
+			};
+
+			Ox::Error error;
+
+			HashMap(void) {};
+
+			HashMap(H h) : hasher(std::move(h)) {};
+
+			HashMap(const HashMap &) = delete;
+			HashMap &operator=(const HashMap &) = delete;
+
+			HashMap(HashMap &&other) {
+				*this = std::move(other);
+			};
+
+			HashMap &operator=(HashMap &&other) {
+				if(this == &other)
+					return *this;
+
+				release();
+
+				handle_ctrl = other.handle_ctrl;
+				handle_slots = other.handle_slots;
+				handle_size = other.handle_size;
+				handle_capacity = other.handle_capacity;
+				handle_tombstones = other.handle_tombstones;
+				hasher = std::move(other.hasher);
+
+				other.handle_ctrl = nullptr;
+				other.handle_slots = nullptr;
+				other.handle_size = other.handle_capacity = other.handle_tombstones = 0;
+
+				return *this;
+			};
+
+			~HashMap(void) {
+				release();
+			};
+
+			// Drops every entry, keeping the memory.
+			void clear(void) {
+				for(long i = 0; i < handle_capacity; i++) {
+					if(handle_ctrl[i] >= 0)
+						handle_slots[i].~entry_t();
+
+					handle_ctrl[i] = group_t::empty;
+				};
+
+				handle_size = handle_tombstones = 0;
+			};
+
+			// Drops every entry and gives the memory back.
+			void release(void) {
+				if(handle_ctrl == nullptr)
+					return;
+
+				clear();
+				exhale(handle_ctrl);
+
+				handle_ctrl = nullptr;
+				handle_slots = nullptr;
+				handle_capacity = 0;
+			};
+
+			// Makes room for 'n' entries without rehashing.
+			int reserve(long n, Error &err) {
+				if(err != nullptr)
+					return -1;
+
+				long capacity = group_t::width;
+				while(n * 8 > capacity * 7)
+					capacity <<= 1;
+
+				if(capacity <= handle_capacity)
+					return 0;
+
+				return rehash(capacity, err);
+			};
+
+			// NULL if 'key' isn't there.
+			V *find(const K &key) {
+				long i = find_index(key, hash(key));
+				return i < 0 ? nullptr : &handle_slots[i].value;
+			};
+
+			bool contains(const K &key) {
+				return find_index(key, hash(key)) >= 0;
+			};
+
+			V &at(const K &key, Error &err) {
+				if(err != nullptr)
+					return handle_invalid;
+
+				long i = find_index(key, hash(key));
+				if(i >= 0)
+					return handle_slots[i].value;
+
+				err = "No such key";
+				return handle_invalid;
+			};
+
+			// Returns 1 if 'key' was added, 0 if its value got replaced.
+			template<typename KK, typename VV>
+			int set(KK &&key, VV &&value, Error &err) {
+				if(err != nullptr)
+					return -1;
+
+				u64 h = hash(key);
+				long i = find_index(key, h);
+				if(i >= 0) {
+					handle_slots[i].value = std::forward<VV>(value);
+					return 0;
+				}
+
+				i = claim(h, err);
+				if(i < 0)
+					return -1;
+
+				new (&handle_slots[i]) entry_t { K(std::forward<KK>(key)), V(std::forward<VV>(value)) };
+				return 1;
+			}
+
+			// Value for 'key', default-constructed if it wasn't there.
+			V *emplace(const K &key, Error &err) {
+				if(err != nullptr)
+					return nullptr;
+
+				u64 h = hash(key);
+				long i = find_index(key, h);
+				if(i >= 0)
+					return &handle_slots[i].value;
+
+				i = claim(h, err);
+				if(i < 0)
+					return nullptr;
+
+				new (&handle_slots[i]) entry_t { K(key), V() };
+				return &handle_slots[i].value;
+			};
+
+			// Inserts when missing, sets this->error
+			V &operator[](const K &key) {
+				V *v = emplace(key, error);
+				return v == nullptr ? handle_invalid : *v;
+			};
+
+			bool remove(const K &key) {
+				long i = find_index(key, hash(key));
+				if(i < 0)
+					return false;
+
+				handle_slots[i].~entry_t();
+				handle_size--;
+
+				// A group with an empty slot stops every probe, so nothing
+				// can be looking past this one.
+				long g = i / group_t::width * group_t::width;
+				if(group_t(handle_ctrl + g).match_empty() != 0) {
+					handle_ctrl[i] = group_t::empty;
+				} else {
+					handle_ctrl[i] = group_t::deleted;
+					handle_tombstones++;
+				}
+
+				return true;
+			};
+
+			iterator begin(void) { return iterator(this, 0); };
+			iterator end(void) { return iterator(this, handle_capacity); };
+
+			long size(void) { return handle_size; };
+			long capacity(void) { return handle_capacity; };
+			bool is_empty(void) { return handle_size <= 0; };
+	};
+};
@@ -0,0 +1,215 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include "span.hpp"
+#include "threadpool.hpp"
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <utility>
+
+// Data-parallel helpers over a Span (see Elastic::span), each one splitting
+// the items in contiguous chunks run across a ThreadPool. Callbacks run
+// concurrently, they must not touch the same state without synchronisation.
+namespace Ox {
+	namespace Parallel {
+		// Smallest chunk worth handing to another thread.
+		static const long min_grain = 2048;
+
+		inline long __chunk_count(ThreadPool &pool, long n, long grain) {
+			long k = (long)pool.size() * 4;
+			long most = (n + grain - 1) / grain;
+
+			if(k > most) k = most;
+			return k < 1 ? 1 : k;
+		};
+
+		// First item of chunk 'c' out of 'k', spreading the remainder.
+		inline long __chunk_begin(long n, long k, long c) {
+			return c * (n / k) + (c < n % k ? c : n % k);
+		};
+
+		// Calls 'body(c, from, to)' for each of the 'k' chunks of [0, n).
+		template<typename F>
+		int __run_chunks(ThreadPool &pool, long n, long k, F &body, Ox::Error &err) {
+			struct ctx_t {
+				F *body;
+				long n;
+				long k;
+			} ctx = { &body, n, k };
+
+			return pool.run(err, k, [](void *user, long c) {
+				ctx_t *x = (ctx_t *)user;
+				(*x->body)(c, __chunk_begin(x->n, x->k, c), __chunk_begin(x->n, x->k, c + 1));
+			}, &ctx);
+		};
+
+		// Calls 'f(item)' on every item.
+		template<typename T, typename F>
+		int for_each(ThreadPool &pool, Span<T> items, F f, Ox::Error &err) {
+			if(err != nullptr)
+				return -1;
+
+			auto body = [&](long c, long from, long to) {
+				(void)c;
+				for(long i = from; i < to; i++)
+					f(items[i]);
+			};
+
+			long n = items.size();
+			return __run_chunks(pool, n, __chunk_count(pool, n, min_grain), body, err);
+		};
+
+		// Sets 'out[i]' to 'f(in[i])', both spans being the same size.
+		template<typename T, typename U, typename F>
+		int transform(ThreadPool &pool, Span<T> in, Span<U> out, F f, Ox::Error &err) {
+			if(err != nullptr)
+				return -1;
+
+			if(in.size() != out.size()) {
+				err = "'in' and 'out' differ in size";
+				return -1;
+			}
+
+			auto body = [&](long c, long from, long to) {
+				(void)c;
+				for(long i = from; i < to; i++)
+					out[i] = f(in[i]);
+			};
+
+			long n = in.size();
+			return __run_chunks(pool, n, __chunk_count(pool, n, min_grain), body, err);
+		};
+
+		// Folds the items with 'op', which must be associative; the order
+		// items are combined in isn't specified. Returns 'init' on error.
+		template<typename T, typename R, typename F>
+		R reduce(ThreadPool &pool, Span<T> items, R init, F op, Ox::Error &err) {
+			if(err != nullptr)
+				return init;
+
+			long n = items.size();
+			if(n <= 0)
+				return init;
+
+			long k = __chunk_count(pool, n, min_grain);
+
+			R *partial = inhale_raw<R>(k, err);
+			if(partial == nullptr)
+				return init;
+
+			// Chunks are never empty, each one starts from its first item.
+			auto body = [&](long c, long from, long to) {
+				R acc = R(items[from]);
+				for(long i = from + 1; i < to; i++)
+					acc = op(std::move(acc), items[i]);
+
+				new (&partial[c]) R(std::move(acc));
+			};
+
+			if(__run_chunks(pool, n, k, body, err) != 0) {
+				exhale(partial);
+				return init;
+			}
+
+			R result = std::move(init);
+			for(long c = 0; c < k; c++) {
+				result = op(std::move(result), partial[c]);
+				partial[c].~R();
+			};
+
+			exhale(partial);
+			return result;
+		};
+
+		// Sorts each chunk, then merges neighbours pairwise. Not stable.
+		template<typename T, typename Less>
+		int sort(ThreadPool &pool, Span<T> items, Less less, Ox::Error &err) {
+			if(err != nullptr)
+				return -1;
+
+			long n = items.size();
+			long k = __chunk_count(pool, n, min_grain);
+			T *base = items.data();
+
+			auto sorter = [&](long c, long from, long to) {
+				(void)c;
+				std::sort(base + from, base + to, less);
+			};
+
+			if(__run_chunks(pool, n, k, sorter, err) != 0)
+				return -1;
+
+			for(long w = 1; w < k; w <<= 1) {
+				struct ctx_t {
+					T *base;
+					Less *less;
+					long n, k, w;
+				} ctx = { base, &less, n, k, w };
+
+				long pairs = (k + 2 * w - 1) / (2 * w);
+
+				int rc = pool.run(err, pairs, [](void *user, long p) {
+					ctx_t *x = (ctx_t *)user;
+					long lo = p * 2 * x->w;
+					long mid = lo + x->w < x->k ? lo + x->w : x->k;
+					long hi = lo + 2 * x->w < x->k ? lo + 2 * x->w : x->k;
+
+					std::inplace_merge(
+						x->base + __chunk_begin(x->n, x->k, lo),
+						x->base + __chunk_begin(x->n, x->k, mid),
+						x->base + __chunk_begin(x->n, x->k, hi),
+						*x->less
+					);
+				}, &ctx);
+
+				if(rc != 0)
+					return -1;
+			};
+
+			return 0;
+		};
+
+		// Same as above, on ThreadPool::global().
+		template<typename T, typename F>
+		int for_each(Span<T> items, F f, Ox::Error &err) {
+			return for_each(ThreadPool::global(), items, f, err);
+		};
+
+		template<typename T, typename U, typename F>
+		int transform(Span<T> in, Span<U> out, F f, Ox::Error &err) {
+			return transform(ThreadPool::global(), in, out, f, err);
+		};
+
+		template<typename T, typename R, typename F>
+		R reduce(Span<T> items, R init, F op, Ox::Error &err) {
+			return reduce(ThreadPool::global(), items, std::move(init), op, err);
+		};
+
+		template<typename T, typename Less>
+		int sort(Span<T> items, Less less, Ox::Error &err) {
+			return sort(ThreadPool::global(), items, less, err);
+		};
+
+		template<typename T>
+		int sort(Span<T> items, Ox::Error &err) {
+			return sort(ThreadPool::global(), items, std::less<T>(), err);
+		};
+	};
+};
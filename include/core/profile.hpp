@@ -0,0 +1,75 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include "clock.hpp"
+
+namespace Ox {
+	class BasicIOStream;
+
+	// Scoped timing zones. Each thread appends the zones it closes to its own
+	// buffer without taking a lock; 'dump_json' turns all of them into Chrome
+	// trace events, to load in chrome://tracing or Perfetto.
+	namespace Profile {
+		typedef struct zone_t {
+			const char *name;
+			// Clock ticks.
+			u64 begin;
+			u64 end;
+		} zone_t;
+
+		void __record(const char *name, u64 begin, u64 end);
+
+		// Records the time between its construction and destruction.
+		// 'name' must outlive the program, a string literal is expected.
+		class Zone {
+			private:
+				const char *name;
+				u64 begin;
+
+			public:
+				Zone(const char *name) : name(name), begin(Clock::ticks()) {};
+
+				~Zone(void) {
+					__record(name, begin, Clock::ticks());
+				};
+
+				Zone(const Zone &) = delete;
+				Zone &operator=(const Zone &) = delete;
+		};
+
+		// Zones recorded so far, over every thread.
+		u64 count(void);
+		// Forgets every zone. No zone may close while it runs.
+		void clear(void);
+
+		// {"traceEvents":[...]}, one complete ("X") event per zone with
+		// microsecond timestamps starting at the earliest zone.
+		int dump_json(BasicIOStream &os, Error &err);
+	};
+
+	#define __OX_PROFILE_CONCAT2(a, b) a##b
+	#define __OX_PROFILE_CONCAT(a, b) __OX_PROFILE_CONCAT2(a, b)
+
+	// Only recorded when built with OX_PROFILE.
+	#ifdef OX_PROFILE
+		#define OX_PROFILE_ZONE(name) Ox::Profile::Zone __OX_PROFILE_CONCAT(__ox_profile_zone, __LINE__)(name)
+	#else
+		#define OX_PROFILE_ZONE(name) (void)0
+	#endif
+};
@@ -0,0 +1,356 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include <atomic>
+#include <new>
+#include <utility>
+
+namespace Ox {
+	inline ulong __ox_ring_capacity(ulong n) {
+		ulong c = 2;
+		while(c < n)
+			c <<= 1;
+
+		return c;
+	};
+
+	// Bounded lock-free queue for exactly one producer and one consumer
+	// thread. Each side keeps a stale copy of the other's index and only
+	// reloads it when the ring looks full (or empty).
+	template<typename T>
+	class SPSCRing {
+		private:
+			// Padded rather than aligned, rings may live in inhale'd memory.
+			T *handle_slots = nullptr;
+			ulong handle_mask = 0;
+			char handle_pad_slots[OX_CACHE_LINE];
+
+			std::atomic<ulong> handle_tail { 0 };
+			ulong handle_head_cache = 0;
+			char handle_pad_tail[OX_CACHE_LINE];
+
+			std::atomic<ulong> handle_head { 0 };
+			ulong handle_tail_cache = 0;
+			char handle_pad_head[OX_CACHE_LINE];
+
+			// Room for up to 'n' items, as seen by the producer.
+			ulong room(ulong tail, ulong n) {
+				if(handle_slots == nullptr)
+					return 0;
+
+				ulong free = handle_mask + 1 - (tail - handle_head_cache);
+				if(free < n) {
+					handle_head_cache = handle_head.load(std::memory_order_acquire);
+					free = handle_mask + 1 - (tail - handle_head_cache);
+				}
+
+				return free < n ? free : n;
+			};
+
+			// Items ready, up to 'n', as seen by the consumer.
+			ulong ready(ulong head, ulong n) {
+				if(handle_slots == nullptr)
+					return 0;
+
+				ulong used = handle_tail_cache - head;
+				if(used < n) {
+					handle_tail_cache = handle_tail.load(std::memory_order_acquire);
+					used = handle_tail_cache - head;
+				}
+
+				return used < n ? used : n;
+			};
+
+		public:
+			SPSCRing(void) {
+				(void)handle_pad_slots; (void)handle_pad_tail; (void)handle_pad_head;
+			};
+			~SPSCRing(void) {
+				release();
+			};
+
+			SPSCRing(const SPSCRing &) = delete;
+			SPSCRing &operator=(const SPSCRing &) = delete;
+
+			// Rounded up to a power of two.
+			int init(ulong capacity, Error &err) {
+				if(err != nullptr)
+					return -1;
+
+				if(handle_slots != nullptr) {
+					err = "Ring already initialized";
+					return -1;
+				}
+
+				capacity = __ox_ring_capacity(capacity);
+
+				handle_slots = inhale_raw<T>(capacity, err);
+				if(handle_slots == nullptr)
+					return -1;
+
+				handle_mask = capacity - 1;
+				return 0;
+			};
+
+			// Not thread-safe, drops whatever is left.
+			void release(void) {
+				if(handle_slots == nullptr)
+					return;
+
+				T item;
+				while(pop(item)) {};
+
+				exhale(handle_slots);
+				handle_slots = nullptr;
+				handle_mask = 0;
+			};
+
+			template<typename U>
+			bool push(U &&item) {
+				ulong tail = handle_tail.load(std::memory_order_relaxed);
+				if(room(tail, 1) == 0)
+					return false;
+
+				new (&handle_slots[tail & handle_mask]) T(std::forward<U>(item));
+				handle_tail.store(tail + 1, std::memory_order_release);
+
+				return true;
+			}
+
+			bool pop(T &item) {
+				ulong head = handle_head.load(std::memory_order_relaxed);
+				if(ready(head, 1) == 0)
+					return false;
+
+				T *slot = &handle_slots[head & handle_mask];
+				item = std::move(*slot);
+				slot->~T();
+
+				handle_head.store(head + 1, std::memory_order_release);
+				return true;
+			};
+
+			// Copies as many items as fit, publishing them at once.
+			ulong push_n(const T *items, ulong n) {
+				ulong tail = handle_tail.load(std::memory_order_relaxed);
+				n = room(tail, n);
+
+				for(ulong i = 0; i < n; i++)
+					new (&handle_slots[(tail + i) & handle_mask]) T(items[i]);
+
+				if(n > 0)
+					handle_tail.store(tail + n, std::memory_order_release);
+
+				return n;
+			};
+
+			// Moves up to 'n' items out, returns how many.
+			ulong pop_n(T *items, ulong n) {
+				ulong head = handle_head.load(std::memory_order_relaxed);
+				n = ready(head, n);
+
+				for(ulong i = 0; i < n; i++) {
+					T *slot = &handle_slots[(head + i) & handle_mask];
+					items[i] = std::move(*slot);
+					slot->~T();
+				};
+
+				if(n > 0)
+					handle_head.store(head + n, std::memory_order_release);
+
+				return n;
+			};
+
+			ulong capacity(void) { return handle_mask + 1; };
+
+			// Only a hint while the other side is running.
+			ulong size(void) {
+				return handle_tail.load(std::memory_order_acquire) - handle_head.load(std::memory_order_acquire);
+			};
+	};
+
+	// Bounded lock-free queue for any number of producers and consumers
+	// (Vyukov's design): every cell carries a sequence number telling which
+	// lap it is ready for, so each side only contends on its own index.
+	template<typename T>
+	class MPMCRing {
+		private:
+			typedef struct cell_t {
+				std::atomic<ulong> seq;
+				T item;
+			} cell_t;
+
+			cell_t *handle_cells = nullptr;
+			ulong handle_mask = 0;
+			char handle_pad_cells[OX_CACHE_LINE];
+
+			std::atomic<ulong> handle_tail { 0 };
+			char handle_pad_tail[OX_CACHE_LINE];
+
+			std::atomic<ulong> handle_head { 0 };
+			char handle_pad_head[OX_CACHE_LINE];
+			// Claims up to 'n' consecutive cells whose sequence is 'pos + i +
+			// lag', 'lag' being 0 for producers and 1 for consumers.
+			ulong claim(std::atomic<ulong> &index, ulong n, ulong lag, ulong &first) {
+				if(handle_cells == nullptr)
+					return 0;
+
+				ulong pos = index.load(std::memory_order_relaxed);
+
+				for(;;) {
+					ulong k = 0;
+					while(k < n) {
+						ulong seq = handle_cells[(pos + k) & handle_mask].seq.load(std::memory_order_acquire);
+						if(seq != pos + k + lag)
+							break;
+
+						k++;
+					};
+
+					if(k == 0) {
+						ulong seq = handle_cells[pos & handle_mask].seq.load(std::memory_order_acquire);
+
+						// Full (or empty): the cell is still a lap behind.
+						if((long)(seq - (pos + lag)) < 0)
+							return 0;
+
+						// Someone else got it, start over from where they left.
+						pos = index.load(std::memory_order_relaxed);
+						continue;
+					}
+
+					if(index.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed, std::memory_order_relaxed)) {
+						first = pos;
+						return k;
+					}
+				};
+			};
+
+		public:
+			MPMCRing(void) {
+				(void)handle_pad_cells; (void)handle_pad_tail; (void)handle_pad_head;
+			};
+			~MPMCRing(void) {
+				release();
+			};
+
+			MPMCRing(const MPMCRing &) = delete;
+			MPMCRing &operator=(const MPMCRing &) = delete;
+
+			// Rounded up to a power of two.
+			int init(ulong capacity, Error &err) {
+				if(err != nullptr)
+					return -1;
+
+				if(handle_cells != nullptr) {
+					err = "Ring already initialized";
+					return -1;
+				}
+
+				capacity = __ox_ring_capacity(capacity);
+
+				handle_cells = inhale_raw<cell_t>(capacity, err);
+				if(handle_cells == nullptr)
+					return -1;
+
+				for(ulong i = 0; i < capacity; i++)
+					new (&handle_cells[i].seq) std::atomic<ulong>(i);
+
+				handle_mask = capacity - 1;
+				return 0;
+			};
+
+			// Not thread-safe, drops whatever is left.
+			void release(void) {
+				if(handle_cells == nullptr)
+					return;
+
+				T item;
+				while(pop(item)) {};
+
+				exhale(handle_cells);
+				handle_cells = nullptr;
+				handle_mask = 0;
+			};
+
+			template<typename U>
+			bool push(U &&item) {
+				ulong pos;
+				if(claim(handle_tail, 1, 0, pos) == 0)
+					return false;
+
+				cell_t *c = &handle_cells[pos & handle_mask];
+				new (&c->item) T(std::forward<U>(item));
+				c->seq.store(pos + 1, std::memory_order_release);
+
+				return true;
+			}
+
+			bool pop(T &item) {
+				ulong pos;
+				if(claim(handle_head, 1, 1, pos) == 0)
+					return false;
+
+				cell_t *c = &handle_cells[pos & handle_mask];
+				item = std::move(c->item);
+				c->item.~T();
+				c->seq.store(pos + handle_mask + 1, std::memory_order_release);
+
+				return true;
+			};
+
+			// Claims a run of free cells in one go; fewer than 'n' items may
+			// go in when the ring is nearly full.
+			ulong push_n(const T *items, ulong n) {
+				ulong pos;
+				n = n == 0 ? 0 : claim(handle_tail, n, 0, pos);
+
+				for(ulong i = 0; i < n; i++) {
+					cell_t *c = &handle_cells[(pos + i) & handle_mask];
+					new (&c->item) T(items[i]);
+					c->seq.store(pos + i + 1, std::memory_order_release);
+				};
+
+				return n;
+			};
+
+			ulong pop_n(T *items, ulong n) {
+				ulong pos;
+				n = n == 0 ? 0 : claim(handle_head, n, 1, pos);
+
+				for(ulong i = 0; i < n; i++) {
+					cell_t *c = &handle_cells[(pos + i) & handle_mask];
+					items[i] = std::move(c->item);
+					c->item.~T();
+					c->seq.store(pos + i + handle_mask + 1, std::memory_order_release);
+				};
+
+				return n;
+			};
+
+			ulong capacity(void) { return handle_mask + 1; };
+
+			// Only a hint while other threads are running.
+			ulong size(void) {
+				ulong tail = handle_tail.load(std::memory_order_acquire);
+				ulong head = handle_head.load(std::memory_order_acquire);
+				return tail > head ? tail - head : 0;
+			};
+	};
+};
@@ -0,0 +1,65 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+
+namespace Ox {
+	// Non-owning view over contiguous items, e.g. an Elastic or an array.
+	template<typename T>
+	class Span {
+		private:
+			T *handle_data = nullptr;
+			long handle_size = 0;
+
+		public:
+			Span(void) {};
+
+			Span(T *data, long size) {
+				handle_data = data;
+				handle_size = size;
+			};
+
+			template<long N>
+			Span(T (&items)[N]) {
+				handle_data = items;
+				handle_size = N;
+			}
+
+			// Unchecked, only asserted in debug builds.
+			T &operator[](long n) const {
+				ox_assert(n >= 0 && n < handle_size, "Out of bonds");
+				return handle_data[n];
+			};
+
+			// Clamped to the view, never out of bonds.
+			Span subspan(long offset, long n) const {
+				if(offset < 0) offset = 0;
+				if(offset > handle_size) offset = handle_size;
+				if(n < 0 || n > handle_size - offset) n = handle_size - offset;
+
+				return Span(handle_data + offset, n);
+			};
+
+			T *begin(void) const { return handle_data; };
+			T *end(void) const { return handle_data + handle_size; };
+			T *data(void) const { return handle_data; };
+
+			long size(void) const { return handle_size; };
+			bool is_empty(void) const { return handle_size <= 0; };
+	};
+};
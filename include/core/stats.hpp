@@ -0,0 +1,117 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+
+namespace Ox {
+	class BasicIOStream;
+
+	// Allocation accounting, only collected when built with OX_ALLOC_STATS.
+	// Otherwise the hooks in 'inhale'/'respire'/'exhale' are compiled out and
+	// every snapshot comes back empty with 'enabled' set to false.
+	namespace Stats {
+		static const uint max_alloc_tags = 32;
+
+		typedef struct alloc_tag_t {
+			const char *name = nullptr;
+			u64 count = 0;
+			u64 bytes = 0;
+		} alloc_tag_t;
+
+		typedef struct alloc_snapshot_t {
+			bool enabled = false;
+
+			// Bytes requested by callers, block headers not included.
+			u64 live_bytes = 0;
+			u64 peak_bytes = 0;
+			u64 live_blocks = 0;
+
+			u64 allocs = 0;
+			u64 frees = 0;
+			u64 reallocs = 0;
+			// Reallocations that couldn't stay in place.
+			u64 realloc_moves = 0;
+
+			// Allocations made under each OX_ALLOC_TAG, the first tag being
+			// "untagged". Once every slot is taken new tags count as "other".
+			uint num_tags = 0;
+			alloc_tag_t tags[max_alloc_tags];
+		} alloc_snapshot_t;
+
+		alloc_snapshot_t alloc_snapshot(void);
+		int alloc_dump_json(BasicIOStream &os, Error &err);
+
+		// Names the allocations made by the calling thread while alive.
+		// 'name' must outlive the program, a string literal is expected.
+		class ScopedTag {
+			private:
+				uint previous;
+
+			public:
+				ScopedTag(const char *name);
+				~ScopedTag(void);
+
+				ScopedTag(const ScopedTag &) = delete;
+				ScopedTag &operator=(const ScopedTag &) = delete;
+		};
+
+		// Time spent blocked in Ox's synchronisation primitives. Always
+		// collected, since only waits that really block get timed.
+		typedef enum {
+			wait_condvar = 0,
+			wait_semaphore,
+			wait_latch,
+			wait_barrier,
+			wait_event,
+			wait_mutex,
+			wait_rwlock_read,
+			wait_rwlock_write,
+			num_wait_kinds
+		} wait_kind_t;
+
+		typedef struct wait_stats_t {
+			const char *name = nullptr;
+			// Waits that had to block, and how many of those timed out.
+			u64 waits = 0;
+			u64 timeouts = 0;
+			u64 wait_ns = 0;
+			u64 max_wait_ns = 0;
+			// Locks only: acquisitions that missed the uncontended fast path,
+			// whether they then got in by spinning or had to block.
+			u64 contended = 0;
+		} wait_stats_t;
+
+		typedef struct wait_snapshot_t {
+			wait_stats_t kinds[num_wait_kinds];
+		} wait_snapshot_t;
+
+		wait_snapshot_t wait_snapshot(void);
+
+		void __alloc_hook(ulong n);
+		void __realloc_hook(ulong old_n, ulong n, bool moved);
+		void __free_hook(ulong n);
+		void __wait_hook(uint kind, u64 ns, bool timed_out);
+		void __contended_hook(uint kind);
+	};
+
+	#ifdef OX_ALLOC_STATS
+		#define OX_ALLOC_TAG(name) Ox::Stats::ScopedTag __ox_alloc_tag(name)
+	#else
+		#define OX_ALLOC_TAG(name) (void)0
+	#endif
+};
@@ -19,12 +19,45 @@
 #include "../nuclei.hpp"
 
 namespace Ox {
+	// Backed by the C library's own vectorised routines, except for 'is_utf8'
+	// which is vectorised here (SSE2/AVX2, picked at runtime).
 	ulong strlen(const char *str);
+	const char *memchr(const char *s, char c, ulong n);
+	bool memeq(const void *a, const void *b, ulong n);
+	int memcmp(const void *a, const void *b, ulong n);
+	bool is_utf8(const char *s, ulong n);
+	// "avx2", "sse2" or "scalar".
+	const char *simd_backend(void);
 
-	// Placeholder.
+	// UTF-16 (2-byte wchar_t) or UTF-32 (4-byte wchar_t) to UTF-8, 'n' being
+	// the number of code units. Invalid sequences become U+FFFD. The output
+	// isn't terminated.
+	ulong utf8_length(const wchar_t *s, ulong n);
+	ulong utf8_from_wide(const wchar_t *s, ulong n, char *dst);
+
+	// Strings up to 'small_capacity' characters are kept inline, without
+	// touching the heap. A default-constructed String is NULL: 'c_str' returns
+	// NULL until something is assigned to it.
 	class String {
+		public:
+			static const ulong small_capacity = 23;
+
 		private:
-			void *implptr = nullptr;
+			char *handle_data = nullptr;
+			ulong handle_length = 0;
+			// Heap capacity, not counting the terminator; 0 while inline.
+			ulong handle_capacity = 0;
+			char handle_small[small_capacity + 1];
+
+			bool is_small(void) const { return handle_data == handle_small; };
+
+			// Makes room for 'n' characters plus the terminator, dropping the
+			// current contents.
+			char *prepare(ulong n, Error &err);
+			void release(void);
+			void steal(String &other);
+
+			friend class StringBuilder;
 
 		public:
 			Ox::Error err;
@@ -33,22 +66,73 @@ namespace Ox {
 			String(const char *s);
 			String(char *s);
 
+			String(const String &other);
+			String(String &&other);
+
 			int from_c(const char *source, Error &err);
+			int from_c(const char *source, ulong len, Error &err);
 			int from_c(const wchar_t *source, Error &err);	// for Windows...
 			int from_fmt(Error &err, const char *format, ...);
 
-			const char *c_str(void);
+			const char *c_str(void) const { return handle_data; };
+			ulong length(void) const { return handle_length; };
+			bool is_null(void) const { return handle_data == nullptr; };
+			bool is_empty(void) const { return handle_length == 0; };
+
+			bool operator==(const String &other) const;
+			bool operator!=(const String &other) const { return !(*this == other); };
+			int compare(const String &other) const;
 
 			String concat(const char *with);
+			String concat(const char *with, ulong len);
 			String operator+(const char *right);
-			String operator+(String &right);
+			String operator+(const String &right);
 
-			String operator=(const char *s);
-			String operator=(char *s);
+			String &operator=(const char *s);
+			String &operator=(char *s);
+			String &operator=(const String &other);
+			String &operator=(String &&other);
 
 			~String(void);
 
-			operator const char *(void) { return c_str(); };
-			operator char *(void) { return (char *)c_str(); };
+			operator const char *(void) const { return c_str(); };
+			operator char *(void) { return handle_data; };
+	};
+
+	// Growable buffer for assembling a String piece by piece; grows
+	// geometrically and hands its buffer over to the String on 'take'.
+	class StringBuilder {
+		private:
+			char *handle_data = nullptr;
+			ulong handle_length = 0;
+			// Not counting the terminator.
+			ulong handle_capacity = 0;
+
+			char *grow(ulong n, Error &err);
+
+		public:
+			StringBuilder(void) {};
+			~StringBuilder(void);
+
+			StringBuilder(const StringBuilder &) = delete;
+			StringBuilder &operator=(const StringBuilder &) = delete;
+
+			int reserve(ulong n, Error &err);
+			void clear(void);
+
+			int append(const char *s, Error &err);
+			int append(const char *s, ulong len, Error &err);
+			int append(const String &s, Error &err);
+			int append_char(char c, Error &err);
+			int append_int(i64 v, Error &err);
+			int append_uint(u64 v, Error &err);
+			int append_fmt(Error &err, const char *format, ...);
+
+			const char *c_str(void) const { return handle_data; };
+			ulong length(void) const { return handle_length; };
+			ulong capacity(void) const { return handle_capacity; };
+
+			// Moves the buffer into a String, leaving the builder empty.
+			String take(void);
 	};
 };
@@ -0,0 +1,258 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+
+// Coroutines need C++20, the rest of Ox sticks to C++17: under C++17 this
+// header declares nothing.
+#if defined(__cpp_impl_coroutine) && ox_has_include(<coroutine>) && ox_has_include(<poll.h>)
+	#define OX_USE_COROUTINES
+	#include <coroutine>
+	#include <exception>
+	#include <new>
+	#include <utility>
+#endif
+
+#ifdef OX_USE_COROUTINES
+namespace Ox {
+	class Executor;
+
+	template<typename T = void>
+	class Task;
+
+	void __ox_executor_done(Executor *e);
+
+	typedef struct __ox_promise_base_t {
+		// Whoever co_awaits the task, resumed once it's done.
+		std::coroutine_handle<> continuation;
+		// Set for tasks handed to Executor::spawn, they free themselves.
+		Executor *detached_on = nullptr;
+
+		typedef struct final_awaiter_t {
+			bool await_ready(void) noexcept { return false; };
+
+			template<typename P>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+				__ox_promise_base_t &p = h.promise();
+
+				if(p.continuation)
+					return p.continuation;
+
+				if(p.detached_on != nullptr) {
+					Executor *e = p.detached_on;
+					h.destroy();
+					__ox_executor_done(e);
+				}
+
+				return std::noop_coroutine();
+			}
+
+			void await_resume(void) noexcept {};
+		} final_awaiter_t;
+
+		// Tasks are lazy: nothing runs until awaited or spawned.
+		std::suspend_always initial_suspend(void) noexcept { return {}; };
+		final_awaiter_t final_suspend(void) noexcept { return {}; };
+
+		// Ox reports errors through Error&, an escaping exception is a bug.
+		void unhandled_exception(void) noexcept { std::terminate(); };
+	} __ox_promise_base_t;
+
+	template<typename T>
+	struct __ox_promise_t : __ox_promise_base_t {
+		alignas(T) u8 storage[sizeof(T)];
+		bool has_value = false;
+
+		Task<T> get_return_object(void) noexcept;
+
+		template<typename U>
+		void return_value(U &&value) {
+			new (storage) T(std::forward<U>(value));
+			has_value = true;
+		}
+
+		T result(void) {
+			return std::move(*(T *)storage);
+		}
+
+		~__ox_promise_t(void) {
+			if(has_value)
+				((T *)storage)->~T();
+		}
+	};
+
+	template<>
+	struct __ox_promise_t<void> : __ox_promise_base_t {
+		Task<void> get_return_object(void) noexcept;
+
+		void return_void(void) noexcept {};
+		void result(void) {};
+	};
+
+	// Lazily started coroutine returning a T. Awaiting it runs it to
+	// completion, resuming the awaiter right after through symmetric
+	// transfer, so deep chains don't grow the stack.
+	template<typename T>
+	class Task {
+		public:
+			typedef __ox_promise_t<T> promise_type;
+
+		private:
+			std::coroutine_handle<promise_type> handle;
+
+		public:
+			Task(void) : handle(nullptr) {};
+			explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {};
+
+			Task(const Task &) = delete;
+			Task &operator=(const Task &) = delete;
+
+			Task(Task &&other) noexcept : handle(other.handle) {
+				other.handle = nullptr;
+			};
+
+			Task &operator=(Task &&other) noexcept {
+				if(this != &other) {
+					if(handle)
+						handle.destroy();
+
+					handle = other.handle;
+					other.handle = nullptr;
+				}
+
+				return *this;
+			};
+
+			~Task(void) {
+				if(handle)
+					handle.destroy();
+			};
+
+			bool is_done(void) {
+				return !handle || handle.done();
+			};
+
+			bool await_ready(void) noexcept {
+				return is_done();
+			};
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+				handle.promise().continuation = awaiting;
+				return handle;
+			};
+
+			T await_resume(void) {
+				return handle.promise().result();
+			};
+
+			// Gives the coroutine away, see Executor::spawn.
+			std::coroutine_handle<promise_type> release(void) {
+				std::coroutine_handle<promise_type> h = handle;
+				handle = nullptr;
+				return h;
+			};
+	};
+
+	template<typename T>
+	Task<T> __ox_promise_t<T>::get_return_object(void) noexcept {
+		return Task<T>(std::coroutine_handle<__ox_promise_t<T>>::from_promise(*this));
+	}
+
+	inline Task<void> __ox_promise_t<void>::get_return_object(void) noexcept {
+		return Task<void>(std::coroutine_handle<__ox_promise_t<void>>::from_promise(*this));
+	};
+
+	// Runs Task<void>s on the calling thread and, optionally, on worker
+	// Ox::Threads. Timers and I/O readiness are polled by whoever is in
+	// 'run', so with no workers everything happens there.
+	class Executor {
+		private:
+			void *handle = nullptr;
+
+			friend void __ox_executor_done(Executor *e);
+
+			void at(ulong microseconds, std::coroutine_handle<> h, Error *err);
+			int watch(int fd, short events, std::coroutine_handle<> h, int *rc, Error *err);
+
+			typedef struct schedule_t {
+				Executor *e;
+
+				bool await_ready(void) noexcept { return false; };
+				void await_suspend(std::coroutine_handle<> h) { e->post(h); };
+				void await_resume(void) noexcept {};
+			} schedule_t;
+
+			typedef struct sleep_t {
+				Executor *e;
+				ulong microseconds;
+				Error *err;
+
+				bool await_ready(void) noexcept { return *err != nullptr; };
+				void await_suspend(std::coroutine_handle<> h) { e->at(microseconds, h, err); };
+				int await_resume(void) noexcept { return *err != nullptr ? -1 : 0; };
+			} sleep_t;
+
+			typedef struct ready_t {
+				Executor *e;
+				int fd;
+				short events;
+				Error *err;
+				int rc = 0;
+
+				bool await_ready(void) noexcept { return *err != nullptr; };
+				bool await_suspend(std::coroutine_handle<> h) { return e->watch(fd, events, h, &rc, err) == 0; };
+				int await_resume(void) noexcept { return *err != nullptr ? -1 : rc; };
+			} ready_t;
+
+		public:
+			Executor(void) {};
+			~Executor(void);
+
+			Executor(const Executor &) = delete;
+			Executor &operator=(const Executor &) = delete;
+
+			// 'workers' extra threads resume tasks alongside 'run'.
+			int init(Error &err, int workers = 0);
+			// Tasks still suspended are leaked, not resumed.
+			void release(void);
+
+			// Queues 'task', which frees itself once done.
+			int spawn(Error &err, Task<void> task);
+			// Runs until every spawned task is done. One thread at a time.
+			int run(Error &err);
+
+			// Resumes 'h' on one of the executor's threads.
+			void post(std::coroutine_handle<> h);
+
+			// co_await executor.schedule(): hops onto the executor.
+			schedule_t schedule(void) {
+				return schedule_t { this };
+			};
+
+			// co_await executor.sleep_for(us, err): 0, or -1 with 'err' set.
+			sleep_t sleep_for(ulong microseconds, Error &err) {
+				return sleep_t { this, microseconds, &err };
+			};
+
+			// co_await until 'fd' can be read or written without blocking:
+			// 0, or -1 with 'err' set when the descriptor is invalid.
+			ready_t readable(int fd, Error &err);
+			ready_t writable(int fd, Error &err);
+	};
+};
+#endif
@@ -17,6 +17,7 @@
 
 #pragma once
 #include "../nuclei.hpp"
+#include <atomic>
 
 namespace Ox {
 	class Thread {
@@ -26,28 +27,214 @@ namespace Ox {
 		public:
 			typedef void (*callable_t)(void *user);
 
+			typedef enum {
+				sched_normal = 0,
+				// Throughput jobs the kernel may delay (Linux only).
+				sched_batch,
+				// Runs only when nothing else wants the CPU (Linux only).
+				sched_idle,
+				// Real-time policies, usually need privileges.
+				sched_fifo,
+				sched_rr
+			} sched_t;
+
+			typedef struct options_t {
+				// 0 keeps the platform default. Needs the pthread backend.
+				ulong stack_size = 0;
+				// CPU to pin the thread to, -1 lets it run anywhere.
+				int cpu = -1;
+				// Shown by debuggers and 'top', cut to 15 characters on Linux.
+				const char *name = nullptr;
+				sched_t policy = sched_normal;
+				// Only meaningful for 'sched_fifo' and 'sched_rr'.
+				int priority = 0;
+			} options_t;
+
+			Thread(void) {};
 			~Thread(void);
-			
-			// automatically detached, shared memory.
+
+			Thread(const Thread &) = delete;
+			Thread &operator=(const Thread &) = delete;
+
+			// Shared memory; the destructor joins if 'join' wasn't called.
 			int init(Ox::Error &err, callable_t f, void *user);
+			// Fails without starting anything if an option can't be honoured.
+			int init(Ox::Error &err, callable_t f, void *user, const options_t &options);
 			void join(void);
 
+			// Apply to the calling thread.
+			static int pin(int cpu, Ox::Error &err);
+			static int set_name(const char *name, Ox::Error &err);
+
 			// assume nothing
 			static Ox::pointer_t get_id(void);
 			static int hint_hardware_concurrency(void);
+
+			// Gives the rest of the time slice away.
+			static void yield(void);
+			static void sleep(ulong microseconds);
+
+			// Tells the CPU we are busy-waiting.
+			static inline void relax(void) {
+				#if defined(__x86_64__) || defined(__i386__)
+					__builtin_ia32_pause();
+				#elif defined(__aarch64__)
+					__asm__ __volatile__("yield");
+				#endif
+			};
 	};
 
+	// Spins a little, then parks. Locking twice from the same thread or
+	// unlocking from another one is an error, not a deadlock.
 	class Mutex {
 		private:
-			void *handle = nullptr;
-			Ox::pointer_t owner = -1;
-		
+			// 0 unlocked, 1 locked, 2 locked with threads parked.
+			std::atomic<u32> state { 0 };
+			Ox::Atomic<Ox::pointer_t> owner { 0 };
+			// Running estimate of how long spinning pays off.
+			std::atomic<u32> spin { 0 };
+
+			void block(void);
+
 		public:
-			Mutex(void);
-			~Mutex(void);
+			constexpr Mutex(void) {};
+
+			Mutex(const Mutex &) = delete;
+			Mutex &operator=(const Mutex &) = delete;
 
 			int lock(Ox::Error &err);
 			bool try_lock(Ox::Error &err);
 			int unlock(Ox::Error &err);
 	};
+
+	// Shared/exclusive lock. Writers are preferred: once one waits, new
+	// readers queue behind it, so a thread must not take the read lock
+	// twice while writers may show up.
+	class RWLock {
+		private:
+			static const u32 writer = 0x80000000;
+
+			// Number of readers, or 'writer'.
+			std::atomic<u32> state { 0 };
+			std::atomic<u32> writers_waiting { 0 };
+			std::atomic<u32> sleepers { 0 };
+
+		public:
+			constexpr RWLock(void) {};
+
+			RWLock(const RWLock &) = delete;
+			RWLock &operator=(const RWLock &) = delete;
+
+			int read_lock(Ox::Error &err);
+			bool try_read_lock(void);
+			void read_unlock(void);
+
+			int write_lock(Ox::Error &err);
+			bool try_write_lock(void);
+			void write_unlock(void);
+	};
+
+	// The primitives below park on a 32-bit word: with futex on Linux,
+	// elsewhere on a small table of std/pthread condition variables. Their
+	// 'wait_for' return 1 on timeout. Blocking waits are timed, see
+	// Stats::wait_snapshot.
+
+	// Waiting unlocks 'm' and locks it back before returning; wakeups can be
+	// spurious, check the condition in a loop.
+	class CondVar {
+		private:
+			std::atomic<u32> seq { 0 };
+			std::atomic<u32> waiters { 0 };
+
+			int block(Mutex &m, long microseconds, Ox::Error &err);
+
+		public:
+			constexpr CondVar(void) {};
+
+			CondVar(const CondVar &) = delete;
+			CondVar &operator=(const CondVar &) = delete;
+
+			int wait(Mutex &m, Ox::Error &err);
+			int wait_for(Mutex &m, ulong microseconds, Ox::Error &err);
+
+			void notify_one(void);
+			void notify_all(void);
+	};
+
+	// Counting semaphore.
+	class Semaphore {
+		private:
+			std::atomic<u32> count;
+			std::atomic<u32> waiters { 0 };
+
+			int block(long microseconds, Ox::Error &err);
+
+		public:
+			Semaphore(u32 initial = 0) : count(initial) {};
+
+			Semaphore(const Semaphore &) = delete;
+			Semaphore &operator=(const Semaphore &) = delete;
+
+			int acquire(Ox::Error &err);
+			int acquire_for(ulong microseconds, Ox::Error &err);
+			bool try_acquire(void);
+
+			void release(u32 n = 1);
+	};
+
+	// Single-use countdown: 'wait' returns once it reached zero.
+	class Latch {
+		private:
+			std::atomic<u32> count;
+
+		public:
+			Latch(u32 n) : count(n) {};
+
+			Latch(const Latch &) = delete;
+			Latch &operator=(const Latch &) = delete;
+
+			void count_down(u32 n = 1);
+			bool try_wait(void);
+			int wait(Ox::Error &err);
+	};
+
+	// Reusable rendezvous of 'parties' threads. 'arrive_and_wait' returns 1
+	// in the last thread to arrive, 0 in the others.
+	class Barrier {
+		private:
+			u32 parties;
+			std::atomic<u32> arrived { 0 };
+			std::atomic<u32> generation { 0 };
+
+		public:
+			Barrier(u32 n) : parties(n) {};
+
+			Barrier(const Barrier &) = delete;
+			Barrier &operator=(const Barrier &) = delete;
+
+			int arrive_and_wait(Ox::Error &err);
+	};
+
+	// Flag threads can wait on. An auto-reset event lets a single waiter
+	// through per 'set'; a manual one stays set until 'reset'.
+	class Event {
+		private:
+			std::atomic<u32> state { 0 };
+			bool auto_reset;
+
+			int block(long microseconds, Ox::Error &err);
+
+		public:
+			Event(bool automatic = false) : auto_reset(automatic) {};
+
+			Event(const Event &) = delete;
+			Event &operator=(const Event &) = delete;
+
+			void set(void);
+			void reset(void);
+			bool is_set(void);
+
+			int wait(Ox::Error &err);
+			int wait_for(ulong microseconds, Ox::Error &err);
+	};
 };
@@ -0,0 +1,138 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include "allocator.hpp"
+#include "stats.hpp"
+#include <new>
+#include <utility>
+
+namespace Ox {
+	// Type-erased side of ThreadLocal, see src/threadlocal.cpp.
+	class __ox_tls_key_t {
+		private:
+			uint id = 0;
+			void *entries = nullptr;
+			ulong count = 0;
+
+			friend struct __ox_tls_table_t;
+
+		public:
+			typedef void *(*make_t)(void *owner, Error &err);
+			typedef void (*drop_t)(void *owner, void *value);
+			typedef void (*visit_t)(void *value, void *user);
+
+			void *owner;
+			make_t make;
+			drop_t drop;
+			// Same as 'drop', for values never handed out: no 'on_exit'.
+			drop_t discard;
+
+			__ox_tls_key_t(void *owner, make_t make, drop_t drop, drop_t discard);
+			~__ox_tls_key_t(void);
+
+			__ox_tls_key_t(const __ox_tls_key_t &) = delete;
+			__ox_tls_key_t &operator=(const __ox_tls_key_t &) = delete;
+
+			void *get(Error &err);
+			void *peek(void);
+			void for_each(visit_t f, void *user);
+			ulong size(void);
+	};
+
+	// One T per thread, built on the thread's first 'get'. A thread's value
+	// is destroyed when the thread ends (before Thread::join returns), or
+	// along with the ThreadLocal, whichever comes first; 'on_exit' sees it
+	// just before, e.g. to fold per-thread stats into a total.
+	//
+	// 'on_exit' and ~T run under the registry's lock: they must not use
+	// another ThreadLocal.
+	template<typename T>
+	class ThreadLocal {
+		public:
+			typedef void (*exit_t)(T &value, void *user);
+
+		private:
+			exit_t on_exit = nullptr;
+			void *on_exit_user = nullptr;
+			__ox_tls_key_t key;
+
+			static void *make(void *owner, Error &err) {
+				(void)owner;
+
+				// Values live as long as their thread, not the caller's scope.
+				ScopedAllocator heap(*HeapAllocator::instance());
+				OX_ALLOC_TAG("threadlocal");
+
+				T *value = inhale_raw<T>(1, err);
+				if(value == nullptr)
+					return nullptr;
+
+				new (value) T();
+				return value;
+			};
+
+			static void discard(void *owner, void *value) {
+				(void)owner;
+
+				T *v = (T *)value;
+				v->~T();
+				exhale(v);
+			};
+
+			static void drop(void *owner, void *value) {
+				ThreadLocal *self = (ThreadLocal *)owner;
+
+				if(self->on_exit != nullptr)
+					self->on_exit(*(T *)value, self->on_exit_user);
+
+				discard(owner, value);
+			};
+
+		public:
+			ThreadLocal(void) : key(this, make, drop, discard) {};
+			ThreadLocal(exit_t f, void *user) : on_exit(f), on_exit_user(user), key(this, make, drop, discard) {};
+
+			ThreadLocal(const ThreadLocal &) = delete;
+			ThreadLocal &operator=(const ThreadLocal &) = delete;
+
+			// The calling thread's value, NULL only if it couldn't be built.
+			T *get(Error &err) {
+				return (T *)key.get(err);
+			};
+
+			// Same, without building it.
+			T *peek(void) {
+				return (T *)key.peek();
+			};
+
+			// Visits every live value. Their threads may be using them
+			// meanwhile: stick to atomics or data they no longer touch.
+			template<typename F>
+			void for_each(F f) {
+				key.for_each([](void *value, void *user) {
+					(*(F *)user)(*(T *)value);
+				}, &f);
+			}
+
+			// Threads holding a value right now.
+			ulong size(void) {
+				return key.size();
+			};
+	};
+};
@@ -0,0 +1,177 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "../nuclei.hpp"
+#include "thread.hpp"
+#include <atomic>
+#include <new>
+#include <utility>
+
+namespace Ox {
+	class TaskGroup;
+
+	// Unit of work handed to a ThreadPool. 'run' executes it and destroys
+	// whatever payload follows the header.
+	typedef struct alignas(16) __ox_task_t {
+		void (*run)(__ox_task_t *self);
+		TaskGroup *group;
+		void (*f)(void *user);
+		void *user;
+		ulong size;
+	} __ox_task_t;
+
+	// Tasks come from the PoolAllocator, 'payload' bytes follow the header.
+	__ox_task_t *__ox_task_alloc(ulong payload, Error &err);
+	void __ox_task_free(__ox_task_t *task);
+
+	// Work-stealing pool of Ox::Thread workers. Each worker owns a Chase-Lev
+	// deque: it pushes and pops its own tasks at the bottom while idle
+	// workers steal the oldest ones from the top. Tasks spawned from outside
+	// go through a shared queue. Threads waiting on a TaskGroup run tasks
+	// meanwhile, so the caller counts as one of the pool's threads.
+	class ThreadPool {
+		private:
+			void *handle = nullptr;
+
+			friend class TaskGroup;
+
+			template<typename F>
+			static void split(TaskGroup &group, long begin, long end, long grain, F &body);
+
+		public:
+			typedef void (*job_t)(void *user, long index);
+			typedef void (*task_t)(void *user);
+
+			ThreadPool(void) {};
+			~ThreadPool(void);
+
+			ThreadPool(const ThreadPool &) = delete;
+			ThreadPool &operator=(const ThreadPool &) = delete;
+
+			// 'size' counts the caller, 0 means one per available core.
+			int init(Ox::Error &err, int size = 0);
+			void release(void);
+
+			// Calls 'body(from, to)' on pieces of [begin, end) and returns
+			// once they are all done. Ranges are split in halves, lazily, down
+			// to 'grain' items; 0 picks about 8 pieces per thread.
+			template<typename F>
+			int parallel_for(Ox::Error &err, long begin, long end, F body, long grain = 0);
+
+			// Calls 'f(user, i)' for every i in [0, n), one index per task.
+			int run(Ox::Error &err, long n, job_t f, void *user);
+
+			int size(void);
+
+			// Lazily started, sized to the hardware.
+			static ThreadPool &global(void);
+	};
+
+	// Set of tasks one can wait for. Waiting (also done by the destructor)
+	// runs pending tasks of the pool instead of blocking.
+	class TaskGroup {
+		private:
+			ThreadPool *pool;
+			std::atomic<long> pending { 0 };
+
+			void submit(__ox_task_t *task);
+
+			friend void __ox_task_done(__ox_task_t *task);
+
+		public:
+			TaskGroup(void) : pool(&ThreadPool::global()) {};
+			TaskGroup(ThreadPool &p) : pool(&p) {};
+			~TaskGroup(void);
+
+			TaskGroup(const TaskGroup &) = delete;
+			TaskGroup &operator=(const TaskGroup &) = delete;
+
+			// Runs 'f' inline if the task can't be allocated or queued.
+			int spawn(Ox::Error &err, ThreadPool::task_t f, void *user);
+
+			// 'f' is moved into the task, called as 'f()'.
+			template<typename F>
+			int spawn(Ox::Error &err, F f) {
+				if(err != nullptr)
+					return -1;
+
+				static_assert(alignof(F) <= 16, "Over-aligned task");
+
+				__ox_task_t *task = __ox_task_alloc(sizeof(F), err);
+				if(task == nullptr) {
+					err.clear();
+					f();
+					return 0;
+				}
+
+				new (task + 1) F(std::move(f));
+				task->run = [](__ox_task_t *self) {
+					F *fp = (F *)(self + 1);
+					(*fp)();
+					fp->~F();
+				};
+
+				submit(task);
+				return 0;
+			}
+
+			void wait(void);
+	};
+
+	template<typename F>
+	void ThreadPool::split(TaskGroup &group, long begin, long end, long grain, F &body) {
+		Ox::Error err;
+
+		// Hand the upper halves out, most likely to be stolen first.
+		while(end - begin > grain) {
+			long mid = begin + (end - begin) / 2;
+			long hi = end;
+			TaskGroup *g = &group;
+			F *b = &body;
+
+			group.spawn(err, [g, mid, hi, grain, b](void) {
+				split(*g, mid, hi, grain, *b);
+			});
+
+			end = mid;
+		};
+
+		body(begin, end);
+	}
+
+	template<typename F>
+	int ThreadPool::parallel_for(Ox::Error &err, long begin, long end, F body, long grain) {
+		if(err != nullptr)
+			return -1;
+
+		if(end <= begin)
+			return 0;
+
+		if(grain <= 0) {
+			grain = (end - begin) / (8 * (long)size());
+			if(grain < 1)
+				grain = 1;
+		}
+
+		TaskGroup group(*this);
+		split(group, begin, end, grain, body);
+		group.wait();
+
+		return 0;
+	}
+};
@@ -0,0 +1,131 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "stream.hpp"
+#include "fstream.hpp"
+
+namespace Ox {
+	// Positional file I/O that doesn't block the caller. Requests are
+	// queued, handed over in batches and complete in any order; 'poll' and
+	// 'wait' reap them, running callbacks on the calling thread. Runs on
+	// io_uring where the kernel allows it, otherwise on a ThreadPool of its
+	// own doing blocking pread/pwrite. Not thread-safe: one thread drives
+	// an AsyncIO at a time.
+	class AsyncIO {
+		public:
+			typedef enum {
+				backend_none = 0,
+				backend_uring,
+				backend_threads,
+			} backend_t;
+
+			typedef enum {
+				op_read = 0,
+				op_write,
+				// fdatasync, ordered with nothing: wait for the writes first.
+				op_fsync,
+			} op_t;
+
+			typedef struct options_t {
+				// Requests queued or in flight at once. Queueing one more
+				// reaps completions first, waiting if needed.
+				uint depth = 128;
+				// Left to 'backend_none', io_uring with threads as fallback.
+				backend_t backend = backend_none;
+				// Thread backend only, 0 picks min(depth, 16).
+				uint threads = 0;
+			} options_t;
+
+			// Owned by the caller, left alone until 'done'.
+			typedef struct request_t {
+				// Called once done, from 'poll' or 'wait'. It may queue more
+				// requests, even past the depth, but mustn't wait.
+				void (*callback)(request_t &r, void *user) = nullptr;
+				void *user = nullptr;
+
+				// Bytes transferred, fewer than asked only at the end of the
+				// file; -1 on failure, with the errno in 'code'.
+				long result = 0;
+				int code = 0;
+				bool done = false;
+
+				// Set by 'read', 'write' and 'fsync'.
+				op_t op = op_read;
+				int file = -1;
+				u8 *data = nullptr;
+				ulong length = 0;
+				ulong offset = 0;
+				// Registered buffer holding 'data', or -1.
+				int buffer = -1;
+
+				// Bookkeeping.
+				ulong transferred = 0;
+				request_t *next = nullptr;
+			} request_t;
+
+		private:
+			void *handle = nullptr;
+
+			int queue(request_t &r, Error &err);
+
+		public:
+			AsyncIO(void) {};
+			~AsyncIO(void);
+
+			AsyncIO(const AsyncIO &) = delete;
+			AsyncIO &operator=(const AsyncIO &) = delete;
+
+			int init(Error &err);
+			int init(options_t options, Error &err);
+			// Waits for whatever is still in flight.
+			void release(void);
+
+			// 'backend_none' until initialized.
+			backend_t backend(void);
+			// Queued or in flight, not reaped yet.
+			uint pending(void);
+
+			// Same modes as FS::open, and FileStream's O_DIRECT and advice.
+			// Returns a file descriptor for the requests, see 'close'.
+			int open(const char *path, openmode mode, Error &err);
+			int open(const char *path, openmode mode, FileStream::options_t options, Error &err);
+			void close(int file);
+
+			// Pins 'n' buffers once, so requests within them skip mapping
+			// the pages every time. Replaces the previous set; only while
+			// nothing is pending.
+			int register_buffers(const io_slice_t *buffers, ulong n, Error &err);
+			int unregister_buffers(Error &err);
+
+			// Queue a request; 'file' may also be FileStream::native_handle().
+			int read(request_t &r, int file, u8 *s, ulong n, ulong offset, Error &err);
+			int write(request_t &r, int file, u8 *s, ulong n, ulong offset, Error &err);
+			int fsync(request_t &r, int file, Error &err);
+
+			// Hands the queued requests over, returns how many.
+			long submit(Error &err);
+			// Submits, then reaps whatever completed, waiting for at least
+			// 'min'. Returns the number of requests reaped.
+			long poll(Error &err, uint min = 0);
+			// Future-style: until 'r' is done, then its result. A failed
+			// request sets 'err'.
+			long wait(request_t &r, Error &err);
+			// Until nothing is pending.
+			int drain(Error &err);
+	};
+};
@@ -0,0 +1,221 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "stream.hpp"
+#include <cstring>
+
+namespace Ox {
+	// Read-ahead buffer over another stream. The fixed-width readers are
+	// inline and never leave the buffer while it holds enough bytes, unlike
+	// BasicIOStream's, which go through a virtual 'read' every time. Unlike
+	// those, they also fail on a short read instead of returning garbage.
+	//
+	// The source is read ahead of what was consumed: don't use it directly
+	// while the reader is around, seek through the reader instead.
+	class BufferedReader : public BasicIOStream {
+		private:
+			BasicIOStream *source = nullptr;
+			u8 *buffer = nullptr;
+			ulong capacity = 0;
+			ulong head = 0;
+			ulong tail = 0;
+
+			long fill(Error &err);
+			int take(u8 *s, ulong n, Error &err);
+
+			template<typename T>
+			T fetch(Error &err) {
+				T v;
+
+				if(tail - head >= sizeof(T) && err == nullptr) {
+					std::memcpy(&v, buffer + head, sizeof(T));
+					head += sizeof(T);
+					return v;
+				}
+
+				if(take((u8 *)&v, sizeof(T), err) != 0)
+					return (T)-1;
+
+				return v;
+			}
+
+		public:
+			static const ulong default_capacity = 64 * 1024;
+
+			BufferedReader(void) {};
+			~BufferedReader(void) {
+				release();
+			};
+
+			BufferedReader(const BufferedReader &) = delete;
+			BufferedReader &operator=(const BufferedReader &) = delete;
+
+			int init(BasicIOStream &source, Error &err);
+			int init(BasicIOStream &source, ulong capacity, Error &err);
+			void release(void);
+
+			// Bytes read ahead and not consumed yet.
+			ulong buffered(void) {
+				return tail - head;
+			};
+
+			ulong tellg(void);
+			void seekg(ulong pos);
+			void seekg(long off, seekdir dir);
+
+			ulong tellp(void);
+			void seekp(ulong pos);
+			void seekp(long off, seekdir dir);
+
+			long ignore(ulong n, Error &err);
+			long ignore(ulong n, char delimitator, Error &err);
+			long read(u8 *s, ulong n, Error &err);
+			bool eof(Error &err);
+			// Read-only: always fails.
+			int write(u8 *s, ulong n, Error &err);
+
+			u8 readU8(Error &err) {
+				if(head < tail && err == nullptr)
+					return buffer[head++];
+
+				return fetch<u8>(err);
+			};
+
+			u16 readU16BE(Error &err) { return betoh<u16>(fetch<u16>(err)); };
+			u32 readU32BE(Error &err) { return betoh<u32>(fetch<u32>(err)); };
+			u64 readU64BE(Error &err) { return betoh<u64>(fetch<u64>(err)); };
+
+			u16 readU16LE(Error &err) { return letoh<u16>(fetch<u16>(err)); };
+			u32 readU32LE(Error &err) { return letoh<u32>(fetch<u32>(err)); };
+			u64 readU64LE(Error &err) { return letoh<u64>(fetch<u64>(err)); };
+
+			i8 readI8(Error &err) { return static_cast<i8>(readU8(err)); };
+
+			i16 readI16BE(Error &err) { return static_cast<i16>(readU16BE(err)); };
+			i32 readI32BE(Error &err) { return static_cast<i32>(readU32BE(err)); };
+			i64 readI64BE(Error &err) { return static_cast<i64>(readU64BE(err)); };
+
+			i16 readI16LE(Error &err) { return static_cast<i16>(readU16LE(err)); };
+			i32 readI32LE(Error &err) { return static_cast<i32>(readU32LE(err)); };
+			i64 readI64LE(Error &err) { return static_cast<i64>(readU64LE(err)); };
+
+			// Same conversions as BasicIOStream's.
+			f32 readF32BE(Error &err) { return static_cast<f32>(readU32BE(err)); };
+			f64 readF64BE(Error &err) { return static_cast<f64>(readU64BE(err)); };
+
+			f32 readF32LE(Error &err) { return static_cast<f32>(readU32LE(err)); };
+			f64 readF64LE(Error &err) { return static_cast<f64>(readU64LE(err)); };
+	};
+
+	// Write-behind buffer over another stream, flushed when full, on 'flush'
+	// and on 'release'. The fixed-width writers are inline and only reach the
+	// source when the buffer fills up.
+	//
+	// 'release' and the destructor can't report a failed flush: call 'flush'
+	// first when that matters.
+	class BufferedWriter : public BasicIOStream {
+		private:
+			BasicIOStream *source = nullptr;
+			u8 *buffer = nullptr;
+			ulong capacity = 0;
+			ulong used = 0;
+
+			template<typename T>
+			int put(T v, Error &err) {
+				if(capacity - used >= sizeof(T) && err == nullptr) {
+					std::memcpy(buffer + used, &v, sizeof(T));
+					used += sizeof(T);
+					return 0;
+				}
+
+				return write((u8 *)&v, sizeof(T), err);
+			}
+
+		public:
+			static const ulong default_capacity = 64 * 1024;
+
+			BufferedWriter(void) {};
+			~BufferedWriter(void) {
+				release();
+			};
+
+			BufferedWriter(const BufferedWriter &) = delete;
+			BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+			int init(BasicIOStream &source, Error &err);
+			int init(BasicIOStream &source, ulong capacity, Error &err);
+			void release(void);
+
+			// Hands every buffered byte to the source.
+			int flush(Error &err);
+
+			// Bytes written and not flushed yet.
+			ulong buffered(void) {
+				return used;
+			};
+
+			ulong tellg(void);
+			void seekg(ulong pos);
+			void seekg(long off, seekdir dir);
+
+			ulong tellp(void);
+			void seekp(ulong pos);
+			void seekp(long off, seekdir dir);
+
+			// Write-only: the reading side always fails.
+			long ignore(ulong n, Error &err);
+			long ignore(ulong n, char delimitator, Error &err);
+			long read(u8 *s, ulong n, Error &err);
+			bool eof(Error &err);
+			int write(u8 *s, ulong n, Error &err);
+
+			int writeU8(u8 v, Error &err) {
+				if(used < capacity && err == nullptr) {
+					buffer[used++] = v;
+					return 0;
+				}
+
+				return put<u8>(v, err);
+			};
+
+			int writeU16BE(u16 v, Error &err) { return put<u16>(htobe(v), err); };
+			int writeU32BE(u32 v, Error &err) { return put<u32>(htobe(v), err); };
+			int writeU64BE(u64 v, Error &err) { return put<u64>(htobe(v), err); };
+
+			int writeU16LE(u16 v, Error &err) { return put<u16>(htole(v), err); };
+			int writeU32LE(u32 v, Error &err) { return put<u32>(htole(v), err); };
+			int writeU64LE(u64 v, Error &err) { return put<u64>(htole(v), err); };
+
+			int writeI8(i8 v, Error &err) { return writeU8(static_cast<u8>(v), err); };
+
+			int writeI16BE(i16 v, Error &err) { return writeU16BE(static_cast<u16>(v), err); };
+			int writeI32BE(i32 v, Error &err) { return writeU32BE(static_cast<u32>(v), err); };
+			int writeI64BE(i64 v, Error &err) { return writeU64BE(static_cast<u64>(v), err); };
+
+			int writeI16LE(i16 v, Error &err) { return writeU16LE(static_cast<u16>(v), err); };
+			int writeI32LE(i32 v, Error &err) { return writeU32LE(static_cast<u32>(v), err); };
+			int writeI64LE(i64 v, Error &err) { return writeU64LE(static_cast<u64>(v), err); };
+
+			// Same conversions as BasicIOStream's.
+			int writeF32BE(f32 v, Error &err) { return writeU32BE(static_cast<u32>(v), err); };
+			int writeF64BE(f64 v, Error &err) { return writeU64BE(static_cast<u64>(v), err); };
+
+			int writeF32LE(f32 v, Error &err) { return writeU32LE(static_cast<u32>(v), err); };
+			int writeF64LE(f64 v, Error &err) { return writeU64LE(static_cast<u64>(v), err); };
+	};
+};
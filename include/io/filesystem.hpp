@@ -18,6 +18,7 @@
 #pragma once
 #include "../nuclei.hpp"
 #include "../core/string.hpp"
+#include "../core/atom.hpp"
 #include "fstream.hpp"
 
 namespace Ox {
@@ -78,9 +79,14 @@ namespace Ox {
 
 				String current(Error &err);
 				String next(Error &err);
+
+				// Same as above, interned in StringPool::global().
+				Atom current_atom(Error &err);
+				Atom next_atom(Error &err);
 		};
 
 		String abs(const char *p, Error &err);
+		Atom abs_atom(const char *p, Error &err);
 		int cp(const char *from, const char *to, bool force, Error &err);
 		// cp -r
 		int cp_all(const char *from, const char *to, bool force, Error &err);
@@ -24,14 +24,54 @@ namespace Ox {
 			void *__ox_implptr = nullptr;
 		
 		public:
+			typedef enum {
+				advice_normal = 0,
+				advice_sequential,
+				advice_random,
+				advice_willneed,
+				advice_dontneed,
+			} advice_t;
+
+			typedef struct options_t {
+				// O_DIRECT, native backend only: skips the page cache. Buffers,
+				// sizes and offsets must then be multiples of 'direct_alignment'.
+				bool direct = false;
+				advice_t advice = advice_normal;
+			} options_t;
+
+			// The largest logical block size in common use.
+			static const ulong direct_alignment = 4096;
+
 			~FileStream(void) {
 				close();
 			};
 
 			int open(const char *path, openmode mode, Error &err);
+			int open(const char *path, openmode mode, options_t options, Error &err);
 			bool is_open(void);
 			void close(void);
 
+			// The file descriptor with the native backend (built with
+			// OX_ENABLE_FSTREAM_NATIVE), -1 otherwise.
+			int native_handle(void);
+
+			// At 'offset', leaving the stream's position alone.
+			long pread(u8 *s, ulong n, ulong offset, Error &err);
+			int pwrite(u8 *s, ulong n, ulong offset, Error &err);
+			// Same, scattering into or gathering from 'n' slices.
+			long preadv(const io_slice_t *slices, ulong n, ulong offset, Error &err);
+			int pwritev(const io_slice_t *slices, ulong n, ulong offset, Error &err);
+
+			// posix_fadvise over 'len' bytes from 'offset', 0 meaning up to
+			// the end. A hint: backends without it just ignore it.
+			int advise(advice_t advice, ulong offset, ulong len, Error &err);
+			// Reserves disk blocks without changing the file's size, so
+			// sequential writes neither fragment nor run out of space.
+			int preallocate(ulong offset, ulong len, Error &err);
+			// Waits for written data, and the metadata needed to read it
+			// back, to reach the disk (fdatasync).
+			int sync(Error &err);
+
 			ulong tellg(void);
 			void seekg(ulong pos);
 			void seekg(long off, seekdir dir);
@@ -45,5 +85,8 @@ namespace Ox {
 			long read(u8 *s, ulong n, Error &err);
 			bool eof(Error &err);
 			int write(u8 *s, ulong n, Error &err);
+
+			long readv(const io_slice_t *slices, ulong n, Error &err);
+			int writev(const io_slice_t *slices, ulong n, Error &err);
 	};
 };
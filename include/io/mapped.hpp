@@ -0,0 +1,102 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "stream.hpp"
+#include "../core/span.hpp"
+
+namespace Ox {
+	// Stream over a memory-mapped file: reads and writes are plain copies
+	// from and to the page cache, and 'view' hands the mapped bytes out
+	// without copying at all. Writing needs Ox::out and stays within the
+	// file, 'resize' grows or shrinks it.
+	class MappedFileStream : public BasicIOStream {
+		public:
+			typedef enum {
+				advice_normal = 0,
+				// Aggressive read-ahead, pages dropped soon after use.
+				advice_sequential,
+				// No read-ahead.
+				advice_random,
+				// Start reading everything in now.
+				advice_willneed,
+			} advice_t;
+
+			typedef struct options_t {
+				advice_t advice = advice_normal;
+				// Asks for transparent huge pages, where the kernel supports
+				// them for files. Only a hint, like 'advice'.
+				bool huge_pages = false;
+			} options_t;
+
+		private:
+			int fd = -1;
+			u8 *data = nullptr;
+			ulong length = 0;
+			bool writable = false;
+			options_t options;
+
+			ulong gpos = 0;
+			ulong ppos = 0;
+
+			int map(Error &err);
+			void unmap(void);
+
+		public:
+			MappedFileStream(void) {};
+			~MappedFileStream(void) {
+				close();
+			};
+
+			MappedFileStream(const MappedFileStream &) = delete;
+			MappedFileStream &operator=(const MappedFileStream &) = delete;
+
+			// Ox::out creates the file if needed but, unlike FileStream,
+			// keeps what it holds.
+			int open(const char *path, openmode mode, Error &err);
+			int open(const char *path, openmode mode, options_t options, Error &err);
+			bool is_open(void);
+			void close(void);
+
+			int advise(advice_t advice, Error &err);
+			// Changes the file's size, remapping it: views don't survive.
+			int resize(ulong n, Error &err);
+			// Waits for written pages to reach the disk.
+			int sync(Error &err);
+
+			ulong size(void) {
+				return length;
+			};
+
+			// 'len' mapped bytes from 'offset', valid until 'resize' or 'close'.
+			Span<u8> view(ulong offset, ulong len, Error &err);
+
+			ulong tellg(void);
+			void seekg(ulong pos);
+			void seekg(long off, seekdir dir);
+
+			ulong tellp(void);
+			void seekp(ulong pos);
+			void seekp(long off, seekdir dir);
+
+			long ignore(ulong n, Error &err);
+			long ignore(ulong n, char delimitator, Error &err);
+			long read(u8 *s, ulong n, Error &err);
+			bool eof(Error &err);
+			int write(u8 *s, ulong n, Error &err);
+	};
+};
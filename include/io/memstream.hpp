@@ -0,0 +1,82 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#pragma once
+#include "stream.hpp"
+#include "../core/elastic.hpp"
+#include "../core/span.hpp"
+
+namespace Ox {
+	// Stream over bytes in memory: its own growable buffer by default, or
+	// whatever 'open' was given. Reading and writing keep separate
+	// positions, like std::stringstream.
+	class MemoryStream : public BasicIOStream {
+		private:
+			Elastic<u8> storage;
+			// NULL over a fixed buffer.
+			Elastic<u8> *elastic = &storage;
+			u8 *fixed = nullptr;
+			ulong fixed_size = 0;
+			bool read_only = false;
+
+			ulong gpos = 0;
+			ulong ppos = 0;
+
+			u8 *bytes(void) {
+				return elastic != nullptr ? elastic->begin() : fixed;
+			};
+
+			ulong seek(ulong from, long off, seekdir dir);
+
+		public:
+			MemoryStream(void) {};
+
+			MemoryStream(const MemoryStream &) = delete;
+			MemoryStream &operator=(const MemoryStream &) = delete;
+
+			// Over 'n' caller bytes: they can be overwritten, not grown.
+			int open(u8 *data, ulong n, Error &err);
+			// Same, read-only.
+			int open(const u8 *data, ulong n, Error &err);
+			// Over the caller's Elastic, grown by writes past its end.
+			int open(Elastic<u8> &bytes, Error &err);
+			// Back to an empty buffer of its own.
+			void close(void);
+
+			ulong size(void) {
+				return elastic != nullptr ? elastic->size() : fixed_size;
+			};
+
+			// 'len' bytes from 'offset', without copying. A write that grows
+			// the stream may move them.
+			Span<u8> view(ulong offset, ulong len, Error &err);
+
+			ulong tellg(void);
+			void seekg(ulong pos);
+			void seekg(long off, seekdir dir);
+
+			ulong tellp(void);
+			void seekp(ulong pos);
+			void seekp(long off, seekdir dir);
+
+			long ignore(ulong n, Error &err);
+			long ignore(ulong n, char delimitator, Error &err);
+			long read(u8 *s, ulong n, Error &err);
+			bool eof(Error &err);
+			int write(u8 *s, ulong n, Error &err);
+	};
+};
@@ -19,6 +19,12 @@
 #include "../nuclei.hpp"
 
 namespace Ox {
+	// One piece of a scatter/gather transfer.
+	typedef struct io_slice_t {
+		u8 *data = nullptr;
+		ulong length = 0;
+	} io_slice_t;
+
 	class BasicIOStream {
 		public:
 			virtual ulong tellg(void) = 0;
@@ -34,6 +40,12 @@ namespace Ox {
 			virtual long read(u8 *s, ulong n, Error &err) = 0;
 			virtual bool eof(Error &err) = 0;
 			virtual int write(u8 *s, ulong n, Error &err) = 0;
+
+			// Fill or drain 'n' slices in order, in a single system call where
+			// the stream can. By default, one 'read'/'write' per slice.
+			// 'readv' returns the bytes read, short only at the end.
+			virtual long readv(const io_slice_t *slices, ulong n, Error &err);
+			virtual int writev(const io_slice_t *slices, ulong n, Error &err);
 			
 			u8 readU8(Error &err);
 
@@ -41,6 +41,11 @@
 	#define OX_DEBUG 1
 #endif
 
+// Alignment that keeps data touched by different threads on separate lines.
+#ifndef OX_CACHE_LINE
+	#define OX_CACHE_LINE 64
+#endif
+
 #ifdef __has_include
 	#define ox_has_include __has_include
 #else
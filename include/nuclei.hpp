@@ -83,8 +83,12 @@ namespace Ox {
 		#define ox_assert(x,y) (void)0;
 	#endif
 	
+	class Allocator;
+
 	// Implementation of 'alloc'.
 	void *__ox_alloc(ulong n, const char **err);
+	// Implementation of 'alloc', without zero-filling.
+	void *__ox_alloc_raw(ulong n, const char **err);
 	// Implementation of 'realloc'.
 	void *__ox_realloc(void *src, ulong n, const char **err);
 
@@ -149,6 +153,134 @@ namespace Ox {
 		#endif
 	};
 
+	// Memory orderings for Atomic, with C++'s meaning.
+	typedef enum {
+		order_relaxed = __ATOMIC_RELAXED,
+		order_acquire = __ATOMIC_ACQUIRE,
+		order_release = __ATOMIC_RELEASE,
+		order_acq_rel = __ATOMIC_ACQ_REL,
+		order_seq_cst = __ATOMIC_SEQ_CST
+	} order_t;
+
+	// Strongest ordering a failed compare-exchange is allowed.
+	constexpr order_t __ox_failure_order(order_t o) {
+		return o == order_acq_rel ? order_acquire : (o == order_release ? order_relaxed : o);
+	};
+
+	inline void atomic_fence(order_t o) {
+		__atomic_thread_fence(o);
+	};
+
+	// Lock-free word for any trivially copyable T of 1, 2, 4 or 8 bytes,
+	// every operation naming its ordering. The arithmetic is for integers:
+	// on pointers it would count bytes.
+	template<typename T>
+	class Atomic {
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+			"Ox::Atomic only holds 1, 2, 4 or 8 bytes");
+
+		private:
+			alignas(sizeof(T)) T value;
+
+		public:
+			constexpr Atomic(void) : value() {};
+			constexpr Atomic(T v) : value(v) {};
+
+			Atomic(const Atomic &) = delete;
+			Atomic &operator=(const Atomic &) = delete;
+
+			T load(order_t o = order_seq_cst) const {
+				T v;
+				__atomic_load(&value, &v, o);
+				return v;
+			};
+
+			void store(T v, order_t o = order_seq_cst) {
+				__atomic_store(&value, &v, o);
+			};
+
+			T exchange(T v, order_t o = order_seq_cst) {
+				T old;
+				__atomic_exchange(&value, &v, &old, o);
+				return old;
+			};
+
+			// On failure, 'expected' gets the current value.
+			bool compare_exchange(T &expected, T desired, order_t o = order_seq_cst) {
+				return __atomic_compare_exchange(&value, &expected, &desired, false, o, __ox_failure_order(o));
+			};
+
+			// May fail spuriously, for loops.
+			bool compare_exchange_weak(T &expected, T desired, order_t o = order_seq_cst) {
+				return __atomic_compare_exchange(&value, &expected, &desired, true, o, __ox_failure_order(o));
+			};
+
+			T fetch_add(T v, order_t o = order_seq_cst) { return __atomic_fetch_add(&value, v, o); };
+			T fetch_sub(T v, order_t o = order_seq_cst) { return __atomic_fetch_sub(&value, v, o); };
+			T fetch_and(T v, order_t o = order_seq_cst) { return __atomic_fetch_and(&value, v, o); };
+			T fetch_or(T v, order_t o = order_seq_cst) { return __atomic_fetch_or(&value, v, o); };
+			T fetch_xor(T v, order_t o = order_seq_cst) { return __atomic_fetch_xor(&value, v, o); };
+	};
+
+	// Gives 'value' a cache line of its own. Blocks from 'inhale' are only
+	// 16-byte aligned: keep these in static or automatic storage.
+	template<typename T>
+	struct alignas(OX_CACHE_LINE) Padded {
+		T value;
+	};
+
+	// Hands out Counter shards round-robin, one per thread.
+	uint __ox_next_shard(void);
+
+	inline uint __ox_thread_shard(void) {
+		static thread_local uint shard = __ox_next_shard();
+		return shard;
+	};
+
+	// Sharded counter: each thread adds to its own cache line, only 'value'
+	// walks them all. It isn't a snapshot while adds are running.
+	class Counter {
+		public:
+			static const uint num_shards = 16;
+
+		private:
+			static const uint stride = OX_CACHE_LINE / sizeof(i64);
+			// One spare line to align the shards wherever the counter lives.
+			i64 storage[(num_shards + 1) * stride];
+
+			i64 *shard(uint i) const {
+				pointer_t base = ((pointer_t)storage + OX_CACHE_LINE - 1) & ~(pointer_t)(OX_CACHE_LINE - 1);
+				return (i64 *)base + (i % num_shards) * stride;
+			};
+
+		public:
+			constexpr Counter(void) : storage() {};
+
+			Counter(const Counter &) = delete;
+			Counter &operator=(const Counter &) = delete;
+
+			void add(i64 n = 1) {
+				__atomic_fetch_add(shard(__ox_thread_shard()), n, __ATOMIC_RELAXED);
+			};
+
+			void sub(i64 n = 1) {
+				add(-n);
+			};
+
+			i64 value(void) const {
+				i64 sum = 0;
+				for(uint i = 0; i < num_shards; i++)
+					sum += __atomic_load_n(shard(i), __ATOMIC_RELAXED);
+
+				return sum;
+			};
+
+			void reset(void) {
+				for(uint i = 0; i < num_shards; i++)
+					__atomic_store_n(shard(i), 0, __ATOMIC_RELAXED);
+			};
+	};
+
 	class Error {
 		private:
 			bool var = false;
@@ -187,7 +319,7 @@ namespace Ox {
 			};
 	};
 
-	// Allocates memory.
+	// Allocates zero-filled memory, see 'current_allocator'.
 	template<typename T>
 	T *inhale(ulong n, Error &err) {
 		if(err != nullptr)
@@ -206,6 +338,20 @@ namespace Ox {
 		return inhale<T>(1, err);
 	};
 
+	// Allocates memory, leaving its contents undefined.
+	template<typename T>
+	T *inhale_raw(ulong n, Error &err) {
+		if(err != nullptr)
+			return nullptr;
+
+		const char *e = nullptr;
+		T *p = (T *)__ox_alloc_raw(n * sizeof(T), &e);
+		if(p == nullptr)
+			err = e;
+
+		return p;
+	};
+
 	// Reallocates memory.
 	template<typename T>
 	T *respire(T *source, ulong n, Error &err) {
@@ -220,7 +366,7 @@ namespace Ox {
 		return p;
 	};
 	
-	// Frees previously allocated memory.
+	// Frees previously allocated memory, whichever allocator it came from.
 	void exhale(void *p);
 	
 	typedef struct {
@@ -0,0 +1,417 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/allocator.hpp"
+#include <cstring>
+#include <atomic>
+#include <new>
+
+namespace Ox {
+	inline ulong __ox_align16(ulong n) {
+		return (n + 15) & ~(ulong)15;
+	};
+
+	void *HeapAllocator::alloc(ulong n, bool zero, const char **err) {
+		void *p = zero ? std::calloc(n, 1) : std::malloc(n);
+		if(p == nullptr)
+			*err = "Couldn't allocate enough memory";
+
+		return p;
+	};
+
+	void *HeapAllocator::realloc(void *src, ulong old_n, ulong n, const char **err) {
+		(void)old_n;
+
+		void *p = std::realloc(src, n);
+		if(p == nullptr)
+			*err = "Couldn't allocate enough memory";
+
+		return p;
+	};
+
+	void HeapAllocator::free(void *p, ulong n) {
+		(void)n;
+		std::free(p);
+	};
+
+	HeapAllocator *HeapAllocator::instance(void) {
+		// Never destroyed, blocks may be freed from static destructors.
+		alignas(HeapAllocator) static u8 storage[sizeof(HeapAllocator)];
+		static HeapAllocator *heap = new (storage) HeapAllocator();
+
+		return heap;
+	};
+
+	Arena::Arena(void) {
+		chunk_size = 64 * 1024;
+	};
+
+	Arena::Arena(ulong n) {
+		chunk_size = n < 256 ? 256 : n;
+	};
+
+	Arena::~Arena(void) {
+		release();
+	};
+
+	Arena::chunk_t *Arena::grow(ulong n, const char **err) {
+		ulong capacity = n > chunk_size ? n : chunk_size;
+
+		// Chunks come straight from the heap, they don't carry a block header.
+		chunk_t *c = (chunk_t *)std::malloc(__ox_align16(sizeof(chunk_t)) + capacity);
+		if(c == nullptr) {
+			*err = "Couldn't allocate enough memory";
+			return nullptr;
+		}
+
+		c->prev = top;
+		c->capacity = capacity;
+		c->used = 0;
+
+		top = c;
+		return c;
+	};
+
+	void *Arena::alloc(ulong n, bool zero, const char **err) {
+		n = __ox_align16(n);
+
+		chunk_t *c = top;
+		if(c == nullptr || c->capacity - c->used < n)
+			c = grow(n, err);
+
+		if(c == nullptr)
+			return nullptr;
+
+		u8 *p = (u8 *)c + __ox_align16(sizeof(chunk_t)) + c->used;
+		c->used += n;
+
+		if(zero)
+			std::memset(p, 0, n);
+
+		return p;
+	};
+
+	void *Arena::realloc(void *src, ulong old_n, ulong n, const char **err) {
+		ulong old_aligned = __ox_align16(old_n);
+		ulong aligned = __ox_align16(n);
+
+		// Most recent block: grow or shrink in place.
+		chunk_t *c = top;
+		if(c != nullptr) {
+			u8 *base = (u8 *)c + __ox_align16(sizeof(chunk_t));
+
+			if((u8 *)src + old_aligned == base + c->used
+				&& c->used - old_aligned + aligned <= c->capacity
+			) {
+				c->used = c->used - old_aligned + aligned;
+				return src;
+			}
+		}
+
+		if(aligned <= old_aligned)
+			return src;
+
+		void *p = alloc(n, false, err);
+		if(p == nullptr)
+			return nullptr;
+
+		std::memcpy(p, src, old_n);
+		return p;
+	};
+
+	void Arena::free(void *p, ulong n) {
+		chunk_t *c = top;
+		if(c == nullptr)
+			return;
+
+		n = __ox_align16(n);
+
+		u8 *base = (u8 *)c + __ox_align16(sizeof(chunk_t));
+		if((u8 *)p + n == base + c->used)
+			c->used -= n;
+	};
+
+	void Arena::reset(void) {
+		if(top == nullptr)
+			return;
+
+		chunk_t *c = top->prev;
+		while(c != nullptr) {
+			chunk_t *prev = c->prev;
+			std::free(c);
+			c = prev;
+		};
+
+		top->prev = nullptr;
+		top->used = 0;
+	};
+
+	void Arena::release(void) {
+		chunk_t *c = top;
+		while(c != nullptr) {
+			chunk_t *prev = c->prev;
+			std::free(c);
+			c = prev;
+		};
+
+		top = nullptr;
+	};
+
+	bool Arena::owns(const void *p) {
+		for(chunk_t *c = top; c != nullptr; c = c->prev) {
+			u8 *base = (u8 *)c + __ox_align16(sizeof(chunk_t));
+			if((u8 *)p >= base && (u8 *)p < base + c->capacity)
+				return true;
+		}
+
+		return false;
+	};
+
+	ulong Arena::used(void) {
+		ulong n = 0;
+		for(chunk_t *c = top; c != nullptr; c = c->prev)
+			n += c->used;
+
+		return n;
+	};
+
+	ulong Arena::capacity(void) {
+		ulong n = 0;
+		for(chunk_t *c = top; c != nullptr; c = c->prev)
+			n += c->capacity;
+
+		return n;
+	};
+
+	typedef struct __ox_pool_node_t {
+		__ox_pool_node_t *next;
+	} __ox_pool_node_t;
+
+	static const ulong __ox_pool_slab_size = 64 * 1024;
+	// A thread gives half its cache back once a class holds this many bytes.
+	static const ulong __ox_pool_cache_limit = 2 * __ox_pool_slab_size;
+
+	static std::atomic<__ox_pool_node_t *> __ox_pool_shared[PoolAllocator::num_classes];
+	static std::atomic<u64> __ox_pool_hits { 0 };
+	static std::atomic<u64> __ox_pool_misses { 0 };
+	static std::atomic<u64> __ox_pool_oversized { 0 };
+	static std::atomic<u64> __ox_pool_slabs { 0 };
+
+	// Pushing a chain only needs a CAS on the head and popping always takes
+	// the whole list with 'exchange', so there is no ABA to worry about.
+	static void __ox_pool_give(uint c, __ox_pool_node_t *first, __ox_pool_node_t *last) {
+		__ox_pool_node_t *head = __ox_pool_shared[c].load(std::memory_order_relaxed);
+
+		do {
+			last->next = head;
+		} while(!__ox_pool_shared[c].compare_exchange_weak(head, first,
+			std::memory_order_release, std::memory_order_relaxed));
+	};
+
+	typedef struct __ox_pool_cache_t {
+		__ox_pool_node_t *head[PoolAllocator::num_classes] = {};
+		ulong count[PoolAllocator::num_classes] = {};
+		u64 hits = 0;
+
+		void fold(void) {
+			if(hits == 0)
+				return;
+
+			__ox_pool_hits.fetch_add(hits, std::memory_order_relaxed);
+			hits = 0;
+		};
+
+		// Gives away every block but the first 'keep' ones.
+		void trim(uint c, ulong keep) {
+			if(count[c] <= keep)
+				return;
+
+			__ox_pool_node_t *first = head[c];
+			__ox_pool_node_t *last = first;
+
+			if(keep == 0) {
+				head[c] = nullptr;
+			} else {
+				for(ulong i = 1; i < keep; i++)
+					first = first->next;
+
+				last = first;
+				first = first->next;
+				last->next = nullptr;
+				last = first;
+			}
+
+			while(last->next != nullptr)
+				last = last->next;
+
+			__ox_pool_give(c, first, last);
+			count[c] = keep;
+		};
+
+		bool refill(uint c) {
+			__ox_pool_node_t *list = __ox_pool_shared[c].exchange(nullptr, std::memory_order_acquire);
+
+			if(list == nullptr) {
+				ulong block = PoolAllocator::min_block << c;
+				u8 *slab = (u8 *)std::malloc(__ox_pool_slab_size);
+				if(slab == nullptr)
+					return false;
+
+				__ox_pool_slabs.fetch_add(1, std::memory_order_relaxed);
+
+				for(ulong off = __ox_pool_slab_size; off >= block; off -= block) {
+					__ox_pool_node_t *node = (__ox_pool_node_t *)(slab + off - block);
+					node->next = list;
+					list = node;
+				};
+			}
+
+			ulong n = 0;
+			for(__ox_pool_node_t *node = list; node != nullptr; node = node->next)
+				n++;
+
+			head[c] = list;
+			count[c] = n;
+
+			return true;
+		};
+
+		~__ox_pool_cache_t(void) {
+			for(uint c = 0; c < PoolAllocator::num_classes; c++)
+				if(head[c] != nullptr)
+					trim(c, 0);
+
+			fold();
+		};
+	} __ox_pool_cache_t;
+
+	static thread_local __ox_pool_cache_t __ox_pool_cache;
+
+	uint PoolAllocator::size_class(ulong n) {
+		uint c = 0;
+		ulong block = min_block;
+
+		while(block < n) {
+			block <<= 1;
+			c++;
+		};
+
+		return c;
+	};
+
+	void *PoolAllocator::alloc(ulong n, bool zero, const char **err) {
+		if(n > max_block) {
+			__ox_pool_oversized.fetch_add(1, std::memory_order_relaxed);
+			return HeapAllocator::instance()->alloc(n, zero, err);
+		}
+
+		uint c = size_class(n);
+		__ox_pool_cache_t &cache = __ox_pool_cache;
+
+		if(cache.head[c] == nullptr) {
+			__ox_pool_misses.fetch_add(1, std::memory_order_relaxed);
+			cache.fold();
+
+			if(cache.refill(c) == false) {
+				*err = "Couldn't allocate enough memory";
+				return nullptr;
+			}
+		} else {
+			cache.hits++;
+		}
+
+		__ox_pool_node_t *node = cache.head[c];
+		cache.head[c] = node->next;
+		cache.count[c]--;
+
+		if(zero)
+			std::memset(node, 0, min_block << c);
+
+		return node;
+	};
+
+	void *PoolAllocator::realloc(void *src, ulong old_n, ulong n, const char **err) {
+		if(old_n > max_block && n > max_block)
+			return HeapAllocator::instance()->realloc(src, old_n, n, err);
+
+		if(old_n <= max_block && n <= max_block && size_class(old_n) == size_class(n))
+			return src;
+
+		void *p = alloc(n, false, err);
+		if(p == nullptr)
+			return nullptr;
+
+		std::memcpy(p, src, old_n < n ? old_n : n);
+		free(src, old_n);
+
+		return p;
+	};
+
+	void PoolAllocator::free(void *p, ulong n) {
+		if(n > max_block) {
+			HeapAllocator::instance()->free(p, n);
+			return;
+		}
+
+		uint c = size_class(n);
+		__ox_pool_cache_t &cache = __ox_pool_cache;
+
+		__ox_pool_node_t *node = (__ox_pool_node_t *)p;
+		node->next = cache.head[c];
+		cache.head[c] = node;
+		cache.count[c]++;
+
+		if(cache.count[c] * (min_block << c) > __ox_pool_cache_limit)
+			cache.trim(c, cache.count[c] >> 1);
+	};
+
+	PoolAllocator::stats_t PoolAllocator::stats(void) {
+		__ox_pool_cache.fold();
+
+		stats_t s;
+		s.hits = __ox_pool_hits.load(std::memory_order_relaxed);
+		s.misses = __ox_pool_misses.load(std::memory_order_relaxed);
+		s.oversized = __ox_pool_oversized.load(std::memory_order_relaxed);
+		s.slabs = __ox_pool_slabs.load(std::memory_order_relaxed);
+
+		return s;
+	};
+
+	PoolAllocator *PoolAllocator::instance(void) {
+		// Never destroyed, same as the heap.
+		alignas(PoolAllocator) static u8 storage[sizeof(PoolAllocator)];
+		static PoolAllocator *pool = new (storage) PoolAllocator();
+
+		return pool;
+	};
+
+	static thread_local Allocator *__ox_current_allocator = nullptr;
+
+	Allocator *current_allocator(void) {
+		Allocator *a = __ox_current_allocator;
+		if(a == nullptr)
+			return HeapAllocator::instance();
+
+		return a;
+	};
+
+	Allocator *use_allocator(Allocator *a) {
+		Allocator *previous = current_allocator();
+		__ox_current_allocator = a;
+		return previous;
+	};
+};
@@ -0,0 +1,943 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/io/async.hpp"
+#include "../include/core/elastic.hpp"
+#include "../include/core/thread.hpp"
+#include "../include/core/threadpool.hpp"
+#include <cstring>
+#include <cerrno>
+#include <new>
+
+#ifdef OX_DISABLE_ASYNCIO
+	#warning "Flag OX_DISABLE_ASYNCIO is set"
+#endif
+
+#if !defined(OX_DISABLE_ASYNCIO) && !defined(OX_OS_WINDOWS) \
+	&& ox_has_include(<fcntl.h>) && ox_has_include(<unistd.h>)
+	#define OX_USE_ASYNCIO
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	// Straight system calls, no liburing: the whole ABI is in this header.
+	#if defined(OX_OS_LINUX) && ox_has_include(<linux/io_uring.h>) \
+		&& ox_has_include(<sys/syscall.h>) && ox_has_include(<sys/mman.h>) && ox_has_include(<sys/uio.h>)
+		#include <linux/io_uring.h>
+		#include <sys/syscall.h>
+		#include <sys/mman.h>
+		#include <sys/uio.h>
+
+		#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+			#define OX_USE_ASYNCIO_URING
+		#endif
+	#endif
+#endif
+
+namespace Ox {
+	#ifdef OX_USE_ASYNCIO
+		typedef AsyncIO::request_t __ox_async_request_t;
+
+		// Kernels clamp rings to 32768 entries, nobody needs that many.
+		static const uint __ox_async_max_depth = 4096;
+		// Single transfers are capped so 'len' fits the SQE, the rest is
+		// requeued like any short transfer.
+		static const ulong __ox_async_max_transfer = 1ul << 30;
+
+		typedef struct __ox_async_t {
+			AsyncIO::backend_t backend = AsyncIO::backend_none;
+			uint depth = 0;
+			uint pending = 0;
+
+			Elastic<io_slice_t> buffers;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				int ring = -1;
+
+				u8 *sq_ring = nullptr;
+				ulong sq_ring_length = 0;
+				u8 *cq_ring = nullptr;
+				ulong cq_ring_length = 0;
+				struct io_uring_sqe *sqes = nullptr;
+				ulong sqes_length = 0;
+
+				Atomic<u32> *sq_tail = nullptr;
+				u32 sq_mask = 0;
+				Atomic<u32> *cq_head = nullptr;
+				Atomic<u32> *cq_tail = nullptr;
+				u32 cq_mask = 0;
+				struct io_uring_cqe *cqes = nullptr;
+
+				// Our copy of the SQ tail, and how many SQEs behind it the
+				// kernel hasn't been told about.
+				u32 tail = 0;
+				u32 unsubmitted = 0;
+			#endif
+
+			// Thread backend.
+			ThreadPool pool;
+			TaskGroup group { pool };
+			Mutex lock;
+			CondVar done;
+			// Queued, in order; not handed to the pool yet.
+			__ox_async_request_t *queued = nullptr;
+			__ox_async_request_t *queued_last = nullptr;
+			// Finished by a worker, not reaped yet. Guarded by 'lock'.
+			__ox_async_request_t *completed = nullptr;
+			// Taken from 'completed', callbacks still to run. Kept here so
+			// a 'poll' nested in a callback picks them up instead of
+			// waiting on requests that are already done.
+			__ox_async_request_t *finishing = nullptr;
+		} __ox_async_t;
+
+		// Accounts for 'res', bytes or -errno. False when the rest of the
+		// transfer must be queued again.
+		static bool __ox_async_progress(__ox_async_request_t &r, long res) {
+			if(res < 0) {
+				r.code = -res;
+				r.result = -1;
+				return true;
+			}
+
+			r.transferred += res;
+
+			if(r.op == AsyncIO::op_fsync || r.transferred >= r.length) {
+				r.result = r.transferred;
+				return true;
+			}
+
+			// Reading, the end of the file; writing, a full disk or the like.
+			if(res == 0) {
+				if(r.op == AsyncIO::op_write) {
+					r.code = EIO;
+					r.result = -1;
+				} else {
+					r.result = r.transferred;
+				}
+
+				return true;
+			}
+
+			return false;
+		};
+
+		static void __ox_async_finish(__ox_async_t *a, __ox_async_request_t &r) {
+			a->pending--;
+			r.done = true;
+
+			// Last, the callback may well queue 'r' again.
+			if(r.callback != nullptr)
+				r.callback(r, r.user);
+		};
+
+		// Registered buffer holding [s, s + n), or -1.
+		static int __ox_async_buffer(__ox_async_t *a, u8 *s, ulong n) {
+			for(long i = 0; i < a->buffers.size(); i++) {
+				io_slice_t &b = a->buffers[i];
+
+				if(s >= b.data && s + n <= b.data + b.length)
+					return i;
+			};
+
+			return -1;
+		};
+
+		// Blocking, on a pool thread.
+		static void __ox_async_run(__ox_async_request_t &r) {
+			for(;;) {
+				long res;
+
+				if(r.op == AsyncIO::op_fsync) {
+					#if defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+						res = fdatasync(r.file);
+					#else
+						res = fsync(r.file);
+					#endif
+				} else {
+					ulong n = r.length - r.transferred;
+					if(n > __ox_async_max_transfer)
+						n = __ox_async_max_transfer;
+
+					if(r.op == AsyncIO::op_read)
+						res = ::pread(r.file, r.data + r.transferred, n, r.offset + r.transferred);
+					else
+						res = ::pwrite(r.file, r.data + r.transferred, n, r.offset + r.transferred);
+				}
+
+				if(res < 0) {
+					if(errno == EINTR)
+						continue;
+
+					res = -errno;
+				}
+
+				if(__ox_async_progress(r, res))
+					return;
+			};
+		};
+
+		static void __ox_async_spawn(__ox_async_t *a) {
+			__ox_async_request_t *r = a->queued;
+			a->queued = a->queued_last = nullptr;
+
+			while(r != nullptr) {
+				__ox_async_request_t *next = r->next;
+				Error meh;
+
+				// Runs inline when the pool has no worker to give.
+				a->group.spawn(meh, [a, r](void) {
+					__ox_async_run(*r);
+
+					Error meh;
+					(void)a->lock.lock(meh);
+					r->next = a->completed;
+					a->completed = r;
+					a->done.notify_one();
+					(void)a->lock.unlock(meh);
+				});
+
+				r = next;
+			};
+		};
+
+		#ifdef OX_USE_ASYNCIO_URING
+			static void __ox_uring_teardown(__ox_async_t *a) {
+				if(a->sqes != nullptr)
+					munmap(a->sqes, a->sqes_length);
+				if(a->cq_ring != nullptr && a->cq_ring != a->sq_ring)
+					munmap(a->cq_ring, a->cq_ring_length);
+				if(a->sq_ring != nullptr)
+					munmap(a->sq_ring, a->sq_ring_length);
+				if(a->ring >= 0)
+					::close(a->ring);
+
+				a->sqes = nullptr;
+				a->sq_ring = a->cq_ring = nullptr;
+				a->ring = -1;
+			};
+
+			static u8 *__ox_uring_map(__ox_async_t *a, ulong n, u64 offset, Error &err) {
+				void *p = mmap(nullptr, n, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a->ring, offset);
+				if(p == MAP_FAILED) {
+					err.from_fmt("Couldn't map the io_uring: %s", std::strerror(errno));
+					err.from_c("Couldn't map the io_uring");
+					return nullptr;
+				}
+
+				return (u8 *)p;
+			};
+
+			static int __ox_uring_setup(__ox_async_t *a, Error &err) {
+				struct io_uring_params p;
+				std::memset(&p, 0, sizeof(p));
+
+				a->ring = (int)syscall(__NR_io_uring_setup, a->depth, &p);
+				if(a->ring < 0) {
+					err.from_fmt("Couldn't set io_uring up: %s", std::strerror(errno));
+					err.from_c("Couldn't set io_uring up");
+					return -1;
+				}
+
+				// Came with IORING_OP_READ/WRITE, in Linux 5.6.
+				if((p.features & IORING_FEAT_RW_CUR_POS) == 0) {
+					err = "io_uring is too old, Linux 5.6 or later needed";
+					__ox_uring_teardown(a);
+					return -1;
+				}
+
+				a->sq_ring_length = p.sq_off.array + p.sq_entries * sizeof(u32);
+				a->cq_ring_length = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+
+				bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+				if(single && a->cq_ring_length > a->sq_ring_length)
+					a->sq_ring_length = a->cq_ring_length;
+
+				a->sq_ring = __ox_uring_map(a, a->sq_ring_length, IORING_OFF_SQ_RING, err);
+				if(a->sq_ring != nullptr)
+					a->cq_ring = single ? a->sq_ring : __ox_uring_map(a, a->cq_ring_length, IORING_OFF_CQ_RING, err);
+
+				a->sqes_length = p.sq_entries * sizeof(struct io_uring_sqe);
+				if(a->cq_ring != nullptr)
+					a->sqes = (struct io_uring_sqe *)__ox_uring_map(a, a->sqes_length, IORING_OFF_SQES, err);
+
+				if(a->sqes == nullptr) {
+					__ox_uring_teardown(a);
+					return -1;
+				}
+
+				a->sq_tail = (Atomic<u32> *)(a->sq_ring + p.sq_off.tail);
+				a->sq_mask = *(u32 *)(a->sq_ring + p.sq_off.ring_mask);
+				a->cq_head = (Atomic<u32> *)(a->cq_ring + p.cq_off.head);
+				a->cq_tail = (Atomic<u32> *)(a->cq_ring + p.cq_off.tail);
+				a->cq_mask = *(u32 *)(a->cq_ring + p.cq_off.ring_mask);
+				a->cqes = (struct io_uring_cqe *)(a->cq_ring + p.cq_off.cqes);
+				a->tail = a->sq_tail->load(order_relaxed);
+
+				// SQEs are filled in ring order, each slot always points to
+				// the SQE of the same index.
+				u32 *array = (u32 *)(a->sq_ring + p.sq_off.array);
+				for(u32 i = 0; i < p.sq_entries; i++)
+					array[i] = i;
+
+				// Never more in flight than the SQ holds; the CQ is twice as
+				// large, so it can't overflow either.
+				if(a->depth > p.sq_entries)
+					a->depth = p.sq_entries;
+
+				return 0;
+			};
+
+			// Room is guaranteed: no more than 'depth' requests are ever
+			// pending and the kernel takes every SQE it's told about.
+			static void __ox_uring_push(__ox_async_t *a, __ox_async_request_t &r) {
+				struct io_uring_sqe *sqe = &a->sqes[a->tail & a->sq_mask];
+				std::memset(sqe, 0, sizeof(*sqe));
+
+				sqe->fd = r.file;
+				sqe->user_data = (u64)(pointer_t)&r;
+
+				if(r.op == AsyncIO::op_fsync) {
+					sqe->opcode = IORING_OP_FSYNC;
+					sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+				} else {
+					ulong n = r.length - r.transferred;
+					if(n > __ox_async_max_transfer)
+						n = __ox_async_max_transfer;
+
+					bool fixed = r.buffer >= 0;
+					if(r.op == AsyncIO::op_read)
+						sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+					else
+						sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+
+					sqe->addr = (u64)(pointer_t)(r.data + r.transferred);
+					sqe->len = (u32)n;
+					sqe->off = r.offset + r.transferred;
+					sqe->buf_index = fixed ? r.buffer : 0;
+				}
+
+				a->tail++;
+				a->sq_tail->store(a->tail, order_release);
+				a->unsubmitted++;
+			};
+
+			// Submits everything unsubmitted, waiting for 'min' completions.
+			static long __ox_uring_enter(__ox_async_t *a, uint min, Error &err) {
+				for(;;) {
+					long r = syscall(__NR_io_uring_enter, a->ring, a->unsubmitted, min,
+						min > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+					if(r >= 0) {
+						a->unsubmitted -= r;
+						return r;
+					}
+
+					if(errno == EINTR)
+						continue;
+
+					// Short on memory for now: reaping frees some.
+					if(errno == EAGAIN || errno == EBUSY)
+						return 0;
+
+					err.from_fmt("Couldn't enter the io_uring: %s", std::strerror(errno));
+					err.from_c("Couldn't enter the io_uring");
+					return -1;
+				};
+			};
+
+			static long __ox_uring_reap(__ox_async_t *a) {
+				long n = 0;
+
+				for(;;) {
+					// Read again every time: a callback queueing past the
+					// depth reaps from in here, moving the head on.
+					u32 head = a->cq_head->load(order_relaxed);
+					if(head == a->cq_tail->load(order_acquire))
+						break;
+
+					struct io_uring_cqe *cqe = &a->cqes[head & a->cq_mask];
+					__ox_async_request_t *r = (__ox_async_request_t *)(pointer_t)cqe->user_data;
+					long res = cqe->res;
+
+					// Hand the slot back before any callback queues more.
+					a->cq_head->store(head + 1, order_release);
+
+					if(__ox_async_progress(*r, res)) {
+						__ox_async_finish(a, *r);
+						n++;
+					} else {
+						__ox_uring_push(a, *r);
+					}
+				};
+
+				return n;
+			};
+		#endif
+	#endif
+
+	AsyncIO::~AsyncIO(void) {
+		release();
+	};
+
+	int AsyncIO::init(Error &err) {
+		return init(options_t(), err);
+	};
+
+	int AsyncIO::init(options_t options, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle != nullptr) {
+			err = "AsyncIO already initialized";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			OX_ALLOC_TAG("async");
+
+			__ox_async_t *a = inhale<__ox_async_t>(err);
+			if(a == nullptr)
+				return -1;
+
+			new (a) __ox_async_t();
+
+			a->depth = options.depth;
+			if(a->depth < 1)
+				a->depth = 1;
+			if(a->depth > __ox_async_max_depth)
+				a->depth = __ox_async_max_depth;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				if(options.backend != backend_threads) {
+					// Containers often forbid io_uring: fall back, unless asked
+					// for it explicitly.
+					if(__ox_uring_setup(a, err) == 0)
+						a->backend = backend_uring;
+					else if(options.backend == backend_none)
+						err.clear();
+				}
+			#else
+				if(options.backend == backend_uring)
+					err = "io_uring isn't supported on this platform";
+			#endif
+
+			if(err == nullptr && a->backend == backend_none) {
+				uint threads = options.threads;
+				if(threads == 0)
+					threads = a->depth < 16 ? a->depth : 16;
+
+				if(a->pool.init(err, threads + 1) == 0)
+					a->backend = backend_threads;
+			}
+
+			if(err != nullptr) {
+				a->~__ox_async_t();
+				exhale(a);
+				return -1;
+			}
+
+			handle = a;
+			return 0;
+		#else
+			(void)options;
+			err = "AsyncIO isn't supported on this platform";
+			return -1;
+		#endif
+	};
+
+	void AsyncIO::release(void) {
+		#ifdef OX_USE_ASYNCIO
+			__ox_async_t *a = (__ox_async_t *)handle;
+			if(a == nullptr)
+				return;
+
+			Error meh;
+			(void)drain(meh);
+			(void)meh;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				__ox_uring_teardown(a);
+			#endif
+
+			a->group.wait();
+			a->pool.release();
+
+			a->~__ox_async_t();
+			exhale(a);
+			handle = nullptr;
+		#endif
+	};
+
+	AsyncIO::backend_t AsyncIO::backend(void) {
+		#ifdef OX_USE_ASYNCIO
+			if(handle != nullptr)
+				return ((__ox_async_t *)handle)->backend;
+		#endif
+
+		return backend_none;
+	};
+
+	uint AsyncIO::pending(void) {
+		#ifdef OX_USE_ASYNCIO
+			if(handle != nullptr)
+				return ((__ox_async_t *)handle)->pending;
+		#endif
+
+		return 0;
+	};
+
+	int AsyncIO::open(const char *path, openmode mode, Error &err) {
+		return open(path, mode, FileStream::options_t(), err);
+	};
+
+	int AsyncIO::open(const char *path, openmode mode, FileStream::options_t options, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(path == nullptr) {
+			err = "'path' is NULL";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			// As FileStream: 'out' alone truncates or creates, 'in | out'
+			// wants an existing file.
+			int flags = O_CLOEXEC;
+			if((mode & Ox::openmode::in) && (mode & Ox::openmode::out))
+				flags |= O_RDWR;
+			else if(mode & Ox::openmode::out)
+				flags |= O_WRONLY | O_CREAT | O_TRUNC;
+			else
+				flags |= O_RDONLY;
+
+			if(options.direct) {
+				#ifdef O_DIRECT
+					flags |= O_DIRECT;
+				#elif !defined(F_NOCACHE)
+					err = "O_DIRECT isn't supported";
+					return -1;
+				#endif
+			}
+
+			int fd;
+			do {
+				fd = ::open(path, flags, 0666);
+			} while(fd < 0 && errno == EINTR);
+
+			if(fd < 0) {
+				err = std::strerror(errno);
+				return -1;
+			}
+
+			#if !defined(O_DIRECT) && defined(F_NOCACHE)
+				if(options.direct && fcntl(fd, F_NOCACHE, 1) != 0) {
+					err = std::strerror(errno);
+					::close(fd);
+					return -1;
+				}
+			#endif
+
+			// A hint, like FileStream::advise.
+			#ifdef POSIX_FADV_NORMAL
+				int advice = POSIX_FADV_NORMAL;
+				if(options.advice == FileStream::advice_sequential) advice = POSIX_FADV_SEQUENTIAL;
+				if(options.advice == FileStream::advice_random) advice = POSIX_FADV_RANDOM;
+				if(options.advice == FileStream::advice_willneed) advice = POSIX_FADV_WILLNEED;
+				if(options.advice == FileStream::advice_dontneed) advice = POSIX_FADV_DONTNEED;
+
+				if(options.advice != FileStream::advice_normal)
+					(void)posix_fadvise(fd, 0, 0, advice);
+			#endif
+
+			return fd;
+		#else
+			(void)mode;
+			(void)options;
+			err = "AsyncIO isn't supported on this platform";
+			return -1;
+		#endif
+	};
+
+	void AsyncIO::close(int file) {
+		#ifdef OX_USE_ASYNCIO
+			if(file >= 0)
+				::close(file);
+		#else
+			(void)file;
+		#endif
+	};
+
+	int AsyncIO::register_buffers(const io_slice_t *buffers, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(buffers == nullptr && n > 0) {
+			err = "'buffers' is NULL";
+			return -1;
+		}
+
+		if(unregister_buffers(err) != 0)
+			return -1;
+
+		#ifdef OX_USE_ASYNCIO
+			__ox_async_t *a = (__ox_async_t *)handle;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				if(a->backend == backend_uring && n > 0) {
+					OX_ALLOC_TAG("async");
+
+					struct iovec *iov = inhale_raw<struct iovec>(n, err);
+					if(iov == nullptr)
+						return -1;
+
+					for(ulong i = 0; i < n; i++) {
+						iov[i].iov_base = buffers[i].data;
+						iov[i].iov_len = buffers[i].length;
+					};
+
+					long r = syscall(__NR_io_uring_register, a->ring, IORING_REGISTER_BUFFERS, iov, (uint)n);
+					exhale(iov);
+
+					// RLIMIT_MEMLOCK caps how much can be pinned.
+					if(r < 0) {
+						err.from_fmt("Couldn't register the buffers: %s", std::strerror(errno));
+						err.from_c("Couldn't register the buffers");
+						return -1;
+					}
+				}
+			#endif
+
+			if(a->buffers.append(buffers, n, err) < 0) {
+				Error meh;
+				(void)unregister_buffers(meh);
+				return -1;
+			}
+
+			return 0;
+		#else
+			return -1;
+		#endif
+	};
+
+	int AsyncIO::unregister_buffers(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			__ox_async_t *a = (__ox_async_t *)handle;
+
+			if(a->pending > 0) {
+				err = "Requests are still pending";
+				return -1;
+			}
+
+			if(a->buffers.is_empty())
+				return 0;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				if(a->backend == backend_uring)
+					(void)syscall(__NR_io_uring_register, a->ring, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+			#endif
+
+			a->buffers.clear();
+			return 0;
+		#else
+			return -1;
+		#endif
+	};
+
+	int AsyncIO::queue(request_t &r, Error &err) {
+		#ifdef OX_USE_ASYNCIO
+			__ox_async_t *a = (__ox_async_t *)handle;
+
+			if(a->pending >= a->depth && poll(err, 1) < 0)
+				return -1;
+
+			r.result = 0;
+			r.code = 0;
+			r.done = false;
+			r.transferred = 0;
+			r.next = nullptr;
+
+			a->pending++;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				if(a->backend == backend_uring) {
+					__ox_uring_push(a, r);
+					return 0;
+				}
+			#endif
+
+			if(a->queued_last != nullptr)
+				a->queued_last->next = &r;
+			else
+				a->queued = &r;
+
+			a->queued_last = &r;
+			return 0;
+		#else
+			(void)r;
+			(void)err;
+			return -1;
+		#endif
+	};
+
+	int AsyncIO::read(request_t &r, int file, u8 *s, ulong n, ulong offset, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		if(s == nullptr && n > 0) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			r.op = op_read;
+			r.file = file;
+			r.data = s;
+			r.length = n;
+			r.offset = offset;
+			r.buffer = __ox_async_buffer((__ox_async_t *)handle, s, n);
+
+			return queue(r, err);
+		#else
+			(void)r;
+			(void)file;
+			(void)offset;
+			return -1;
+		#endif
+	};
+
+	int AsyncIO::write(request_t &r, int file, u8 *s, ulong n, ulong offset, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		if(s == nullptr && n > 0) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			r.op = op_write;
+			r.file = file;
+			r.data = s;
+			r.length = n;
+			r.offset = offset;
+			r.buffer = __ox_async_buffer((__ox_async_t *)handle, s, n);
+
+			return queue(r, err);
+		#else
+			(void)r;
+			(void)file;
+			(void)offset;
+			return -1;
+		#endif
+	};
+
+	int AsyncIO::fsync(request_t &r, int file, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		r.op = op_fsync;
+		r.file = file;
+		r.data = nullptr;
+		r.length = 0;
+		r.offset = 0;
+		r.buffer = -1;
+
+		return queue(r, err);
+	};
+
+	long AsyncIO::submit(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			__ox_async_t *a = (__ox_async_t *)handle;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				if(a->backend == backend_uring) {
+					long n = 0;
+
+					while(a->unsubmitted > 0) {
+						long r = __ox_uring_enter(a, 0, err);
+						if(r < 0)
+							return -1;
+						if(r == 0)
+							break;
+
+						n += r;
+					};
+
+					return n;
+				}
+			#endif
+
+			long n = 0;
+			for(request_t *r = a->queued; r != nullptr; r = r->next)
+				n++;
+
+			__ox_async_spawn(a);
+			return n;
+		#else
+			return -1;
+		#endif
+	};
+
+	long AsyncIO::poll(Error &err, uint min) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		#ifdef OX_USE_ASYNCIO
+			__ox_async_t *a = (__ox_async_t *)handle;
+
+			if(min > a->pending)
+				min = a->pending;
+
+			long reaped = 0;
+
+			#ifdef OX_USE_ASYNCIO_URING
+				if(a->backend == backend_uring) {
+					reaped = __ox_uring_reap(a);
+
+					// Reaping may queue more: short transfers and callbacks. A
+					// nested 'poll' may also have reaped some of ours.
+					while(a->unsubmitted > 0 || ((ulong)reaped < min && a->pending > 0)) {
+						uint want = (ulong)reaped < min && a->pending > 0 ? 1 : 0;
+
+						long r = __ox_uring_enter(a, want, err);
+						if(r < 0)
+							return -1;
+
+						long n = __ox_uring_reap(a);
+						reaped += n;
+
+						if(r == 0 && n == 0 && want == 0)
+							break;
+					};
+
+					return reaped;
+				}
+			#endif
+
+			for(;;) {
+				__ox_async_spawn(a);
+
+				if(a->finishing == nullptr) {
+					Error meh;
+					(void)a->lock.lock(meh);
+
+					while(a->completed == nullptr && (ulong)reaped < min && a->pending > 0)
+						(void)a->done.wait(a->lock, meh);
+
+					a->finishing = a->completed;
+					a->completed = nullptr;
+					(void)a->lock.unlock(meh);
+					(void)meh;
+
+					if(a->finishing == nullptr)
+						break;
+				}
+
+				while(a->finishing != nullptr) {
+					request_t *r = a->finishing;
+					a->finishing = r->next;
+
+					__ox_async_finish(a, *r);
+					reaped++;
+				};
+			};
+
+			return reaped;
+		#else
+			(void)min;
+			return -1;
+		#endif
+	};
+
+	long AsyncIO::wait(request_t &r, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		while(!r.done) {
+			if(pending() == 0) {
+				err = "Request isn't pending";
+				return -1;
+			}
+
+			if(poll(err, 1) < 0)
+				return -1;
+		};
+
+		if(r.result < 0) {
+			err.from_fmt("Asynchronous I/O failed: %s", std::strerror(r.code));
+			err.from_c("Asynchronous I/O failed");
+		}
+
+		return r.result;
+	};
+
+	int AsyncIO::drain(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle == nullptr) {
+			err = "Unitialized AsyncIO";
+			return -1;
+		}
+
+		while(pending() > 0)
+			if(poll(err, pending()) < 0)
+				return -1;
+
+		return 0;
+	};
+};
@@ -0,0 +1,302 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/atom.hpp"
+#include "../include/core/allocator.hpp"
+#include "../include/core/string.hpp"
+#include "../include/core/stats.hpp"
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace Ox {
+	typedef struct __atom_entry_t {
+		StringPool *pool;
+		std::atomic<long> refs;
+		u64 hash;
+		ulong length;
+		__atom_entry_t *next;
+		char data[1];
+	} __atom_entry_t;
+
+	Atom::Atom(const Atom &other) {
+		handle = other.handle;
+
+		if(handle != nullptr)
+			((__atom_entry_t *)handle)->refs.fetch_add(1, std::memory_order_relaxed);
+	};
+
+	Atom::Atom(Atom &&other) {
+		handle = other.handle;
+		other.handle = nullptr;
+	};
+
+	Atom::~Atom(void) {
+		if(handle == nullptr)
+			return;
+
+		__atom_entry_t *e = (__atom_entry_t *)handle;
+		handle = nullptr;
+
+		// Only the last reference takes the shard lock, so 'intern' never
+		// hands out an entry that is about to be freed.
+		long refs = e->refs.load(std::memory_order_relaxed);
+		while(refs > 1) {
+			if(e->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_release, std::memory_order_relaxed))
+				return;
+		};
+
+		e->pool->remove(e);
+	};
+
+	Atom &Atom::operator=(const Atom &other) {
+		if(handle == other.handle)
+			return *this;
+
+		Atom copy(other);
+		this->~Atom();
+		handle = copy.handle;
+		copy.handle = nullptr;
+
+		return *this;
+	};
+
+	Atom &Atom::operator=(Atom &&other) {
+		if(this == &other)
+			return *this;
+
+		this->~Atom();
+		handle = other.handle;
+		other.handle = nullptr;
+
+		return *this;
+	};
+
+	const char *Atom::c_str(void) const {
+		if(handle == nullptr)
+			return nullptr;
+
+		return ((__atom_entry_t *)handle)->data;
+	};
+
+	ulong Atom::length(void) const {
+		if(handle == nullptr)
+			return 0;
+
+		return ((__atom_entry_t *)handle)->length;
+	};
+
+	u64 Atom::hash(void) const {
+		if(handle == nullptr)
+			return 0;
+
+		return ((__atom_entry_t *)handle)->hash;
+	};
+
+	// FNV-1a.
+	u64 StringPool::hash(const char *s, ulong len) {
+		u64 h = 0xcbf29ce484222325;
+
+		for(ulong i = 0; i < len; i++) {
+			h ^= (u8)s[i];
+			h *= 0x100000001b3;
+		};
+
+		return h;
+	};
+
+	StringPool::~StringPool(void) {
+		for(uint i = 0; i < num_shards; i++) {
+			shard_t &s = shards[i];
+
+			for(ulong b = 0; b < s.num_buckets; b++) {
+				__atom_entry_t *e = (__atom_entry_t *)s.buckets[b];
+
+				while(e != nullptr) {
+					__atom_entry_t *next = e->next;
+					e->refs.~atomic();
+					exhale(e);
+					e = next;
+				};
+			};
+
+			if(s.buckets != nullptr)
+				exhale(s.buckets);
+		};
+	};
+
+	int StringPool::rehash(shard_t &s, Error &err) {
+		ulong n = s.num_buckets == 0 ? 16 : s.num_buckets * 2;
+
+		void **buckets = inhale<void *>(n, err);
+		if(buckets == nullptr)
+			return -1;
+
+		for(ulong b = 0; b < s.num_buckets; b++) {
+			__atom_entry_t *e = (__atom_entry_t *)s.buckets[b];
+
+			while(e != nullptr) {
+				__atom_entry_t *next = e->next;
+				ulong i = e->hash & (n - 1);
+
+				e->next = (__atom_entry_t *)buckets[i];
+				buckets[i] = e;
+				e = next;
+			};
+		};
+
+		if(s.buckets != nullptr)
+			exhale(s.buckets);
+
+		s.buckets = buckets;
+		s.num_buckets = n;
+
+		return 0;
+	};
+
+	Atom StringPool::intern(const char *s, Error &err) {
+		if(err != nullptr)
+			return Atom();
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return Atom();
+		}
+
+		return intern(s, strlen(s), err);
+	};
+
+	Atom StringPool::intern(const char *s, ulong len, Error &err) {
+		if(err != nullptr)
+			return Atom();
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return Atom();
+		}
+
+		u64 h = hash(s, len);
+		shard_t &sh = shards[h >> 60];
+
+		if(sh.lock.lock(err) != 0)
+			return Atom();
+
+		__atom_entry_t *e = nullptr;
+
+		if(sh.num_buckets > 0) {
+			e = (__atom_entry_t *)sh.buckets[h & (sh.num_buckets - 1)];
+
+			while(e != nullptr) {
+				if(e->hash == h && e->length == len && memeq(e->data, s, len))
+					break;
+
+				e = e->next;
+			};
+		}
+
+		if(e != nullptr) {
+			e->refs.fetch_add(1, std::memory_order_relaxed);
+			(void)sh.lock.unlock(err);
+			return Atom(e);
+		}
+
+		// Entries outlive whatever scope interned them.
+		ScopedAllocator heap(*HeapAllocator::instance());
+		OX_ALLOC_TAG("atom");
+
+		if(sh.size >= sh.num_buckets && rehash(sh, err) != 0) {
+			Error meh;
+			(void)sh.lock.unlock(meh);
+			return Atom();
+		}
+
+		e = (__atom_entry_t *)inhale_raw<u8>(sizeof(__atom_entry_t) + len, err);
+		if(e == nullptr) {
+			Error meh;
+			(void)sh.lock.unlock(meh);
+			return Atom();
+		}
+
+		e->pool = this;
+		new (&e->refs) std::atomic<long>(1);
+		e->hash = h;
+		e->length = len;
+		std::memcpy(e->data, s, len);
+		e->data[len] = '\0';
+
+		ulong i = h & (sh.num_buckets - 1);
+		e->next = (__atom_entry_t *)sh.buckets[i];
+		sh.buckets[i] = e;
+		sh.size++;
+
+		(void)sh.lock.unlock(err);
+		return Atom(e);
+	};
+
+	void StringPool::remove(void *entry) {
+		__atom_entry_t *e = (__atom_entry_t *)entry;
+		shard_t &sh = shards[e->hash >> 60];
+
+		Error err;
+		if(sh.lock.lock(err) != 0)
+			return;
+
+		// Someone may have interned it again in the meantime.
+		if(e->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			(void)sh.lock.unlock(err);
+			return;
+		}
+
+		__atom_entry_t **p = (__atom_entry_t **)&sh.buckets[e->hash & (sh.num_buckets - 1)];
+		while(*p != e)
+			p = &(*p)->next;
+
+		*p = e->next;
+		sh.size--;
+
+		(void)sh.lock.unlock(err);
+
+		e->refs.~atomic();
+		exhale(e);
+	};
+
+	ulong StringPool::size(void) {
+		ulong n = 0;
+
+		for(uint i = 0; i < num_shards; i++) {
+			Error err;
+			if(shards[i].lock.lock(err) != 0)
+				continue;
+
+			n += shards[i].size;
+			(void)shards[i].lock.unlock(err);
+		};
+
+		return n;
+	};
+
+	StringPool *StringPool::global(void) {
+		// Never destroyed, atoms may outlive static destructors.
+		alignas(StringPool) static u8 storage[sizeof(StringPool)];
+		static StringPool *pool = [](void) -> StringPool * {
+			ScopedAllocator heap(*HeapAllocator::instance());
+			return new (storage) StringPool();
+		}();
+
+		return pool;
+	};
+};
@@ -0,0 +1,439 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/io/buffered.hpp"
+#include "../include/core/stats.hpp"
+#include <cstring>
+
+namespace Ox {
+	int BufferedReader::init(BasicIOStream &source, Error &err) {
+		return init(source, default_capacity, err);
+	};
+
+	int BufferedReader::init(BasicIOStream &source, ulong capacity, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(capacity == 0) {
+			err = "'capacity' should be greater than zero";
+			return -1;
+		}
+
+		release();
+
+		OX_ALLOC_TAG("stream");
+
+		u8 *b = inhale_raw<u8>(capacity, err);
+		if(b == nullptr)
+			return -1;
+
+		this->source = &source;
+		this->capacity = capacity;
+		buffer = b;
+		head = tail = 0;
+
+		return 0;
+	};
+
+	void BufferedReader::release(void) {
+		if(buffer != nullptr)
+			exhale(buffer);
+
+		source = nullptr;
+		buffer = nullptr;
+		capacity = head = tail = 0;
+	};
+
+	// Only called once everything buffered was consumed.
+	long BufferedReader::fill(Error &err) {
+		head = tail = 0;
+
+		long n = source->read(buffer, capacity, err);
+		if(n < 0)
+			return -1;
+
+		tail = n;
+		return n;
+	};
+
+	int BufferedReader::take(u8 *s, ulong n, Error &err) {
+		long got = read(s, n, err);
+		if(got < 0)
+			return -1;
+
+		if((ulong)got < n) {
+			err = "Unexpected end of stream";
+			return -1;
+		}
+
+		return 0;
+	};
+
+	ulong BufferedReader::tellg(void) {
+		if(source == nullptr)
+			return -1;
+
+		return source->tellg() - (tail - head);
+	};
+
+	void BufferedReader::seekg(ulong pos) {
+		if(source == nullptr)
+			return;
+
+		head = tail = 0;
+		source->seekg(pos);
+	};
+
+	void BufferedReader::seekg(long off, seekdir dir) {
+		if(source == nullptr)
+			return;
+
+		if(dir == Ox::seekdir::cur) {
+			// Still buffered, consumed or not: no need to touch the source.
+			if((long)head + off >= 0 && (long)head + off <= (long)tail) {
+				head += off;
+				return;
+			}
+
+			off -= (long)(tail - head);
+		}
+
+		head = tail = 0;
+		source->seekg(off, dir);
+	};
+
+	ulong BufferedReader::tellp(void) {
+		if(source == nullptr)
+			return -1;
+
+		return source->tellp();
+	};
+
+	void BufferedReader::seekp(ulong pos) {
+		if(source != nullptr)
+			source->seekp(pos);
+	};
+
+	void BufferedReader::seekp(long off, seekdir dir) {
+		if(source != nullptr)
+			source->seekp(off, dir);
+	};
+
+	long BufferedReader::ignore(ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(source == nullptr) {
+			err = "Unitialized BufferedReader";
+			return -1;
+		}
+
+		ulong done = 0;
+
+		while(done < n) {
+			if(head == tail) {
+				// Whatever doesn't fit in the buffer is left to the source.
+				if(n - done >= capacity) {
+					long r = source->ignore(n - done, err);
+					if(r < 0)
+						return -1;
+
+					done += r;
+					break;
+				}
+
+				long r = fill(err);
+				if(r < 0)
+					return -1;
+				if(r == 0)
+					break;
+			}
+
+			ulong k = tail - head < n - done ? tail - head : n - done;
+			head += k;
+			done += k;
+		};
+
+		return done;
+	};
+
+	long BufferedReader::ignore(ulong n, char delimitator, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(source == nullptr) {
+			err = "Unitialized BufferedReader";
+			return -1;
+		}
+
+		ulong done = 0;
+
+		while(done < n) {
+			if(head == tail) {
+				long r = fill(err);
+				if(r < 0)
+					return -1;
+				if(r == 0)
+					break;
+			}
+
+			ulong k = tail - head < n - done ? tail - head : n - done;
+
+			// The delimitator is consumed, like std::istream::ignore does.
+			u8 *d = (u8 *)std::memchr(buffer + head, (u8)delimitator, k);
+			if(d != nullptr) {
+				ulong m = d - (buffer + head) + 1;
+				head += m;
+				done += m;
+				break;
+			}
+
+			head += k;
+			done += k;
+		};
+
+		return done;
+	};
+
+	long BufferedReader::read(u8 *s, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(source == nullptr) {
+			err = "Unitialized BufferedReader";
+			return -1;
+		}
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		ulong done = 0;
+
+		while(done < n) {
+			if(head == tail) {
+				// Reads as big as the buffer go straight into 's'.
+				if(n - done >= capacity) {
+					long r = source->read(s + done, n - done, err);
+					if(r < 0)
+						return -1;
+					if(r == 0)
+						break;
+
+					done += r;
+					continue;
+				}
+
+				long r = fill(err);
+				if(r < 0)
+					return -1;
+				if(r == 0)
+					break;
+			}
+
+			ulong k = tail - head < n - done ? tail - head : n - done;
+			std::memcpy(s + done, buffer + head, k);
+			head += k;
+			done += k;
+		};
+
+		return done;
+	};
+
+	bool BufferedReader::eof(Error &err) {
+		if(err != nullptr)
+			return true;
+
+		if(source == nullptr) {
+			err = "Unitialized BufferedReader";
+			return true;
+		}
+
+		if(head < tail)
+			return false;
+
+		return fill(err) <= 0;
+	};
+
+	int BufferedReader::write(u8 *s, ulong n, Error &err) {
+		(void)s; (void)n;
+
+		if(err != nullptr)
+			return -1;
+
+		err = "BufferedReader is read-only";
+		return -1;
+	};
+
+	int BufferedWriter::init(BasicIOStream &source, Error &err) {
+		return init(source, default_capacity, err);
+	};
+
+	int BufferedWriter::init(BasicIOStream &source, ulong capacity, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(capacity == 0) {
+			err = "'capacity' should be greater than zero";
+			return -1;
+		}
+
+		release();
+
+		OX_ALLOC_TAG("stream");
+
+		u8 *b = inhale_raw<u8>(capacity, err);
+		if(b == nullptr)
+			return -1;
+
+		this->source = &source;
+		this->capacity = capacity;
+		buffer = b;
+		used = 0;
+
+		return 0;
+	};
+
+	void BufferedWriter::release(void) {
+		Error meh;
+		(void)flush(meh);
+
+		if(buffer != nullptr)
+			exhale(buffer);
+
+		source = nullptr;
+		buffer = nullptr;
+		capacity = used = 0;
+	};
+
+	int BufferedWriter::flush(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(used == 0)
+			return 0;
+
+		if(source == nullptr) {
+			err = "Unitialized BufferedWriter";
+			return -1;
+		}
+
+		// Nothing is dropped on failure, a later flush tries again.
+		if(source->write(buffer, used, err) != 0)
+			return -1;
+
+		used = 0;
+		return 0;
+	};
+
+	ulong BufferedWriter::tellg(void) {
+		if(source == nullptr)
+			return -1;
+
+		return source->tellg();
+	};
+
+	void BufferedWriter::seekg(ulong pos) {
+		if(source != nullptr)
+			source->seekg(pos);
+	};
+
+	void BufferedWriter::seekg(long off, seekdir dir) {
+		if(source != nullptr)
+			source->seekg(off, dir);
+	};
+
+	ulong BufferedWriter::tellp(void) {
+		if(source == nullptr)
+			return -1;
+
+		return source->tellp() + used;
+	};
+
+	// The buffered bytes go where they were written; if they can't, the
+	// position is left alone and the next 'flush' reports the failure.
+	void BufferedWriter::seekp(ulong pos) {
+		Error err;
+		if(source != nullptr && flush(err) == 0)
+			source->seekp(pos);
+	};
+
+	void BufferedWriter::seekp(long off, seekdir dir) {
+		Error err;
+		if(source != nullptr && flush(err) == 0)
+			source->seekp(off, dir);
+	};
+
+	long BufferedWriter::ignore(ulong n, Error &err) {
+		(void)n;
+
+		if(err != nullptr)
+			return -1;
+
+		err = "BufferedWriter is write-only";
+		return -1;
+	};
+
+	long BufferedWriter::ignore(ulong n, char delimitator, Error &err) {
+		(void)delimitator;
+		return ignore(n, err);
+	};
+
+	long BufferedWriter::read(u8 *s, ulong n, Error &err) {
+		(void)s;
+		return ignore(n, err);
+	};
+
+	bool BufferedWriter::eof(Error &err) {
+		(void)ignore(0, err);
+		return true;
+	};
+
+	int BufferedWriter::write(u8 *s, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(source == nullptr) {
+			err = "Unitialized BufferedWriter";
+			return -1;
+		}
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		if(n <= capacity - used) {
+			std::memcpy(buffer + used, s, n);
+			used += n;
+			return 0;
+		}
+
+		if(flush(err) != 0)
+			return -1;
+
+		// Writes as big as the buffer go straight to the source.
+		if(n >= capacity)
+			return source->write(s, n, err);
+
+		std::memcpy(buffer, s, n);
+		used = n;
+
+		return 0;
+	};
+};
@@ -0,0 +1,142 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/clock.hpp"
+
+#ifdef OX_DISABLE_TSC
+	#warning "Flag OX_DISABLE_TSC is set"
+#endif
+
+#if !defined(OX_DISABLE_TSC) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) \
+	&& ox_has_include(<x86intrin.h>) && ox_has_include(<cpuid.h>)
+	#define OX_USE_CLOCK_TSC
+	#include <x86intrin.h>
+	#include <cpuid.h>
+#endif
+
+#if !defined(OX_OS_WINDOWS) && ox_has_include(<time.h>)
+	#include <time.h>
+#endif
+
+#ifdef CLOCK_MONOTONIC
+	#define OX_USE_CLOCK_POSIX
+#else
+	#include <chrono>
+#endif
+
+namespace Ox {
+	static u64 __ox_clock_os(void) {
+		#ifdef OX_USE_CLOCK_POSIX
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+		#else
+			return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		#endif
+	};
+
+	typedef struct __ox_clock_t {
+		bool tsc = false;
+		double ticks_per_ns = 1.0;
+		double ns_per_tick = 1.0;
+		// Keeps 'now' in the range where doubles are still exact.
+		u64 origin = 0;
+	} __ox_clock_t;
+
+	#ifdef OX_USE_CLOCK_TSC
+		// Only an invariant TSC ticks at a constant rate across P-states
+		// and sleep states, and is synchronised across cores.
+		static bool __ox_clock_invariant_tsc(void) {
+			uint a, b, c, d;
+
+			if(__get_cpuid(0x80000000, &a, &b, &c, &d) == 0 || a < 0x80000007)
+				return false;
+			if(__get_cpuid(0x80000007, &a, &b, &c, &d) == 0)
+				return false;
+
+			return (d & (1u << 8)) != 0;
+		};
+	#endif
+
+	static __ox_clock_t __ox_clock_calibrate(void) {
+		__ox_clock_t c;
+
+		#ifdef OX_USE_CLOCK_TSC
+			if(!__ox_clock_invariant_tsc())
+				return c;
+
+			// 10ms against the OS clock gets the rate within a few ppm.
+			u64 n0 = __ox_clock_os();
+			u64 t0 = __rdtsc();
+			u64 n1, t1;
+
+			do {
+				n1 = __ox_clock_os();
+				t1 = __rdtsc();
+			} while(n1 - n0 < 10000000);
+
+			if(t1 <= t0)
+				return c;
+
+			c.tsc = true;
+			c.ticks_per_ns = (double)(t1 - t0) / (double)(n1 - n0);
+			c.ns_per_tick = 1.0 / c.ticks_per_ns;
+			c.origin = t0;
+		#endif
+
+		return c;
+	};
+
+	static const __ox_clock_t &__ox_clock(void) {
+		static const __ox_clock_t c = __ox_clock_calibrate();
+		return c;
+	};
+
+	u64 Clock::ticks(void) {
+		#ifdef OX_USE_CLOCK_TSC
+			if(__ox_clock().tsc)
+				return __rdtsc();
+		#endif
+
+		return __ox_clock_os();
+	};
+
+	u64 Clock::to_ns(u64 n) {
+		const __ox_clock_t &c = __ox_clock();
+		if(!c.tsc)
+			return n;
+
+		return (u64)((double)n * c.ns_per_tick);
+	};
+
+	u64 Clock::now(void) {
+		const __ox_clock_t &c = __ox_clock();
+		if(!c.tsc)
+			return __ox_clock_os();
+
+		return to_ns(ticks() - c.origin);
+	};
+
+	bool Clock::is_tsc(void) {
+		return __ox_clock().tsc;
+	};
+
+	double Clock::ticks_per_ns(void) {
+		return __ox_clock().ticks_per_ns;
+	};
+};
@@ -16,6 +16,7 @@
 **/
 
 #include "../include/crypto/crc.hpp"
+#include "../include/core/profile.hpp"
 
 namespace Ox {
 	CRC32::CRC32(void) {
@@ -45,6 +46,8 @@ namespace Ox {
 		if(data == nullptr || length == 0)
 			return;
 
+		OX_PROFILE_ZONE("CRC32::update");
+
 		for(ulong i = 0; i < length; i++)
 			i_state = (i_state >> 8) ^ i_lookup_table[(u8)i_state ^ data[i]];
 	};
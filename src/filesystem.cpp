@@ -49,6 +49,25 @@ namespace Ox {
 			#endif
 		};
 
+		Atom abs_atom(const char *p, Error &err) {
+			if(err != nullptr)
+				return Atom();
+
+			if(p == nullptr) {
+				err = "'p' is NULL";
+				return Atom();
+			}
+
+			#ifdef OX_DISABLE_FS
+				err = "Flag OX_DISABLE_FS is set";
+				return Atom();
+			#else
+				std::filesystem::path path = std::filesystem::absolute(p);
+
+				return StringPool::global()->intern(path.c_str(), err);
+			#endif
+		};
+
 		int cp(const char *from, const char *to, bool force, Error &err) {
 			if(err != nullptr)
 				return -1;
@@ -577,6 +596,57 @@ namespace Ox {
 			#endif
 		};
 
+		Atom Directory::current_atom(Error &err) {
+			if(err != nullptr || end) {
+				return Atom();
+			}
+
+			#ifdef OX_DISABLE_FS
+				err = "Flag OX_DISABLE_FS is set";
+				return Atom();
+			#else
+				using namespace std::filesystem;
+				directory_iterator *ip = (directory_iterator *)implptr;
+		
+				if(ip == nullptr) {
+					err = "Unitialized FileSystem::Directory implementation";
+					return Atom();
+				}
+
+				const path &p = (*ip)->path();
+				return StringPool::global()->intern(p.c_str(), err);
+			#endif
+		};
+
+		Atom Directory::next_atom(Error &err) {
+			Atom a = current_atom(err);
+			if(err != nullptr || a.is_null()) {
+				return a;
+			}
+
+			#ifdef OX_DISABLE_FS
+				err = "Flag OX_DISABLE_FS is set";
+				return a;
+			#else
+				using namespace std::filesystem;
+				directory_iterator &di = *(directory_iterator *)implptr;
+
+				std::error_code ec;
+				di.increment(ec);
+
+				if(ec) {
+					end = true;
+					err.from_fmt("%s", ec.message().c_str());
+					err.from_c("Couldn't read the next directory entry");
+				}
+
+				if(di == directory_iterator{})
+					end = true;
+
+				return a;
+			#endif
+		};
+
 		Directory opendir(const char *p, Error &err) {
 			Directory dir;
 
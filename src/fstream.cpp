@@ -22,13 +22,147 @@
 #endif
 
 #ifndef OX_DISABLE_FSTREAM
-	#include <fstream>
-	#include <cerrno>
-	#include <cstring>
+	// File descriptors straight away: no locale, no sentries and no second
+	// buffer, which only pays off for large transfers. Small reads and
+	// writes want a BufferedReader/BufferedWriter on top, hence opt-in.
+	#if defined(OX_ENABLE_FSTREAM_NATIVE) && !defined(OX_OS_WINDOWS) \
+		&& ox_has_include(<fcntl.h>) && ox_has_include(<unistd.h>) && ox_has_include(<sys/stat.h>) && ox_has_include(<sys/uio.h>)
+		#define OX_USE_FSTREAM_NATIVE
+		#include <fcntl.h>
+		#include <unistd.h>
+		#include <sys/stat.h>
+		#include <sys/uio.h>
+		#include <cerrno>
+		#include <cstring>
+		#include <new>
+	#elif ox_has_include(<fstream>)
+		#define OX_USE_FSTREAM_STDCPP
+		#include <fstream>
+		#include <cerrno>
+		#include <cstring>
+	#else
+		#error "No <fstream> support"
+	#endif
 #endif
 
 namespace Ox {
-	#ifndef OX_DISABLE_FSTREAM
+	#ifdef OX_USE_FSTREAM_NATIVE
+		typedef struct __ox_fstream_native_t {
+			int fd = -1;
+			bool direct = false;
+			// Only used for pipes and the like, which can't tell their size.
+			bool eof = false;
+		} __ox_fstream_native_t;
+
+		static void __ox_fstream_error(__ox_fstream_native_t *f, Error &err) {
+			if(f->direct && errno == EINVAL) {
+				err = "O_DIRECT needs buffers, sizes and offsets aligned to FileStream::direct_alignment";
+				return;
+			}
+
+			err = std::strerror(errno);
+		};
+
+		static int __ox_fstream_whence(seekdir dir) {
+			if(dir == Ox::seekdir::cur) return SEEK_CUR;
+			if(dir == Ox::seekdir::end) return SEEK_END;
+
+			return SEEK_SET;
+		};
+
+		// Bytes left to read, or -1 when the file can't tell.
+		static long __ox_fstream_left(__ox_fstream_native_t *f) {
+			struct stat st;
+			if(fstat(f->fd, &st) != 0 || !S_ISREG(st.st_mode))
+				return -1;
+
+			off_t pos = lseek(f->fd, 0, SEEK_CUR);
+			if(pos < 0)
+				return -1;
+
+			return pos < st.st_size ? st.st_size - pos : 0;
+		};
+
+		// Slices handed to the kernel per call, well under any IOV_MAX.
+		static const ulong __ox_fstream_iov_batch = 64;
+
+		// readv/writev, or their positional versions when 'offset' >= 0.
+		// Picks up where a partial transfer stopped, so either every byte
+		// goes through or, reading, the end of the file was reached.
+		static long __ox_fstream_vector(__ox_fstream_native_t *f, const io_slice_t *slices, ulong n, long offset, bool out, Error &err) {
+			struct iovec iov[__ox_fstream_iov_batch];
+			ulong done = 0;
+			// Next slice to transfer, and how much of it already was.
+			ulong i = 0;
+			ulong skip = 0;
+
+			while(i < n) {
+				// Empty slices are left out: a batch of nothing but those
+				// would transfer 0 bytes, which reads as the end of the file.
+				while(i < n && slices[i].length == skip) {
+					skip = 0;
+					i++;
+				};
+
+				if(i == n)
+					break;
+
+				ulong k = 0;
+				for(ulong j = i; j < n && k < __ox_fstream_iov_batch; j++) {
+					ulong from = j == i ? skip : 0;
+					if(slices[j].length == from)
+						continue;
+
+					iov[k].iov_base = slices[j].data + from;
+					iov[k].iov_len = slices[j].length - from;
+					k++;
+				};
+
+				ssize_t r;
+				if(offset >= 0)
+					r = out ? pwritev(f->fd, iov, k, offset + done) : preadv(f->fd, iov, k, offset + done);
+				else
+					r = out ? ::writev(f->fd, iov, k) : ::readv(f->fd, iov, k);
+
+				if(r < 0) {
+					if(errno == EINTR)
+						continue;
+
+					__ox_fstream_error(f, err);
+					return -1;
+				}
+
+				if(r == 0) {
+					if(out) {
+						err = "Couldn't write the file";
+						return -1;
+					}
+
+					if(offset < 0)
+						f->eof = true;
+
+					break;
+				}
+
+				done += r;
+
+				for(ulong left = r; left > 0 && i < n; ) {
+					ulong rest = slices[i].length - skip;
+
+					if(left < rest) {
+						skip += left;
+						break;
+					}
+
+					left -= rest;
+					skip = 0;
+					i++;
+				};
+			};
+
+			return done;
+		};
+	#elif defined(OX_USE_FSTREAM_STDCPP)
 		std::ios::openmode __ox_impl_filestream_openmode(openmode mode) {
 			std::ios::openmode smode = std::ios::binary;
 
@@ -47,6 +181,10 @@ namespace Ox {
 	#endif
 
 	int FileStream::open(const char *path, openmode mode, Error &err) {
+		return open(path, mode, options_t(), err);
+	};
+
+	int FileStream::open(const char *path, openmode mode, options_t options, Error &err) {
 		if(err != nullptr)
 			return -1;
 
@@ -55,11 +193,78 @@ namespace Ox {
 			return -1;
 		}
 		
-		#ifdef OX_DISABLE_FSTREAM
-			(void)mode;
-			err = "Flag OX_DISABLE_FSTREAM is set";
-			return -1;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			if(is_open()) {
+				err = "File stream is already open";
+				return -1;
+			}
+
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+
+			if(f == nullptr) {
+				f = inhale<__ox_fstream_native_t>(err);
+				if(f == nullptr)
+					return -1;
+
+				new (f) __ox_fstream_native_t();
+				__ox_implptr = f;
+			}
+
+			// Same semantics as std::fstream: 'out' alone truncates or
+			// creates, 'in | out' wants an existing file.
+			int flags = O_CLOEXEC;
+			if((mode & Ox::openmode::in) && (mode & Ox::openmode::out))
+				flags |= O_RDWR;
+			else if(mode & Ox::openmode::out)
+				flags |= O_WRONLY | O_CREAT | O_TRUNC;
+			else
+				flags |= O_RDONLY;
+
+			if(options.direct) {
+				#ifdef O_DIRECT
+					flags |= O_DIRECT;
+				#elif !defined(F_NOCACHE)
+					err = "O_DIRECT isn't supported";
+					close();
+					return -1;
+				#endif
+			}
+
+			int fd;
+			do {
+				fd = ::open(path, flags, 0666);
+			} while(fd < 0 && errno == EINTR);
+
+			if(fd < 0) {
+				err = std::strerror(errno);
+				close();
+				return -1;
+			}
+
+			f->fd = fd;
+			f->direct = options.direct;
+			f->eof = false;
+
+			#if !defined(O_DIRECT) && defined(F_NOCACHE)
+				if(options.direct && fcntl(fd, F_NOCACHE, 1) != 0) {
+					err = std::strerror(errno);
+					close();
+					return -1;
+				}
+			#endif
+
+			if(options.advice != advice_normal && advise(options.advice, 0, 0, err) != 0) {
+				close();
+				return -1;
+			}
+
+			return 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
+			if(options.direct) {
+				err = "O_DIRECT needs the native FileStream backend";
+				return -1;
+			}
+
 			std::fstream *f = (std::fstream *)__ox_implptr;
 
 			if(f != nullptr && is_open()) {
@@ -87,23 +292,41 @@ namespace Ox {
 			}
 
 			return 0;
+		#else
+			(void)mode; (void)options;
+			err = "Flag OX_DISABLE_FSTREAM is set";
+			return -1;
 		#endif
 	};
 
 	bool FileStream::is_open(void) {
-		#ifdef OX_DISABLE_FSTREAM
-			return false;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			return f != nullptr && f->fd >= 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return false;
 			
 			return f->is_open();
+		#else
+			return false;
 		#endif
 	};
 
 	void FileStream::close(void) {
-		#ifndef OX_DISABLE_FSTREAM
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr)
+				return;
+
+			// Retrying after EINTR could close a descriptor reused meanwhile.
+			if(f->fd >= 0)
+				(void)::close(f->fd);
+
+			exhale(f);
+			__ox_implptr = nullptr;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return;
@@ -117,75 +340,401 @@ namespace Ox {
 		#endif
 	};
 
-	ulong FileStream::tellg(void) {
-		#ifdef OX_DISABLE_FSTREAM
+	int FileStream::native_handle(void) {
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			return f == nullptr ? -1 : f->fd;
+		#else
+			return -1;
+		#endif
+	};
+
+	long FileStream::pread(u8 *s, ulong n, ulong offset, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
+			return -1;
+		}
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			ulong done = 0;
+
+			while(done < n) {
+				ssize_t r = ::pread(f->fd, s + done, n - done, offset + done);
+
+				if(r < 0) {
+					if(errno == EINTR)
+						continue;
+
+					__ox_fstream_error(f, err);
+					return -1;
+				}
+
+				if(r == 0)
+					break;
+
+				done += r;
+			};
+
+			return done;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
+			std::fstream *f = (std::fstream *)__ox_implptr;
+
+			f->clear();
+			std::streampos pos = f->tellg();
+			f->seekg(offset);
+
+			long r = read(s, n, err);
+
+			f->clear();
+			f->seekg(pos);
+
+			return r;
+		#else
+			(void)n; (void)offset;
+			return -1;
+		#endif
+	};
+
+	int FileStream::pwrite(u8 *s, ulong n, ulong offset, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
+			return -1;
+		}
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			ulong done = 0;
+
+			while(done < n) {
+				ssize_t r = ::pwrite(f->fd, s + done, n - done, offset + done);
+
+				if(r < 0) {
+					if(errno == EINTR)
+						continue;
+
+					__ox_fstream_error(f, err);
+					return -1;
+				}
+
+				if(r == 0) {
+					err = "Couldn't write the file";
+					return -1;
+				}
+
+				done += r;
+			};
+
+			return 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
+			std::fstream *f = (std::fstream *)__ox_implptr;
+
+			f->clear();
+			std::streampos pos = f->tellp();
+			f->seekp(offset);
+
+			int r = write(s, n, err);
+
+			f->clear();
+			f->seekp(pos);
+
+			return r;
+		#else
+			(void)n; (void)offset;
+			return -1;
+		#endif
+	};
+
+	long FileStream::preadv(const io_slice_t *slices, ulong n, ulong offset, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
+			return -1;
+		}
+
+		if(slices == nullptr && n > 0) {
+			err = "'slices' is NULL";
+			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			return __ox_fstream_vector((__ox_fstream_native_t *)__ox_implptr, slices, n, offset, false, err);
+		#elif defined(OX_USE_FSTREAM_STDCPP)
+			std::fstream *f = (std::fstream *)__ox_implptr;
+
+			f->clear();
+			std::streampos pos = f->tellg();
+			f->seekg(offset);
+
+			long r = BasicIOStream::readv(slices, n, err);
+
+			f->clear();
+			f->seekg(pos);
+
+			return r;
+		#else
+			(void)offset;
+			return -1;
+		#endif
+	};
+
+	int FileStream::pwritev(const io_slice_t *slices, ulong n, ulong offset, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
+			return -1;
+		}
+
+		if(slices == nullptr && n > 0) {
+			err = "'slices' is NULL";
+			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			return __ox_fstream_vector((__ox_fstream_native_t *)__ox_implptr, slices, n, offset, true, err) < 0 ? -1 : 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
+			std::fstream *f = (std::fstream *)__ox_implptr;
+
+			f->clear();
+			std::streampos pos = f->tellp();
+			f->seekp(offset);
+
+			int r = BasicIOStream::writev(slices, n, err);
+
+			f->clear();
+			f->seekp(pos);
+
+			return r;
+		#else
+			(void)offset;
+			return -1;
+		#endif
+	};
+
+	int FileStream::advise(advice_t advice, ulong offset, ulong len, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
+			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE) && defined(POSIX_FADV_NORMAL)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+
+			int a = POSIX_FADV_NORMAL;
+			if(advice == advice_sequential) a = POSIX_FADV_SEQUENTIAL;
+			if(advice == advice_random) a = POSIX_FADV_RANDOM;
+			if(advice == advice_willneed) a = POSIX_FADV_WILLNEED;
+			if(advice == advice_dontneed) a = POSIX_FADV_DONTNEED;
+
+			// Returns the error instead of setting errno.
+			int e = posix_fadvise(f->fd, offset, len, a);
+			if(e != 0) {
+				err = std::strerror(e);
+				return -1;
+			}
+
+			return 0;
+		#else
+			(void)advice; (void)offset; (void)len;
+			return 0;
+		#endif
+	};
+
+	int FileStream::preallocate(ulong offset, ulong len, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
 			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE) && defined(OX_OS_LINUX) && defined(FALLOC_FL_KEEP_SIZE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+
+			int r;
+			do {
+				r = fallocate(f->fd, FALLOC_FL_KEEP_SIZE, offset, len);
+			} while(r != 0 && errno == EINTR);
+
+			if(r != 0) {
+				err.from_fmt("Couldn't preallocate the file: %s", std::strerror(errno));
+				err.from_c("Couldn't preallocate the file");
+				return -1;
+			}
+
+			return 0;
 		#else
+			(void)offset; (void)len;
+			err = "Preallocation isn't supported";
+			return -1;
+		#endif
+	};
+
+	int FileStream::sync(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized FileStream implementation";
+			return -1;
+		}
+
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+
+			#if defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+				int r = fdatasync(f->fd);
+			#else
+				int r = fsync(f->fd);
+			#endif
+
+			if(r != 0) {
+				err = std::strerror(errno);
+				return -1;
+			}
+
+			return 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
+			// As far as std::fstream goes: out of our buffers, into the OS's.
+			std::fstream *f = (std::fstream *)__ox_implptr;
+
+			f->flush();
+			if(f->fail()) {
+				err = "Couldn't flush the file";
+				return -1;
+			}
+
+			return 0;
+		#else
+			return -1;
+		#endif
+	};
+
+	ulong FileStream::tellg(void) {
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr)
+				return -1;
+
+			return static_cast<ulong>(lseek(f->fd, 0, SEEK_CUR));
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return -1;
 			
 			return static_cast<ulong>(f->tellg());
+		#else
+			return -1;
 		#endif
 	};
 
+	// Seeking is how a stream that hit its end gets going again.
 	void FileStream::seekg(ulong pos) {
-		#ifdef OX_DISABLE_FSTREAM
-			(void)pos;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr)
+				return;
+
+			if(lseek(f->fd, pos, SEEK_SET) >= 0)
+				f->eof = false;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return;
 
+			f->clear();
 			f->seekg(pos);
+		#else
+			(void)pos;
 		#endif
 	};
 
 	void FileStream::seekg(long off, seekdir dir) {
-		#ifdef OX_DISABLE_FSTREAM
-			(void)off; (void)dir;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr)
+				return;
+
+			if(lseek(f->fd, off, __ox_fstream_whence(dir)) >= 0)
+				f->eof = false;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return;
 
+			f->clear();
 			f->seekg(off, __ox_impl_filestream_seekdir(dir));
+		#else
+			(void)off; (void)dir;
 		#endif
 	};
 
+	// Descriptors have a single position, shared with the 'g' side.
 	ulong FileStream::tellp(void) {
-		#ifdef OX_DISABLE_FSTREAM
-			return -1;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			return tellg();
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return -1;
 			
 			return static_cast<ulong>(f->tellp());
+		#else
+			return -1;
 		#endif
 	};
 
 	void FileStream::seekp(ulong pos) {
-		#ifdef OX_DISABLE_FSTREAM
-			(void)pos;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			seekg(pos);
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return;
 
+			f->clear();
 			f->seekp(pos);
+		#else
+			(void)pos;
 		#endif
 	};
 
 	void FileStream::seekp(long off, seekdir dir) {
-		#ifdef OX_DISABLE_FSTREAM
-			(void)off; (void)dir;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			seekg(off, dir);
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr)
 				return;
 
+			f->clear();
 			f->seekp(off, __ox_impl_filestream_seekdir(dir));
+		#else
+			(void)off; (void)dir;
 		#endif
 	};
 
@@ -194,11 +743,41 @@ namespace Ox {
 			return -1;
 		}
 		
-		#ifdef OX_DISABLE_FSTREAM
-			(void)n;
-			err = "Flag OX_DISABLE_FSTREAM is set";
-			return -1;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			// Regular files just move, anything else gets read through.
+			long left = __ox_fstream_left(f);
+			if(left >= 0) {
+				ulong k = n < (ulong)left ? n : left;
+
+				if(lseek(f->fd, k, SEEK_CUR) < 0) {
+					__ox_fstream_error(f, err);
+					return -1;
+				}
+
+				return k;
+			}
+
+			u8 scratch[4096];
+			ulong done = 0;
+
+			while(done < n) {
+				long r = read(scratch, n - done < sizeof(scratch) ? n - done : sizeof(scratch), err);
+				if(r < 0)
+					return -1;
+				if(r == 0)
+					break;
+
+				done += r;
+			};
+
+			return done;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr) {
 				err = "Unitialized FileStream implementation";
@@ -216,6 +795,10 @@ namespace Ox {
 			}
 
 			return f->gcount();
+		#else
+			(void)n;
+			err = "Flag OX_DISABLE_FSTREAM is set";
+			return -1;
 		#endif
 	};
 
@@ -224,11 +807,45 @@ namespace Ox {
 			return -1;
 		}
 
-		#ifdef OX_DISABLE_FSTREAM
-			(void)n; (void)delimitator;
-			err = "Flag OX_DISABLE_FSTREAM is set";
-			return -1;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			// Reads ahead and seeks back over what followed the delimitator,
+			// a byte at a time where seeking isn't possible.
+			bool seekable = lseek(f->fd, 0, SEEK_CUR) >= 0;
+
+			u8 scratch[4096];
+			ulong chunk = seekable ? sizeof(scratch) : 1;
+			ulong done = 0;
+
+			while(done < n) {
+				long r = read(scratch, n - done < chunk ? n - done : chunk, err);
+				if(r < 0)
+					return -1;
+				if(r == 0)
+					break;
+
+				u8 *d = (u8 *)std::memchr(scratch, (u8)delimitator, r);
+				if(d != nullptr) {
+					long m = d - scratch + 1;
+
+					if(m < r && lseek(f->fd, m - r, SEEK_CUR) < 0) {
+						__ox_fstream_error(f, err);
+						return -1;
+					}
+
+					return done + m;
+				}
+
+				done += r;
+			};
+
+			return done;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr) {
 				err = "Unitialized FileStream implementation";
@@ -246,6 +863,10 @@ namespace Ox {
 			}
 
 			return f->gcount();
+		#else
+			(void)n; (void)delimitator;
+			err = "Flag OX_DISABLE_FSTREAM is set";
+			return -1;
 		#endif
 	};
 
@@ -254,11 +875,41 @@ namespace Ox {
 			return -1;
 		}
 
-		#ifdef OX_DISABLE_FSTREAM
-			(void)s; (void)n;
-			err = "Flag OX_DISABLE_FSTREAM is set";
-			return -1;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+			if(f == nullptr) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			if(s == nullptr) {
+				err = "'s' is NULL";
+				return -1;
+			}
+
+			ulong done = 0;
+
+			while(done < n) {
+				ssize_t r = ::read(f->fd, s + done, n - done);
+
+				if(r < 0) {
+					if(errno == EINTR)
+						continue;
+
+					__ox_fstream_error(f, err);
+					return -1;
+				}
+
+				if(r == 0) {
+					f->eof = true;
+					break;
+				}
+
+				done += r;
+			};
+
+			return done;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 			if(f == nullptr) {
 				err = "Unitialized FileStream implementation";
@@ -281,6 +932,10 @@ namespace Ox {
 			}
 
 			return f->gcount();
+		#else
+			(void)s; (void)n;
+			err = "Flag OX_DISABLE_FSTREAM is set";
+			return -1;
 		#endif
 	};
 
@@ -289,10 +944,20 @@ namespace Ox {
 			return -1;
 		}
 
-		#ifdef OX_DISABLE_FSTREAM
-			err = "Flag OX_DISABLE_FSTREAM is set";
-			return true;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+
+			if(f == nullptr) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			long left = __ox_fstream_left(f);
+			if(left < 0)
+				return f->eof;
+
+			return left == 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 
 			if(f == nullptr) {
@@ -302,6 +967,9 @@ namespace Ox {
 
 			(void)f->peek();
 			return f->eof();
+		#else
+			err = "Flag OX_DISABLE_FSTREAM is set";
+			return true;
 		#endif
 	};
 
@@ -310,11 +978,42 @@ namespace Ox {
 			return -1;
 		}
 
-		#ifdef OX_DISABLE_FSTREAM
-			(void)s; (void)n;
-			err = "Flag OX_DISABLE_FSTREAM is set";
-			return -1;
-		#else
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			__ox_fstream_native_t *f = (__ox_fstream_native_t *)__ox_implptr;
+
+			if(f == nullptr) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			if(s == nullptr) {
+				err = "'s' is NULL";
+				return -1;
+			}
+
+			ulong done = 0;
+
+			while(done < n) {
+				ssize_t r = ::write(f->fd, s + done, n - done);
+
+				if(r < 0) {
+					if(errno == EINTR)
+						continue;
+
+					__ox_fstream_error(f, err);
+					return -1;
+				}
+
+				if(r == 0) {
+					err = "Couldn't write the file";
+					return -1;
+				}
+
+				done += r;
+			};
+
+			return 0;
+		#elif defined(OX_USE_FSTREAM_STDCPP)
 			std::fstream *f = (std::fstream *)__ox_implptr;
 
 			if(f == nullptr) {
@@ -338,6 +1037,51 @@ namespace Ox {
 			}
 
 			return 0;
+		#else
+			(void)s; (void)n;
+			err = "Flag OX_DISABLE_FSTREAM is set";
+			return -1;
+		#endif
+	};
+	long FileStream::readv(const io_slice_t *slices, ulong n, Error &err) {
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			if(err != nullptr)
+				return -1;
+
+			if(!is_open()) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			if(slices == nullptr && n > 0) {
+				err = "'slices' is NULL";
+				return -1;
+			}
+
+			return __ox_fstream_vector((__ox_fstream_native_t *)__ox_implptr, slices, n, -1, false, err);
+		#else
+			return BasicIOStream::readv(slices, n, err);
+		#endif
+	};
+
+	int FileStream::writev(const io_slice_t *slices, ulong n, Error &err) {
+		#if defined(OX_USE_FSTREAM_NATIVE)
+			if(err != nullptr)
+				return -1;
+
+			if(!is_open()) {
+				err = "Unitialized FileStream implementation";
+				return -1;
+			}
+
+			if(slices == nullptr && n > 0) {
+				err = "'slices' is NULL";
+				return -1;
+			}
+
+			return __ox_fstream_vector((__ox_fstream_native_t *)__ox_implptr, slices, n, -1, true, err) < 0 ? -1 : 0;
+		#else
+			return BasicIOStream::writev(slices, n, err);
 		#endif
 	};
 };
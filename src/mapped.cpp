@@ -0,0 +1,372 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/io/mapped.hpp"
+#include <cstring>
+#include <cerrno>
+
+#ifdef OX_DISABLE_MMAP
+	#warning "Flag OX_DISABLE_MMAP is set"
+#endif
+
+#if !defined(OX_DISABLE_MMAP) && !defined(OX_OS_WINDOWS) \
+	&& ox_has_include(<sys/mman.h>) && ox_has_include(<sys/stat.h>) && ox_has_include(<fcntl.h>) && ox_has_include(<unistd.h>)
+	#define OX_USE_MMAP
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace Ox {
+	#ifdef OX_USE_MMAP
+		static int __ox_mapped_advice(MappedFileStream::advice_t advice) {
+			switch(advice) {
+				case MappedFileStream::advice_sequential: return MADV_SEQUENTIAL;
+				case MappedFileStream::advice_random: return MADV_RANDOM;
+				case MappedFileStream::advice_willneed: return MADV_WILLNEED;
+				default: return MADV_NORMAL;
+			};
+		};
+	#endif
+
+	int MappedFileStream::map(Error &err) {
+		#ifdef OX_USE_MMAP
+			struct stat st;
+			if(fstat(fd, &st) != 0) {
+				err.from_fmt("Couldn't stat the file: %s", std::strerror(errno));
+				err.from_c("Couldn't stat the file");
+				return -1;
+			}
+
+			length = st.st_size;
+			if(length == 0)
+				return 0;
+
+			int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+			void *p = mmap(nullptr, length, prot, MAP_SHARED, fd, 0);
+
+			if(p == MAP_FAILED) {
+				length = 0;
+				err.from_fmt("Couldn't map the file: %s", std::strerror(errno));
+				err.from_c("Couldn't map the file");
+				return -1;
+			}
+
+			data = (u8 *)p;
+
+			// Hints, failing them is harmless.
+			(void)madvise(data, length, __ox_mapped_advice(options.advice));
+
+			#ifdef MADV_HUGEPAGE
+				if(options.huge_pages)
+					(void)madvise(data, length, MADV_HUGEPAGE);
+			#endif
+
+			return 0;
+		#else
+			err = "Memory-mapped files aren't supported";
+			return -1;
+		#endif
+	};
+
+	void MappedFileStream::unmap(void) {
+		#ifdef OX_USE_MMAP
+			if(data != nullptr)
+				munmap(data, length);
+		#endif
+
+		data = nullptr;
+		length = 0;
+	};
+
+	int MappedFileStream::open(const char *path, openmode mode, Error &err) {
+		return open(path, mode, options_t(), err);
+	};
+
+	int MappedFileStream::open(const char *path, openmode mode, options_t options, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(path == nullptr) {
+			err = "'path' is NULL";
+			return -1;
+		}
+
+		if(is_open()) {
+			err = "File stream is already open";
+			return -1;
+		}
+
+		#ifdef OX_USE_MMAP
+			writable = (mode & Ox::openmode::out) != 0;
+			this->options = options;
+
+			// Writable mappings need the file open for reading too.
+			fd = writable
+				? ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666)
+				: ::open(path, O_RDONLY | O_CLOEXEC);
+
+			if(fd < 0) {
+				err = std::strerror(errno);
+				return -1;
+			}
+
+			if(map(err) != 0) {
+				close();
+				return -1;
+			}
+
+			gpos = ppos = 0;
+			return 0;
+		#else
+			(void)mode; (void)options;
+			err = "Flag OX_DISABLE_MMAP is set";
+			return -1;
+		#endif
+	};
+
+	bool MappedFileStream::is_open(void) {
+		return fd >= 0;
+	};
+
+	void MappedFileStream::close(void) {
+		unmap();
+
+		#ifdef OX_USE_MMAP
+			if(fd >= 0)
+				::close(fd);
+		#endif
+
+		fd = -1;
+		writable = false;
+		gpos = ppos = 0;
+	};
+
+	int MappedFileStream::advise(advice_t advice, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		options.advice = advice;
+
+		#ifdef OX_USE_MMAP
+			if(data != nullptr && madvise(data, length, __ox_mapped_advice(advice)) != 0) {
+				err = std::strerror(errno);
+				return -1;
+			}
+		#endif
+
+		return 0;
+	};
+
+	int MappedFileStream::resize(ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized MappedFileStream";
+			return -1;
+		}
+
+		if(!writable) {
+			err = "MappedFileStream isn't writable";
+			return -1;
+		}
+
+		#ifdef OX_USE_MMAP
+			unmap();
+
+			if(ftruncate(fd, n) != 0) {
+				err.from_fmt("Couldn't resize the file: %s", std::strerror(errno));
+				err.from_c("Couldn't resize the file");
+				(void)map(err);
+				return -1;
+			}
+
+			if(map(err) != 0)
+				return -1;
+
+			if(gpos > length) gpos = length;
+			if(ppos > length) ppos = length;
+
+			return 0;
+		#else
+			(void)n;
+			err = "Flag OX_DISABLE_MMAP is set";
+			return -1;
+		#endif
+	};
+
+	int MappedFileStream::sync(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		#ifdef OX_USE_MMAP
+			if(data != nullptr && writable && msync(data, length, MS_SYNC) != 0) {
+				err = std::strerror(errno);
+				return -1;
+			}
+		#endif
+
+		return 0;
+	};
+
+	Span<u8> MappedFileStream::view(ulong offset, ulong len, Error &err) {
+		if(err != nullptr)
+			return Span<u8>();
+
+		if(offset > length || len > length - offset) {
+			err = "Out of bonds";
+			return Span<u8>();
+		}
+
+		return Span<u8>(data + offset, len);
+	};
+
+	static ulong __ox_mapped_seek(ulong from, ulong length, long off, seekdir dir) {
+		long base = 0;
+		if(dir == Ox::seekdir::cur) base = from;
+		if(dir == Ox::seekdir::end) base = length;
+
+		long pos = base + off;
+		if(pos < 0)
+			return 0;
+
+		return (ulong)pos > length ? length : pos;
+	};
+
+	ulong MappedFileStream::tellg(void) {
+		return gpos;
+	};
+
+	void MappedFileStream::seekg(ulong pos) {
+		gpos = pos > length ? length : pos;
+	};
+
+	void MappedFileStream::seekg(long off, seekdir dir) {
+		gpos = __ox_mapped_seek(gpos, length, off, dir);
+	};
+
+	ulong MappedFileStream::tellp(void) {
+		return ppos;
+	};
+
+	void MappedFileStream::seekp(ulong pos) {
+		ppos = pos > length ? length : pos;
+	};
+
+	void MappedFileStream::seekp(long off, seekdir dir) {
+		ppos = __ox_mapped_seek(ppos, length, off, dir);
+	};
+
+	long MappedFileStream::ignore(ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(n > length - gpos)
+			n = length - gpos;
+
+		gpos += n;
+		return n;
+	};
+
+	long MappedFileStream::ignore(ulong n, char delimitator, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(n > length - gpos)
+			n = length - gpos;
+		if(n == 0)
+			return 0;
+
+		// The delimitator is consumed, like std::istream::ignore does.
+		u8 *d = (u8 *)std::memchr(data + gpos, (u8)delimitator, n);
+		if(d != nullptr)
+			n = d - (data + gpos) + 1;
+
+		gpos += n;
+		return n;
+	};
+
+	long MappedFileStream::read(u8 *s, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized MappedFileStream";
+			return -1;
+		}
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		if(n > length - gpos)
+			n = length - gpos;
+		if(n == 0)
+			return 0;
+
+		std::memcpy(s, data + gpos, n);
+		gpos += n;
+
+		return n;
+	};
+
+	bool MappedFileStream::eof(Error &err) {
+		if(err != nullptr)
+			return true;
+
+		if(!is_open()) {
+			err = "Unitialized MappedFileStream";
+			return true;
+		}
+
+		return gpos >= length;
+	};
+
+	int MappedFileStream::write(u8 *s, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(!is_open()) {
+			err = "Unitialized MappedFileStream";
+			return -1;
+		}
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		if(!writable) {
+			err = "MappedFileStream isn't writable";
+			return -1;
+		}
+
+		if(n > length - ppos) {
+			err = "Can't write past the end of a mapped file, resize it first";
+			return -1;
+		}
+
+		if(n > 0)
+			std::memmove(data + ppos, s, n);
+
+		ppos += n;
+		return 0;
+	};
+};
@@ -0,0 +1,232 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/io/memstream.hpp"
+#include <cstring>
+
+namespace Ox {
+	int MemoryStream::open(u8 *data, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(data == nullptr && n > 0) {
+			err = "'data' is NULL";
+			return -1;
+		}
+
+		close();
+
+		elastic = nullptr;
+		fixed = data;
+		fixed_size = n;
+
+		return 0;
+	};
+
+	int MemoryStream::open(const u8 *data, ulong n, Error &err) {
+		if(open((u8 *)data, n, err) != 0)
+			return -1;
+
+		read_only = true;
+		return 0;
+	};
+
+	int MemoryStream::open(Elastic<u8> &bytes, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		close();
+		elastic = &bytes;
+
+		return 0;
+	};
+
+	void MemoryStream::close(void) {
+		storage.clear();
+		elastic = &storage;
+		fixed = nullptr;
+		fixed_size = 0;
+		read_only = false;
+		gpos = ppos = 0;
+	};
+
+	Span<u8> MemoryStream::view(ulong offset, ulong len, Error &err) {
+		if(err != nullptr)
+			return Span<u8>();
+
+		if(offset > size() || len > size() - offset) {
+			err = "Out of bonds";
+			return Span<u8>();
+		}
+
+		return Span<u8>(bytes() + offset, len);
+	};
+
+	// Clamped to the bytes there are.
+	ulong MemoryStream::seek(ulong from, long off, seekdir dir) {
+		long base = 0;
+		if(dir == Ox::seekdir::cur) base = from;
+		if(dir == Ox::seekdir::end) base = size();
+
+		long pos = base + off;
+		if(pos < 0)
+			return 0;
+
+		return (ulong)pos > size() ? size() : pos;
+	};
+
+	ulong MemoryStream::tellg(void) {
+		return gpos;
+	};
+
+	void MemoryStream::seekg(ulong pos) {
+		gpos = pos > size() ? size() : pos;
+	};
+
+	void MemoryStream::seekg(long off, seekdir dir) {
+		gpos = seek(gpos, off, dir);
+	};
+
+	ulong MemoryStream::tellp(void) {
+		return ppos;
+	};
+
+	void MemoryStream::seekp(ulong pos) {
+		ppos = pos > size() ? size() : pos;
+	};
+
+	void MemoryStream::seekp(long off, seekdir dir) {
+		ppos = seek(ppos, off, dir);
+	};
+
+	long MemoryStream::ignore(ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		// A caller's Elastic may have shrunk behind our back.
+		if(gpos > size())
+			gpos = size();
+
+		if(n > size() - gpos)
+			n = size() - gpos;
+
+		gpos += n;
+		return n;
+	};
+
+	long MemoryStream::ignore(ulong n, char delimitator, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(gpos > size())
+			gpos = size();
+
+		if(n > size() - gpos)
+			n = size() - gpos;
+		if(n == 0)
+			return 0;
+
+		// The delimitator is consumed, like std::istream::ignore does.
+		u8 *d = (u8 *)std::memchr(bytes() + gpos, (u8)delimitator, n);
+		if(d != nullptr)
+			n = d - (bytes() + gpos) + 1;
+
+		gpos += n;
+		return n;
+	};
+
+	long MemoryStream::read(u8 *s, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		if(gpos > size())
+			gpos = size();
+
+		if(n > size() - gpos)
+			n = size() - gpos;
+		if(n == 0)
+			return 0;
+
+		std::memcpy(s, bytes() + gpos, n);
+		gpos += n;
+
+		return n;
+	};
+
+	bool MemoryStream::eof(Error &err) {
+		if(err != nullptr)
+			return true;
+
+		return gpos >= size();
+	};
+
+	int MemoryStream::write(u8 *s, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
+		}
+
+		if(read_only) {
+			err = "MemoryStream is read-only";
+			return -1;
+		}
+
+		if(ppos > size())
+			ppos = size();
+
+		if(elastic == nullptr) {
+			if(n > fixed_size - ppos) {
+				err = "Not enough room in the buffer";
+				return -1;
+			}
+
+			if(n > 0)
+				std::memmove(fixed + ppos, s, n);
+			ppos += n;
+
+			return 0;
+		}
+
+		ulong overwritten = n < size() - ppos ? n : size() - ppos;
+
+		// 's' may point into the Elastic, which 'append' can move.
+		u8 *base = bytes();
+		bool inside = base != nullptr && s >= base && s < base + size();
+		ulong off = inside ? s - base : 0;
+
+		if(elastic->append(s + overwritten, n - overwritten, err) < 0)
+			return -1;
+
+		if(inside)
+			s = bytes() + off;
+
+		if(overwritten > 0)
+			std::memmove(bytes() + ppos, s, overwritten);
+
+		ppos += n;
+
+		return 0;
+	};
+};
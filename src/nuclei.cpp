@@ -16,6 +16,8 @@
 **/
 
 #include "../include/nuclei.hpp"
+#include "../include/core/allocator.hpp"
+#include "../include/core/stats.hpp"
 #include <cstdio>
 #include <cstdarg>
 
@@ -28,6 +30,11 @@
 #endif
 
 namespace Ox {
+	uint __ox_next_shard(void) {
+		static Atomic<uint> next { 0 };
+		return next.fetch_add(1, order_relaxed);
+	};
+
 	void __ox_assert__(const char *file, int line, const char *fn, const char *comment) {
 		// Always print to terminal.
 		if(comment == nullptr) {
@@ -94,17 +101,40 @@ namespace Ox {
 		std::exit(1);
 	};
 
-	void *__ox_alloc(ulong n, const char **err) {
+	// Every block starts with this header, so 'exhale' and 'respire' can find
+	// the allocator a block came from whatever the current one is.
+	typedef struct alignas(16) __ox_block_t {
+		Allocator *owner;
+		ulong size;
+	} __ox_block_t;
+
+	inline void *__ox_alloc_block(ulong n, bool zero, const char **err) {
 		if(err == nullptr)
 			return nullptr;
 		if(*err != nullptr)
 			return nullptr;
 		
-		void *p = std::calloc(n, 1);
-		if(p == nullptr)
-			*err = "Couldn't allocate enough memory";
+		Allocator *a = current_allocator();
+		__ox_block_t *b = (__ox_block_t *)a->alloc(sizeof(__ox_block_t) + n, zero, err);
+		if(b == nullptr)
+			return nullptr;
+
+		b->owner = a;
+		b->size = sizeof(__ox_block_t) + n;
+
+		#ifdef OX_ALLOC_STATS
+			Stats::__alloc_hook(n);
+		#endif
 		
-		return p;
+		return b + 1;
+	};
+
+	void *__ox_alloc(ulong n, const char **err) {
+		return __ox_alloc_block(n, true, err);
+	};
+
+	void *__ox_alloc_raw(ulong n, const char **err) {
+		return __ox_alloc_block(n, false, err);
 	};
 	
 	void *__ox_realloc(void *src, ulong n, const char **err) {
@@ -112,26 +142,51 @@ namespace Ox {
 			return nullptr;
 		if(*err != nullptr)
 			return nullptr;
+
+		if(src == nullptr)
+			return __ox_alloc(n, err);
 		
-		void *p = std::realloc(src, n);
-		if(p == nullptr)
-			*err = "Couldn't allocate enough memory";
+		__ox_block_t *b = (__ox_block_t *)src - 1;
+		Allocator *a = b->owner;
+
+		#ifdef OX_ALLOC_STATS
+			__ox_block_t *old = b;
+			ulong old_n = b->size - sizeof(__ox_block_t);
+		#endif
+
+		b = (__ox_block_t *)a->realloc(b, b->size, sizeof(__ox_block_t) + n, err);
+		if(b == nullptr)
+			return nullptr;
+
+		b->size = sizeof(__ox_block_t) + n;
+
+		#ifdef OX_ALLOC_STATS
+			Stats::__realloc_hook(old_n, n, b != old);
+		#endif
 		
-		return p;
+		return b + 1;
 	};
 
 	void exhale(void *p) {
 		if(p == nullptr)
 			return;
 		
-		std::free(p);
+		__ox_block_t *b = (__ox_block_t *)p - 1;
+
+		#ifdef OX_ALLOC_STATS
+			Stats::__free_hook(b->size - sizeof(__ox_block_t));
+		#endif
+
+		b->owner->free(b, b->size);
 	};
 
 	void Error::clear(void) {
-		if(src != nullptr)
+		// Only formatted messages are ours, constants are left alone.
+		if(src != nullptr && var)
 			exhale((void *)src);
 
 		src = nullptr;
+		var = false;
 	};
 
 	int Error::from_fmt(const char *format, ...) {
@@ -149,7 +204,10 @@ namespace Ox {
 		ulong len = std::vsnprintf(nullptr, 0, format, args);
 		va_end(args);
 
-		char *buff = (char *)__ox_alloc(sizeof(char) * (len + 1), &src);
+		// Errors are read after the failing scope is gone: an Arena in use
+		// there may well be reset or destroyed by then.
+		ScopedAllocator heap(*HeapAllocator::instance());
+		char *buff = (char *)__ox_alloc_raw(sizeof(char) * (len + 1), &src);
 
 		if(buff == nullptr) {
 			var = false;
@@ -160,7 +218,7 @@ namespace Ox {
 		src = (const char *)buff;
 
 		va_start(args, format);
-		(void)std::vsnprintf(buff, len, format, args);
+		(void)std::vsnprintf(buff, len + 1, format, args);
 		va_end(args);
 
 		return 0;
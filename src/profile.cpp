@@ -0,0 +1,218 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/profile.hpp"
+#include "../include/core/allocator.hpp"
+#include "../include/core/stats.hpp"
+#include "../include/io/stream.hpp"
+#include <atomic>
+#include <cstdio>
+#include <new>
+
+namespace Ox {
+	namespace Profile {
+		static const uint __ox_profile_chunk_zones = 1024;
+
+		// Only the owning thread writes; a reader sees 'count' zones, each
+		// published by the release store that bumped it.
+		typedef struct __ox_profile_chunk_t {
+			std::atomic<__ox_profile_chunk_t *> next { nullptr };
+			std::atomic<uint> count { 0 };
+			zone_t zones[__ox_profile_chunk_zones];
+		} __ox_profile_chunk_t;
+
+		// Buffers are never freed: once a thread ends, the next thread to
+		// record a zone takes its buffer over, zones included.
+		typedef struct __ox_profile_buffer_t {
+			__ox_profile_buffer_t *next = nullptr;
+			uint tid = 0;
+			std::atomic<bool> owned { true };
+			__ox_profile_chunk_t first;
+			__ox_profile_chunk_t *tail = &first;
+		} __ox_profile_buffer_t;
+
+		static std::atomic<__ox_profile_buffer_t *> __ox_profile_buffers { nullptr };
+		static std::atomic<uint> __ox_profile_tids { 0 };
+
+		typedef struct __ox_profile_slot_t {
+			__ox_profile_buffer_t *buffer = nullptr;
+
+			~__ox_profile_slot_t(void) {
+				if(buffer != nullptr)
+					buffer->owned.store(false, std::memory_order_release);
+			};
+		} __ox_profile_slot_t;
+
+		static thread_local __ox_profile_slot_t __ox_profile_slot;
+
+		template<typename T>
+		static T *__ox_profile_make(void) {
+			// Buffers outlive whatever allocator the zone was opened under.
+			ScopedAllocator heap(*HeapAllocator::instance());
+			OX_ALLOC_TAG("profile");
+
+			Error err;
+			T *p = inhale_raw<T>(1, err);
+			if(p == nullptr)
+				return nullptr;
+
+			return new (p) T();
+		}
+
+		static __ox_profile_buffer_t *__ox_profile_claim(void) {
+			__ox_profile_buffer_t *head = __ox_profile_buffers.load(std::memory_order_acquire);
+
+			for(__ox_profile_buffer_t *b = head; b != nullptr; b = b->next) {
+				bool expected = false;
+				if(b->owned.load(std::memory_order_relaxed) == false
+					&& b->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)
+				)
+					return b;
+			};
+
+			__ox_profile_buffer_t *b = __ox_profile_make<__ox_profile_buffer_t>();
+			if(b == nullptr)
+				return nullptr;
+
+			b->tid = __ox_profile_tids.fetch_add(1, std::memory_order_relaxed) + 1;
+
+			do {
+				b->next = head;
+			} while(!__ox_profile_buffers.compare_exchange_weak(head, b,
+				std::memory_order_release, std::memory_order_acquire));
+
+			return b;
+		};
+
+		void __record(const char *name, u64 begin, u64 end) {
+			__ox_profile_slot_t &slot = __ox_profile_slot;
+
+			if(slot.buffer == nullptr) {
+				slot.buffer = __ox_profile_claim();
+				if(slot.buffer == nullptr)
+					return;
+			}
+
+			__ox_profile_chunk_t *c = slot.buffer->tail;
+			uint n = c->count.load(std::memory_order_relaxed);
+
+			if(n == __ox_profile_chunk_zones) {
+				__ox_profile_chunk_t *next = __ox_profile_make<__ox_profile_chunk_t>();
+				if(next == nullptr)
+					return;
+
+				c->next.store(next, std::memory_order_release);
+				slot.buffer->tail = next;
+				c = next;
+				n = 0;
+			}
+
+			c->zones[n] = zone_t { name, begin, end };
+			c->count.store(n + 1, std::memory_order_release);
+		};
+
+		u64 count(void) {
+			u64 n = 0;
+
+			for(__ox_profile_buffer_t *b = __ox_profile_buffers.load(std::memory_order_acquire); b != nullptr; b = b->next)
+				for(__ox_profile_chunk_t *c = &b->first; c != nullptr; c = c->next.load(std::memory_order_acquire))
+					n += c->count.load(std::memory_order_acquire);
+
+			return n;
+		};
+
+		void clear(void) {
+			for(__ox_profile_buffer_t *b = __ox_profile_buffers.load(std::memory_order_acquire); b != nullptr; b = b->next) {
+				__ox_profile_chunk_t *c = b->first.next.load(std::memory_order_acquire);
+
+				while(c != nullptr) {
+					__ox_profile_chunk_t *next = c->next.load(std::memory_order_relaxed);
+					c->~__ox_profile_chunk_t();
+					exhale(c);
+					c = next;
+				};
+
+				b->first.next.store(nullptr, std::memory_order_relaxed);
+				b->first.count.store(0, std::memory_order_release);
+				b->tail = &b->first;
+			};
+		};
+
+		static int __ox_profile_write_name(BasicIOStream &os, const char *name, Error &err) {
+			// Names are literals, only quotes and backslashes need escaping.
+			for(const char *c = name; *c != '\0'; c++) {
+				if((*c == '"' || *c == '\\') && os.write((u8 *)"\\", 1, err) != 0)
+					return -1;
+				if(os.write((u8 *)c, 1, err) != 0)
+					return -1;
+			};
+
+			return 0;
+		};
+
+		int dump_json(BasicIOStream &os, Error &err) {
+			if(err != nullptr)
+				return -1;
+
+			__ox_profile_buffer_t *head = __ox_profile_buffers.load(std::memory_order_acquire);
+
+			u64 origin = ~(u64)0;
+			for(__ox_profile_buffer_t *b = head; b != nullptr; b = b->next)
+				for(__ox_profile_chunk_t *c = &b->first; c != nullptr; c = c->next.load(std::memory_order_acquire)) {
+					uint n = c->count.load(std::memory_order_acquire);
+					for(uint i = 0; i < n; i++)
+						if(c->zones[i].begin < origin)
+							origin = c->zones[i].begin;
+				};
+
+			if(os.write((u8 *)"{\"traceEvents\":[", 16, err) != 0)
+				return -1;
+
+			char buffer[160];
+			bool first = true;
+
+			for(__ox_profile_buffer_t *b = head; b != nullptr; b = b->next)
+				for(__ox_profile_chunk_t *c = &b->first; c != nullptr; c = c->next.load(std::memory_order_acquire)) {
+					uint n = c->count.load(std::memory_order_acquire);
+
+					for(uint i = 0; i < n; i++) {
+						zone_t &z = c->zones[i];
+						// Zones closed since the first pass may have opened before 'origin'.
+						u64 begin = z.begin < origin ? origin : z.begin;
+
+						if(os.write((u8 *)(first ? "{\"name\":\"" : ",{\"name\":\""), first ? 9 : 10, err) != 0)
+							return -1;
+						if(__ox_profile_write_name(os, z.name, err) != 0)
+							return -1;
+
+						int len = std::snprintf(buffer, sizeof(buffer),
+							"\",\"cat\":\"ox\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+							b->tid,
+							Clock::to_ns(begin - origin) / 1000.0,
+							Clock::to_ns(z.end - begin) / 1000.0);
+
+						if(os.write((u8 *)buffer, len, err) != 0)
+							return -1;
+
+						first = false;
+					};
+				};
+
+			return os.write((u8 *)"]}", 2, err);
+		};
+	};
+};
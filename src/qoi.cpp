@@ -16,6 +16,8 @@
 **/
 
 #include "../include/formats/qoi.hpp"
+#include "../include/core/stats.hpp"
+#include "../include/core/profile.hpp"
 
 namespace Ox {
 	namespace Media {
@@ -33,6 +35,9 @@ namespace Ox {
 			if(err != nullptr)
 				return params;
 
+			OX_ALLOC_TAG("qoi");
+			OX_PROFILE_ZONE("QOI::decode");
+
 			char magic[4];
 			if(rs.read((Ox::u8 *)magic, 4, err) != 4)
 				return params;
@@ -73,7 +78,8 @@ namespace Ox {
 			}
 
 			Ox::ulong fb_len = width * height;
-			Ox::rgba32p_t *fb = Ox::inhale<Ox::rgba32p_t>(fb_len, err);
+			// Every pixel is written below, no need to zero-fill.
+			Ox::rgba32p_t *fb = Ox::inhale_raw<Ox::rgba32p_t>(fb_len, err);
 
 			if(fb == nullptr)
 				return params;
@@ -95,6 +101,10 @@ namespace Ox {
 					if(rs.eof(err) && allow_partial) {
 						params.progress = px_i;
 						is_partial = true;
+
+						for(; px_i < fb_len; px_i++, pixels++)
+							*pixels = rgba32p_t { 0x00, 0x00, 0x00, 0x00 };
+
 						break;
 					}
 
@@ -154,8 +164,7 @@ namespace Ox {
 				pixels->g = curr_px.g;
 				pixels->b = curr_px.b;
 
-				if(channels == 4)
-					pixels->a = curr_px.a;
+				pixels->a = channels == 4 ? curr_px.a : 0x00;
 			};
 
 			if(err == nullptr && is_partial && allow_partial == false)
@@ -182,6 +191,8 @@ namespace Ox {
 			if(err != nullptr)
 				return -1;
 
+			OX_PROFILE_ZONE("QOI::encode");
+
 			if(params.width == 0 || params.height == 0) {
 				err = "Invalid resolution";
 				return -1;
@@ -0,0 +1,322 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/string.hpp"
+#include <cstring>
+
+#ifdef OX_DISABLE_SIMD
+	#warning "Flag OX_DISABLE_SIMD is set"
+#endif
+
+#ifndef OX_DISABLE_SIMD
+	#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__)) && ox_has_include(<immintrin.h>)
+		#define OX_USE_SIMD_X86
+		#include <immintrin.h>
+	#endif
+#endif
+
+#ifdef OX_USE_SIMD_X86
+	#define OX_SIMD_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Tails of the AVX2 paths reuse the narrower helpers; inlining them keeps
+// everything VEX-encoded and avoids the AVX/SSE transition penalty.
+#if defined(__GNUC__) || defined(__clang__)
+	#define OX_SIMD_INLINE inline __attribute__((always_inline))
+#else
+	#define OX_SIMD_INLINE inline
+#endif
+
+namespace Ox {
+	#ifdef OX_USE_SIMD_X86
+		// Number of leading ASCII bytes, in whole 16-byte blocks.
+		static OX_SIMD_INLINE ulong __ascii_prefix_sse2(const u8 *s, ulong n) {
+			ulong i = 0;
+
+			for(; i + 16 <= n; i += 16) {
+				__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+				if(_mm_movemask_epi8(v) != 0)
+					break;
+			};
+
+			return i;
+		};
+
+		OX_SIMD_AVX2 static ulong __ascii_prefix_avx2(const u8 *s, ulong n) {
+			ulong i = 0;
+
+			for(; i + 32 <= n; i += 32) {
+				__m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+				if(_mm256_movemask_epi8(v) != 0)
+					break;
+			};
+
+			return i + __ascii_prefix_sse2(s + i, n - i);
+		};
+	#endif
+
+	static ulong __ascii_prefix_scalar(const u8 *s, ulong n) {
+		(void)s; (void)n;
+		return 0;
+	};
+
+	typedef struct __simd_table_t {
+		const char *name;
+		ulong (*ascii_prefix)(const u8 *s, ulong n);
+	} __simd_table_t;
+
+	static __simd_table_t __simd_resolve(void) {
+		__simd_table_t t { "scalar", __ascii_prefix_scalar };
+
+		#ifdef OX_USE_SIMD_X86
+			t = __simd_table_t { "sse2", __ascii_prefix_sse2 };
+
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx2"))
+				t = __simd_table_t { "avx2", __ascii_prefix_avx2 };
+		#endif
+
+		return t;
+	};
+
+	// Resolved on first use, so it is safe to call from static initialisers.
+	static const __simd_table_t &__simd(void) {
+		static const __simd_table_t t = __simd_resolve();
+		return t;
+	};
+
+	const char *simd_backend(void) {
+		return __simd().name;
+	};
+
+	// The C library already picks a vectorised search and compare for the
+	// CPU at load time, and beats a hand-rolled loop from a few dozen bytes
+	// up: these only add the NULL and zero-length handling.
+	ulong strlen(const char *str) {
+		if(str == nullptr)
+			return 0;
+
+		return std::strlen(str);
+	};
+
+	const char *memchr(const char *s, char c, ulong n) {
+		if(s == nullptr || n == 0)
+			return nullptr;
+
+		return (const char *)std::memchr(s, c, n);
+	};
+
+	bool memeq(const void *a, const void *b, ulong n) {
+		if(a == b || n == 0)
+			return true;
+
+		return std::memcmp(a, b, n) == 0;
+	};
+
+	int memcmp(const void *a, const void *b, ulong n) {
+		if(a == b || n == 0)
+			return 0;
+
+		int r = std::memcmp(a, b, n);
+		return r < 0 ? -1 : (r > 0 ? 1 : 0);
+	};
+
+	bool is_utf8(const char *str, ulong n) {
+		const u8 *s = (const u8 *)str;
+		ulong i = 0;
+
+		while(i < n) {
+			i += __simd().ascii_prefix(s + i, n - i);
+			if(i >= n)
+				break;
+
+			u8 c = s[i];
+			if(c < 0x80) {
+				i++;
+				continue;
+			}
+
+			ulong len;
+			u32 cp;
+
+			if((c & 0xe0) == 0xc0) { len = 2; cp = c & 0x1f; }
+			else if((c & 0xf0) == 0xe0) { len = 3; cp = c & 0x0f; }
+			else if((c & 0xf8) == 0xf0) { len = 4; cp = c & 0x07; }
+			else return false;
+
+			if(i + len > n)
+				return false;
+
+			for(ulong j = 1; j < len; j++) {
+				if((s[i + j] & 0xc0) != 0x80)
+					return false;
+
+				cp = (cp << 6) | (s[i + j] & 0x3f);
+			};
+
+			// Overlong forms, surrogates and anything past U+10FFFF.
+			if((len == 2 && cp < 0x80) || (len == 3 && cp < 0x800) || (len == 4 && cp < 0x10000))
+				return false;
+			if((cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff)
+				return false;
+
+			i += len;
+		};
+
+		return true;
+	};
+
+	// Reads one codepoint from UTF-16 (2-byte wchar_t) or UTF-32 (4-byte
+	// wchar_t); broken surrogate pairs come out as U+FFFD.
+	static u32 __wide_next(const wchar_t *s, ulong n, ulong &i) {
+		u32 c = (u32)s[i++];
+
+		if(sizeof(wchar_t) == 2) {
+			c &= 0xffff;
+
+			if(c >= 0xd800 && c <= 0xdbff) {
+				if(i < n) {
+					u32 lo = (u32)s[i] & 0xffff;
+					if(lo >= 0xdc00 && lo <= 0xdfff) {
+						i++;
+						return 0x10000 + ((c - 0xd800) << 10) + (lo - 0xdc00);
+					}
+				}
+
+				return 0xfffd;
+			}
+		}
+
+		if((c >= 0xd800 && c <= 0xdfff) || c > 0x10ffff)
+			return 0xfffd;
+
+		return c;
+	};
+
+	static ulong __utf8_width(u32 cp) {
+		if(cp < 0x80) return 1;
+		if(cp < 0x800) return 2;
+		if(cp < 0x10000) return 3;
+		return 4;
+	};
+
+	#ifdef OX_USE_SIMD_X86
+		// Copies the leading run of ASCII code units, 16 bytes of input at a
+		// time; returns how many units were converted.
+		static ulong __wide_ascii_sse2(const wchar_t *s, ulong n, char *dst) {
+			ulong i = 0;
+
+			if(sizeof(wchar_t) == 2) {
+				const __m128i high = _mm_set1_epi16((short)0xff80);
+				const __m128i zero = _mm_setzero_si128();
+
+				for(; i + 8 <= n; i += 8) {
+					__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+					if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)) != 0xffff)
+						break;
+
+					if(dst != nullptr)
+						_mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(v, v));
+				};
+			} else {
+				const __m128i high = _mm_set1_epi32((int)0xffffff80);
+				const __m128i zero = _mm_setzero_si128();
+
+				for(; i + 4 <= n; i += 4) {
+					__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+					if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(v, high), zero)) != 0xffff)
+						break;
+
+					if(dst != nullptr) {
+						__m128i b = _mm_packus_epi16(_mm_packs_epi32(v, v), zero);
+						int w = _mm_cvtsi128_si32(b);
+						std::memcpy(dst + i, &w, 4);
+					}
+				};
+			}
+
+			return i;
+		};
+	#endif
+
+	static ulong __wide_ascii(const wchar_t *s, ulong n, char *dst) {
+		#ifdef OX_USE_SIMD_X86
+			return __wide_ascii_sse2(s, n, dst);
+		#else
+			(void)s; (void)n; (void)dst;
+			return 0;
+		#endif
+	};
+
+	ulong utf8_length(const wchar_t *s, ulong n) {
+		ulong len = 0;
+		ulong i = 0;
+
+		if(n > 0 && (u32)s[0] == 0xfeff)
+			i++;
+
+		while(i < n) {
+			ulong ascii = __wide_ascii(s + i, n - i, nullptr);
+			len += ascii;
+			i += ascii;
+
+			if(i >= n)
+				break;
+
+			len += __utf8_width(__wide_next(s, n, i));
+		};
+
+		return len;
+	};
+
+	ulong utf8_from_wide(const wchar_t *s, ulong n, char *dst) {
+		ulong len = 0;
+		ulong i = 0;
+
+		if(n > 0 && (u32)s[0] == 0xfeff)
+			i++;
+
+		while(i < n) {
+			ulong ascii = __wide_ascii(s + i, n - i, dst + len);
+			len += ascii;
+			i += ascii;
+
+			if(i >= n)
+				break;
+
+			u32 cp = __wide_next(s, n, i);
+
+			if(cp < 0x80) {
+				dst[len++] = (char)cp;
+			} else if(cp < 0x800) {
+				dst[len++] = (char)(0xc0 | (cp >> 6));
+				dst[len++] = (char)(0x80 | (cp & 0x3f));
+			} else if(cp < 0x10000) {
+				dst[len++] = (char)(0xe0 | (cp >> 12));
+				dst[len++] = (char)(0x80 | ((cp >> 6) & 0x3f));
+				dst[len++] = (char)(0x80 | (cp & 0x3f));
+			} else {
+				dst[len++] = (char)(0xf0 | (cp >> 18));
+				dst[len++] = (char)(0x80 | ((cp >> 12) & 0x3f));
+				dst[len++] = (char)(0x80 | ((cp >> 6) & 0x3f));
+				dst[len++] = (char)(0x80 | (cp & 0x3f));
+			}
+		};
+
+		return len;
+	};
+};
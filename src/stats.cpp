@@ -0,0 +1,230 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/stats.hpp"
+#include "../include/io/stream.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace Ox {
+	namespace Stats {
+		static const uint __tag_untagged = 0;
+		static const uint __tag_other = max_alloc_tags - 1;
+
+		// Exact, the peak is tracked against it.
+		static std::atomic<u64> __live_bytes { 0 };
+		static std::atomic<u64> __peak_bytes { 0 };
+		// Every allocation bumps these, they are sharded.
+		static Counter __live_blocks;
+		static Counter __allocs;
+		static Counter __frees;
+		static Counter __reallocs;
+		static Counter __realloc_moves;
+
+		static std::atomic<const char *> __tag_names[max_alloc_tags];
+		static std::atomic<u64> __tag_count[max_alloc_tags];
+		static std::atomic<u64> __tag_bytes[max_alloc_tags];
+
+		static thread_local uint __tag_current = __tag_untagged;
+
+		static uint __tag_index(const char *name) {
+			if(name == nullptr)
+				return __tag_untagged;
+
+			for(uint i = __tag_untagged + 1; i < __tag_other; i++) {
+				const char *slot = __tag_names[i].load(std::memory_order_acquire);
+
+				if(slot == nullptr) {
+					if(__tag_names[i].compare_exchange_strong(slot, name, std::memory_order_acq_rel))
+						return i;
+				}
+
+				if(slot == name || std::strcmp(slot, name) == 0)
+					return i;
+			};
+
+			return __tag_other;
+		};
+
+		static void __grow_live(ulong n) {
+			u64 live = __live_bytes.fetch_add(n, std::memory_order_relaxed) + n;
+			u64 peak = __peak_bytes.load(std::memory_order_relaxed);
+
+			while(live > peak && !__peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+		};
+
+		void __alloc_hook(ulong n) {
+			__allocs.add();
+			__live_blocks.add();
+			__tag_count[__tag_current].fetch_add(1, std::memory_order_relaxed);
+			__tag_bytes[__tag_current].fetch_add(n, std::memory_order_relaxed);
+			__grow_live(n);
+		};
+
+		void __realloc_hook(ulong old_n, ulong n, bool moved) {
+			__reallocs.add();
+			if(moved)
+				__realloc_moves.add();
+
+			if(n > old_n) {
+				__tag_bytes[__tag_current].fetch_add(n - old_n, std::memory_order_relaxed);
+				__grow_live(n - old_n);
+			} else {
+				__live_bytes.fetch_sub(old_n - n, std::memory_order_relaxed);
+			}
+		};
+
+		void __free_hook(ulong n) {
+			__frees.add();
+			__live_blocks.sub();
+			__live_bytes.fetch_sub(n, std::memory_order_relaxed);
+		};
+
+		ScopedTag::ScopedTag(const char *name) {
+			previous = __tag_current;
+			__tag_current = __tag_index(name);
+		};
+
+		ScopedTag::~ScopedTag(void) {
+			__tag_current = previous;
+		};
+
+		alloc_snapshot_t alloc_snapshot(void) {
+			alloc_snapshot_t s;
+
+			#ifdef OX_ALLOC_STATS
+				s.enabled = true;
+
+				s.live_bytes = __live_bytes.load(std::memory_order_relaxed);
+				s.peak_bytes = __peak_bytes.load(std::memory_order_relaxed);
+				s.live_blocks = (u64)__live_blocks.value();
+				s.allocs = (u64)__allocs.value();
+				s.frees = (u64)__frees.value();
+				s.reallocs = (u64)__reallocs.value();
+				s.realloc_moves = (u64)__realloc_moves.value();
+
+				for(uint i = 0; i < max_alloc_tags; i++) {
+					const char *name = __tag_names[i].load(std::memory_order_acquire);
+
+					if(i == __tag_untagged)
+						name = "untagged";
+					else if(i == __tag_other)
+						name = "other";
+					else if(name == nullptr)
+						continue;
+
+					alloc_tag_t &t = s.tags[s.num_tags++];
+					t.name = name;
+					t.count = __tag_count[i].load(std::memory_order_relaxed);
+					t.bytes = __tag_bytes[i].load(std::memory_order_relaxed);
+				};
+			#endif
+
+			return s;
+		};
+
+		static const char *__wait_names[num_wait_kinds] = {
+			"condvar", "semaphore", "latch", "barrier", "event",
+			"mutex", "rwlock_read", "rwlock_write"
+		};
+
+		static std::atomic<u64> __wait_count[num_wait_kinds];
+		static std::atomic<u64> __wait_timeouts[num_wait_kinds];
+		static std::atomic<u64> __wait_ns[num_wait_kinds];
+		static std::atomic<u64> __wait_max_ns[num_wait_kinds];
+		static std::atomic<u64> __wait_contended[num_wait_kinds];
+
+		void __wait_hook(uint kind, u64 ns, bool timed_out) {
+			if(kind >= num_wait_kinds)
+				return;
+
+			__wait_count[kind].fetch_add(1, std::memory_order_relaxed);
+			__wait_ns[kind].fetch_add(ns, std::memory_order_relaxed);
+			if(timed_out)
+				__wait_timeouts[kind].fetch_add(1, std::memory_order_relaxed);
+
+			u64 most = __wait_max_ns[kind].load(std::memory_order_relaxed);
+			while(ns > most && !__wait_max_ns[kind].compare_exchange_weak(most, ns, std::memory_order_relaxed));
+		};
+
+		void __contended_hook(uint kind) {
+			if(kind < num_wait_kinds)
+				__wait_contended[kind].fetch_add(1, std::memory_order_relaxed);
+		};
+
+		wait_snapshot_t wait_snapshot(void) {
+			wait_snapshot_t s;
+
+			for(uint i = 0; i < num_wait_kinds; i++) {
+				wait_stats_t &w = s.kinds[i];
+				w.name = __wait_names[i];
+				w.waits = __wait_count[i].load(std::memory_order_relaxed);
+				w.timeouts = __wait_timeouts[i].load(std::memory_order_relaxed);
+				w.wait_ns = __wait_ns[i].load(std::memory_order_relaxed);
+				w.max_wait_ns = __wait_max_ns[i].load(std::memory_order_relaxed);
+				w.contended = __wait_contended[i].load(std::memory_order_relaxed);
+			};
+
+			return s;
+		};
+
+		int alloc_dump_json(BasicIOStream &os, Error &err) {
+			if(err != nullptr)
+				return -1;
+
+			alloc_snapshot_t s = alloc_snapshot();
+			char b[256];
+
+			int n = std::snprintf(b, sizeof(b),
+				"{\"enabled\":%s,\"live_bytes\":%llu,\"peak_bytes\":%llu,\"live_blocks\":%llu,"
+				"\"allocs\":%llu,\"frees\":%llu,\"reallocs\":%llu,\"realloc_moves\":%llu,\"tags\":[",
+				s.enabled ? "true" : "false",
+				(unsigned long long)s.live_bytes, (unsigned long long)s.peak_bytes,
+				(unsigned long long)s.live_blocks, (unsigned long long)s.allocs,
+				(unsigned long long)s.frees, (unsigned long long)s.reallocs,
+				(unsigned long long)s.realloc_moves);
+
+			if(os.write((u8 *)b, n, err) != 0)
+				return -1;
+
+			for(uint i = 0; i < s.num_tags; i++) {
+				if(i > 0 && os.write((u8 *)",", 1, err) != 0)
+					return -1;
+
+				if(os.write((u8 *)"{\"name\":\"", 9, err) != 0)
+					return -1;
+
+				// Tags are literals, only quotes and backslashes need escaping.
+				for(const char *c = s.tags[i].name; *c != '\0'; c++) {
+					if((*c == '"' || *c == '\\') && os.write((u8 *)"\\", 1, err) != 0)
+						return -1;
+					if(os.write((u8 *)c, 1, err) != 0)
+						return -1;
+				};
+
+				n = std::snprintf(b, sizeof(b), "\",\"count\":%llu,\"bytes\":%llu}",
+					(unsigned long long)s.tags[i].count, (unsigned long long)s.tags[i].bytes);
+
+				if(os.write((u8 *)b, n, err) != 0)
+					return -1;
+			};
+
+			return os.write((u8 *)"]}", 2, err);
+		};
+	};
+};
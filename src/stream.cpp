@@ -18,6 +18,49 @@
 #include "../include/io/stream.hpp"
 
 namespace Ox {
+	long BasicIOStream::readv(const io_slice_t *slices, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(slices == nullptr && n > 0) {
+			err = "'slices' is NULL";
+			return -1;
+		}
+
+		ulong done = 0;
+
+		for(ulong i = 0; i < n; i++) {
+			if(slices[i].length == 0)
+				continue;
+
+			long r = read(slices[i].data, slices[i].length, err);
+			if(r < 0)
+				return -1;
+
+			done += r;
+			if((ulong)r < slices[i].length)
+				break;
+		};
+
+		return done;
+	};
+
+	int BasicIOStream::writev(const io_slice_t *slices, ulong n, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(slices == nullptr && n > 0) {
+			err = "'slices' is NULL";
+			return -1;
+		}
+
+		for(ulong i = 0; i < n; i++)
+			if(slices[i].length > 0 && write(slices[i].data, slices[i].length, err) != 0)
+				return -1;
+
+		return 0;
+	};
+
 	u8 BasicIOStream::readU8(Error &err) {
 		u8 b[1];
 		read(b, 1, err);
@@ -17,23 +17,14 @@
 
 #include "../include/nuclei.hpp"
 #include "../include/core/string.hpp"
+#include "../include/core/stats.hpp"
 #include <cstring>
 #include <cerrno>
 #include <cstdarg>
 #include <cstdio>
+#include <cwchar>
 
 namespace Ox {
-	ulong strlen(const char *str) {
-		if(str == nullptr)
-			return 0;
-
-		ulong i = 0;
-		while(*str != '\0')
-			{ str++; i++; };
-		
-		return i;
-	};
-
 	String::String(void) {};
 
 	String::String(const char *s) {
@@ -44,6 +35,70 @@ namespace Ox {
 		from_c(s, err);
 	};
 
+	String::String(const String &other) {
+		if(other.handle_data != nullptr)
+			from_c(other.handle_data, other.handle_length, err);
+	};
+
+	String::String(String &&other) {
+		steal(other);
+	};
+
+	char *String::prepare(ulong n, Error &err) {
+		if(err != nullptr)
+			return nullptr;
+
+		if(n <= small_capacity && (handle_data == nullptr || is_small())) {
+			handle_data = handle_small;
+			return handle_data;
+		}
+
+		if(handle_capacity >= n)
+			return handle_data;
+
+		OX_ALLOC_TAG("string");
+
+		char *s = inhale_raw<char>(n + 1, err);
+		if(s == nullptr)
+			return nullptr;
+
+		if(handle_capacity > 0)
+			exhale(handle_data);
+
+		handle_data = s;
+		handle_capacity = n;
+
+		return s;
+	};
+
+	void String::release(void) {
+		if(handle_capacity > 0)
+			exhale(handle_data);
+
+		handle_data = nullptr;
+		handle_length = handle_capacity = 0;
+	};
+
+	void String::steal(String &other) {
+		release();
+
+		if(other.handle_data == nullptr)
+			return;
+
+		if(other.is_small()) {
+			std::memcpy(handle_small, other.handle_small, other.handle_length + 1);
+			handle_data = handle_small;
+		} else {
+			handle_data = other.handle_data;
+			handle_capacity = other.handle_capacity;
+		}
+
+		handle_length = other.handle_length;
+
+		other.handle_data = nullptr;
+		other.handle_length = other.handle_capacity = 0;
+	};
+
 	int String::from_fmt(Error &err, const char *format, ...) {
 		if(err != nullptr)
 			return -1;
@@ -60,27 +115,26 @@ namespace Ox {
 			return -1;
 		}
 
-		char *s = inhale<char>(length + 1, err);
+		// Arguments may point into this string, format into a new one.
+		String str;
+		char *s = str.prepare(length, err);
 		if(s == nullptr)
 			return -1;
 
 		va_start(args, format);
-		int c = std::vsnprintf(s, length, format, args);
+		int c = std::vsnprintf(s, length + 1, format, args);
 		va_end(args);
 
 		if(c < 0) {
-			exhale(s);
 			err.from_fmt("Couldn't format the string: %s", std::strerror(errno));
 			err.from_c("Couldn't format the string");
 			return -1;
 		}
 
 		s[length] = '\0';
+		str.handle_length = length;
 
-		if(implptr != nullptr)
-			exhale(implptr);
-
-		implptr = s;
+		steal(str);
 		return 0;
 	};
 
@@ -93,227 +147,342 @@ namespace Ox {
 			return -1;
 		}
 
-		char *s = (char *)implptr;
+		return from_c(source, strlen(source), err);
+	};
+
+	int String::from_c(const char *source, ulong len, Error &err) {
+		if(err != nullptr)
+			return -1;
 
-		if(s != nullptr) {
-			exhale(s);
-			implptr = nullptr;
+		if(source == nullptr) {
+			err = "'source' is NULL";
+			return -1;
 		}
 
-		ulong len = static_cast<ulong>(strlen(source));
+		// 'source' may live inside this string, 'prepare' copies before freeing.
+		if(source >= handle_data && source <= handle_data + handle_length && handle_data != nullptr) {
+			String str;
+			if(str.from_c(source, len, err) != 0)
+				return -1;
+
+			steal(str);
+			return 0;
+		}
 
-		s = inhale<char>(len + 1, err);
+		char *s = prepare(len, err);
 		if(s == nullptr)
 			return -1;
 
-		for(ulong i = 0; i < len; i++)
-			s[i] = source[i];
+		std::memcpy(s, source, len);
+		s[len] = '\0';
 
-		implptr = s;
+		handle_length = len;
 		return 0;
 	};
 
-	Ox::ulong __string_strlen_wchar2utf8(const wchar_t *s) {
-		Ox::ulong n = 0;
+	int String::from_c(const wchar_t *source, Error &err) {
+		if(err != nullptr)
+			return -1;
+		
+		if(source == nullptr) {
+			err = "'source' is NULL";
+			return -1;
+		}
+
+		ulong n = std::wcslen(source);
+		ulong len = utf8_length(source, n);
 
-		while(*s != '\0') {
-			if((*s & 0xf800) > 0) n += 3;
-			else if((*s & 0x780) > 0) n += 2;
-			else n++;
+		char *s = prepare(len, err);
+		if(s == nullptr)
+			return -1;
 
-			s++;
-		};
+		(void)utf8_from_wide(source, n, s);
+		s[len] = '\0';
+		handle_length = len;
 
-		return n;
+		return 0;
 	};
 
-	void __string_strconv_wchar2utf8(const wchar_t *src, char *dst, ulong max_len) {
-		u32 codepoint;
-		ulong dst_i = 0;
+	bool String::operator==(const String &other) const {
+		if(handle_data == nullptr || other.handle_data == nullptr)
+			return handle_data == other.handle_data;
 
-		if(*src == 0xfeff) src++;
-		ox_assert(*src != 0xfffe, "[TODO] : Add byte-swapping support");	// [TODO] : Add byte-swapping support
+		return handle_length == other.handle_length
+			&& memeq(handle_data, other.handle_data, handle_length);
+	};
 
-		while(dst_i < max_len) {
-			codepoint = *src;
-			if(codepoint == 0)
-				break;
+	int String::compare(const String &other) const {
+		ulong n = handle_length < other.handle_length ? handle_length : other.handle_length;
+		int r = memcmp(handle_data, other.handle_data, n);
 
-			src++;
+		if(r != 0 || handle_length == other.handle_length)
+			return r;
 
-			if(codepoint >= 0xd800 && codepoint <= 0xdfff) {
-				codepoint = (codepoint & 0xff) << 10;
+		return handle_length < other.handle_length ? -1 : 1;
+	};
 
-				ox_assert(*src >= 0xd800 && *src <= 0xdfff, "Invalid UTF-16 codepoint");
+	String String::concat(const char *right) {
+		return concat(right, strlen(right));
+	};
 
-				codepoint |= (char)*src;
+	String String::concat(const char *right, ulong len_right) {
+		String str;
 
-				src++;
-			}
+		if(right == nullptr)
+			return str;
 
-			if(codepoint < 0x80) {
-				dst[dst_i] = (char)codepoint;
-				dst_i++;
-				continue;
-			}
+		if(handle_data == nullptr) {
+			str.from_c(right, len_right, err);
+			return str;
+		}
 
-			if(codepoint < 0x800) {
-				dst[dst_i] = 0b110'00000 | (char)(codepoint >> 6);
-				dst_i++;
+		char *b = str.prepare(handle_length + len_right, err);
+		if(b == nullptr)
+			return str;
 
-				if(dst_i >= max_len)
-					break;
+		std::memcpy(b, handle_data, handle_length);
+		std::memcpy(b + handle_length, right, len_right);
+		b[handle_length + len_right] = '\0';
 
-				dst[dst_i] = 0b1000'0000 | (char)(codepoint & 0b111111);
-				dst_i++;
+		str.handle_length = handle_length + len_right;
+		return str;
+	};
 
-				continue;
-			}
+	String String::operator+(const char *right) {
+		return concat(right);
+	};
 
-			if(codepoint < 0x10000) {
-				dst[dst_i] = 0b1110'0000 | (char)(codepoint >> 12);
-				dst_i++;
+	String String::operator+(const String &right) {
+		return concat(right.handle_data, right.handle_length);
+	};
 
-				if(dst_i >= max_len)
-					break;
+	String &String::operator=(const char *s) {
+		from_c(s, err);
+		return *this;
+	};
 
-				dst[dst_i] = 0b1000'0000 | (char)(codepoint >> 6);
-				dst_i++;
+	String &String::operator=(char *s) {
+		from_c(s, err);
+		return *this;
+	};
 
-				if(dst_i >= max_len)
-					break;
+	String &String::operator=(const String &other) {
+		if(this == &other)
+			return *this;
 
-				dst[dst_i] = 0b1000'0000 | (char)(codepoint >> 6);
-				dst_i++;
+		if(other.handle_data == nullptr)
+			release();
+		else
+			from_c(other.handle_data, other.handle_length, err);
 
-				continue;
-			}
+		return *this;
+	};
 
-			if(codepoint < 0x200000) {
-				dst[dst_i] = 0b1111'0000 | (char)(codepoint >> 18);
-				dst_i++;
+	String &String::operator=(String &&other) {
+		if(this != &other)
+			steal(other);
 
-				if(dst_i >= max_len)
-					break;
+		return *this;
+	};
 
-				dst[dst_i] = 0b1000'0000 | (char)(codepoint >> 12);
-				dst_i++;
+	String::~String(void) {
+		release();
+	};
 
-				if(dst_i >= max_len)
-					break;
+	StringBuilder::~StringBuilder(void) {
+		clear();
+	};
 
-				dst[dst_i] = 0b1000'0000 | (char)(codepoint >> 6);
-				dst_i++;
+	void StringBuilder::clear(void) {
+		if(handle_data != nullptr)
+			exhale(handle_data);
 
-				if(dst_i >= max_len)
-					break;
-				
-				dst[dst_i] = 0b1000'0000 | (char)codepoint;
-				dst_i++;
-	
-				continue;
-			}
+		handle_data = nullptr;
+		handle_length = handle_capacity = 0;
+	};
+
+	char *StringBuilder::grow(ulong n, Error &err) {
+		if(err != nullptr)
+			return nullptr;
+
+		if(handle_length + n <= handle_capacity)
+			return handle_data + handle_length;
+
+		ulong capacity = handle_capacity < 16 ? 32 : handle_capacity * 2;
+		if(capacity < handle_length + n)
+			capacity = handle_length + n;
+
+		OX_ALLOC_TAG("string");
+
+		char *s = handle_data == nullptr
+			? inhale_raw<char>(capacity + 1, err)
+			: respire<char>(handle_data, capacity + 1, err);
+
+		if(s == nullptr)
+			return nullptr;
 
-			ox_assert(false, "huh? out of bonds?");
-		};
+		handle_data = s;
+		handle_capacity = capacity;
 
-		dst[dst_i] = '\0';
+		return handle_data + handle_length;
 	};
 
-	int String::from_c(const wchar_t *source, Error &err) {
+	int StringBuilder::reserve(ulong n, Error &err) {
+		if(n <= handle_length)
+			return err != nullptr ? -1 : 0;
+
+		return grow(n - handle_length, err) == nullptr ? -1 : 0;
+	};
+
+	int StringBuilder::append(const char *s, Error &err) {
 		if(err != nullptr)
 			return -1;
-		
-		if(source == nullptr) {
-			err = "'source' is NULL";
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
 			return -1;
 		}
 
-		ox_assert(sizeof(wchar_t) == 2, "Unexpected wchar_t size");
-		
-		char *s = (char *)implptr;
+		return append(s, strlen(s), err);
+	};
 
-		if(s != nullptr) {
-			exhale(s);
-			implptr = nullptr;
+	int StringBuilder::append(const char *s, ulong len, Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(s == nullptr) {
+			err = "'s' is NULL";
+			return -1;
 		}
 
-		ulong len = __string_strlen_wchar2utf8(source);
+		// 's' may point into our own buffer, which 'grow' can move.
+		ulong off = handle_length;
+		bool inside = handle_data != nullptr && s >= handle_data && s < handle_data + handle_length;
+		if(inside)
+			off = s - handle_data;
 
-		s = inhale<char>(len + 1, err);
-		if(s == nullptr)
+		char *tail = grow(len, err);
+		if(tail == nullptr)
 			return -1;
 
-		__string_strconv_wchar2utf8(source, s, len);
+		if(inside)
+			s = handle_data + off;
 
-		implptr = s;
+		std::memmove(tail, s, len);
+		handle_length += len;
+		handle_data[handle_length] = '\0';
 
 		return 0;
 	};
 
-	const char *String::c_str(void) {
-		char *s = (char *)implptr;
-		return s;
+	int StringBuilder::append(const String &s, Error &err) {
+		if(s.c_str() == nullptr)
+			return err != nullptr ? -1 : 0;
+
+		return append(s.c_str(), s.length(), err);
 	};
 
-	String String::concat(const char *right) {
-		String str;
+	int StringBuilder::append_char(char c, Error &err) {
+		char *tail = grow(1, err);
+		if(tail == nullptr)
+			return -1;
 
-		if(right == nullptr)
-			return str;
+		*tail = c;
+		handle_length++;
+		handle_data[handle_length] = '\0';
 
-		char *left = (char *)implptr;
-		if(left == nullptr) {
-			str.from_c(right, err);
-			return str;
-		}
+		return 0;
+	};
 
-		if(right == nullptr) {
-			str.from_c(left, err);
-			return str;
-		}
+	int StringBuilder::append_uint(u64 v, Error &err) {
+		char digits[20];
+		ulong n = 0;
 
-		ulong len_left = strlen(left);
-		ulong len_right = strlen(right);
+		do {
+			digits[n++] = '0' + (v % 10);
+			v /= 10;
+		} while(v > 0);
 
-		char *b = inhale<char>(len_left + len_right + 1, err);
-		if(b == nullptr)
-			return str;
+		char *tail = grow(n, err);
+		if(tail == nullptr)
+			return -1;
 
-		ulong i;
-		for(i = 0; *left != '\0'; i++)
-			b[i] = *left++;
-		for(; *right != '\0'; i++)
-			b[i] = *right++;
+		for(ulong i = 0; i < n; i++)
+			tail[i] = digits[n - i - 1];
 
-		str.from_c(b, err);
-		exhale(b);
-		
-		return str;
-	};
+		handle_length += n;
+		handle_data[handle_length] = '\0';
 
-	String String::operator+(const char *right) {
-		return concat(right);
+		return 0;
 	};
 
-	String String::operator+(String &right) {
-		return concat(right.c_str());
-	};
+	int StringBuilder::append_int(i64 v, Error &err) {
+		if(v >= 0)
+			return append_uint((u64)v, err);
 
-	String String::operator=(const char *s) {
-		from_c(s, err);
-		return *this;
+		if(append_char('-', err) != 0)
+			return -1;
+
+		// Negating through u64 keeps INT64_MIN intact.
+		return append_uint(0 - (u64)v, err);
 	};
 
-	String String::operator=(char *s) {
-		from_c(s, err);
-		return *this;
+	int StringBuilder::append_fmt(Error &err, const char *format, ...) {
+		if(err != nullptr)
+			return -1;
+
+		if(format == nullptr) {
+			err = "'format' is NULL";
+			return -1;
+		}
+
+		if(grow(1, err) == nullptr)
+			return -1;
+
+		// Format straight into the spare capacity, only retry when it didn't fit.
+		std::va_list args;
+		ulong spare = handle_capacity - handle_length;
+
+		va_start(args, format);
+		int length = std::vsnprintf(handle_data + handle_length, spare + 1, format, args);
+		va_end(args);
+
+		if(length < 0) {
+			handle_data[handle_length] = '\0';
+			err.from_fmt("Couldn't format the string: %s", std::strerror(errno));
+			err.from_c("Couldn't format the string");
+			return -1;
+		}
+
+		if((ulong)length > spare) {
+			char *tail = grow(length, err);
+			if(tail == nullptr) {
+				handle_data[handle_length] = '\0';
+				return -1;
+			}
+
+			va_start(args, format);
+			(void)std::vsnprintf(tail, length + 1, format, args);
+			va_end(args);
+		}
+
+		handle_length += length;
+		return 0;
 	};
 
-	String::~String(void) {
-		char *s = (char *)implptr;
+	String StringBuilder::take(void) {
+		String str;
 
-		if(s != nullptr)
-			exhale(s);
+		if(handle_data == nullptr)
+			return str;
+
+		str.handle_data = handle_data;
+		str.handle_length = handle_length;
+		str.handle_capacity = handle_capacity;
+
+		handle_data = nullptr;
+		handle_length = handle_capacity = 0;
+
+		return str;
 	};
 };
@@ -0,0 +1,477 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/task.hpp"
+
+#ifdef OX_USE_COROUTINES
+#include "../include/core/thread.hpp"
+#include "../include/core/elastic.hpp"
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace Ox {
+	typedef struct __ox_timer_t {
+		u64 deadline;
+		void *h;
+	} __ox_timer_t;
+
+	typedef struct __ox_watch_t {
+		int fd;
+		short events;
+		void *h;
+		int *rc;
+		Error *err;
+	} __ox_watch_t;
+
+	typedef struct __ox_executor_t {
+		Mutex lock;
+		CondVar wake;
+
+		// FIFO of coroutine addresses, a power-of-two ring.
+		void **ready = nullptr;
+		ulong ready_capacity = 0;
+		ulong ready_head = 0;
+		ulong ready_size = 0;
+
+		// Min-heap on 'deadline'.
+		Elastic<__ox_timer_t> timers;
+		Elastic<__ox_watch_t> watches;
+
+		// Written to whenever 'run' should look again.
+		int pipe_fds[2] = { -1, -1 };
+		std::atomic<bool> polling { false };
+
+		Thread *workers = nullptr;
+		int num_workers = 0;
+		bool quit = false;
+
+		std::atomic<long> pending { 0 };
+
+		void nudge(void) {
+			if(polling.load(std::memory_order_seq_cst)) {
+				char c = 0;
+				(void)!write(pipe_fds[1], &c, 1);
+			}
+		};
+
+		// With 'lock' held.
+		bool push(void *h) {
+			if(ready_size == ready_capacity) {
+				ulong capacity = ready_capacity == 0 ? 64 : ready_capacity * 2;
+
+				Error err;
+				void **q = inhale_raw<void *>(capacity, err);
+				if(q == nullptr)
+					return false;
+
+				for(ulong i = 0; i < ready_size; i++)
+					q[i] = ready[(ready_head + i) & (ready_capacity - 1)];
+
+				if(ready != nullptr)
+					exhale(ready);
+
+				ready = q;
+				ready_capacity = capacity;
+				ready_head = 0;
+			}
+
+			ready[(ready_head + ready_size) & (ready_capacity - 1)] = h;
+			ready_size++;
+
+			return true;
+		};
+
+		// With 'lock' held.
+		void *pop(void) {
+			if(ready_size == 0)
+				return nullptr;
+
+			void *h = ready[ready_head];
+			ready_head = (ready_head + 1) & (ready_capacity - 1);
+			ready_size--;
+
+			return h;
+		};
+
+		void add_timer(__ox_timer_t t, Error &err) {
+			if(timers.push_end(t, err) < 0)
+				return;
+
+			for(long i = timers.size() - 1; i > 0; ) {
+				long parent = (i - 1) / 2;
+				if(timers[parent].deadline <= timers[i].deadline)
+					break;
+
+				__ox_timer_t tmp = timers[parent];
+				timers[parent] = timers[i];
+				timers[i] = tmp;
+				i = parent;
+			};
+		};
+
+		__ox_timer_t pop_timer(void) {
+			__ox_timer_t top = timers[0];
+			Error err;
+			__ox_timer_t last = timers.pop_end(err);
+
+			long n = timers.size();
+			if(n == 0)
+				return top;
+
+			timers[0] = last;
+
+			for(long i = 0; ; ) {
+				long l = 2 * i + 1;
+				long r = l + 1;
+				long m = i;
+
+				if(l < n && timers[l].deadline < timers[m].deadline) m = l;
+				if(r < n && timers[r].deadline < timers[m].deadline) m = r;
+				if(m == i)
+					break;
+
+				__ox_timer_t tmp = timers[m];
+				timers[m] = timers[i];
+				timers[i] = tmp;
+				i = m;
+			};
+
+			return top;
+		};
+	} __ox_executor_t;
+
+	static u64 __ox_executor_now(void) {
+		return (u64)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	};
+
+	static void __ox_executor_resume(void *h) {
+		std::coroutine_handle<>::from_address(h).resume();
+	};
+
+	void __ox_executor_done(Executor *e) {
+		__ox_executor_t *ex = (__ox_executor_t *)e->handle;
+
+		// The last one out lets 'run' return.
+		if(ex->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			ex->nudge();
+	};
+
+	static void __ox_executor_worker(void *user) {
+		__ox_executor_t *ex = (__ox_executor_t *)user;
+		Error err;
+
+		for(;;) {
+			ex->lock.lock(err);
+
+			void *h;
+			while((h = ex->pop()) == nullptr && !ex->quit)
+				ex->wake.wait(ex->lock, err);
+
+			ex->lock.unlock(err);
+
+			if(h == nullptr)
+				return;
+
+			__ox_executor_resume(h);
+		};
+	};
+
+	Executor::~Executor(void) {
+		release();
+	};
+
+	int Executor::init(Error &err, int workers) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle != nullptr) {
+			err = "Executor already initialized";
+			return -1;
+		}
+
+		if(workers < 0) {
+			err = "'workers' should be greater or equal to zero";
+			return -1;
+		}
+
+		__ox_executor_t *ex = inhale<__ox_executor_t>(err);
+		if(ex == nullptr)
+			return -1;
+
+		// I hate this...
+		new (ex) __ox_executor_t();
+
+		if(pipe(ex->pipe_fds) != 0) {
+			err.from_fmt("Couldn't create the wake-up pipe: %s", std::strerror(errno));
+			err.from_c("Couldn't create the wake-up pipe");
+
+			ex->~__ox_executor_t();
+			exhale(ex);
+			return -1;
+		}
+
+		for(int i = 0; i < 2; i++)
+			fcntl(ex->pipe_fds[i], F_SETFL, fcntl(ex->pipe_fds[i], F_GETFL) | O_NONBLOCK);
+
+		handle = ex;
+
+		if(workers > 0) {
+			ex->workers = inhale<Thread>(workers, err);
+			if(ex->workers == nullptr) {
+				release();
+				return -1;
+			}
+
+			for(int i = 0; i < workers; i++) {
+				new (&ex->workers[i]) Thread();
+				if(ex->workers[i].init(err, __ox_executor_worker, ex) != 0)
+					break;
+
+				ex->num_workers++;
+			};
+
+			if(err != nullptr) {
+				release();
+				return -1;
+			}
+		}
+
+		return 0;
+	};
+
+	void Executor::release(void) {
+		__ox_executor_t *ex = (__ox_executor_t *)handle;
+		if(ex == nullptr)
+			return;
+
+		Error err;
+		ex->lock.lock(err);
+		ex->quit = true;
+		ex->lock.unlock(err);
+		ex->wake.notify_all();
+
+		if(ex->workers != nullptr) {
+			for(int i = 0; i < ex->num_workers; i++)
+				ex->workers[i].join();
+
+			exhale(ex->workers);
+		}
+
+		close(ex->pipe_fds[0]);
+		close(ex->pipe_fds[1]);
+
+		if(ex->ready != nullptr)
+			exhale(ex->ready);
+
+		ex->~__ox_executor_t();
+		exhale(ex);
+		handle = nullptr;
+	};
+
+	void Executor::post(std::coroutine_handle<> h) {
+		__ox_executor_t *ex = (__ox_executor_t *)handle;
+		Error err;
+
+		ex->lock.lock(err);
+		bool queued = ex->push(h.address());
+		ex->lock.unlock(err);
+
+		// Out of memory: better run it here than lose it.
+		if(!queued) {
+			h.resume();
+			return;
+		}
+
+		ex->wake.notify_one();
+		ex->nudge();
+	};
+
+	int Executor::spawn(Error &err, Task<void> task) {
+		if(err != nullptr)
+			return -1;
+
+		__ox_executor_t *ex = (__ox_executor_t *)handle;
+		if(ex == nullptr) {
+			err = "Unitialized Executor";
+			return -1;
+		}
+
+		std::coroutine_handle<__ox_promise_t<void>> h = task.release();
+		if(!h) {
+			err = "'task' is empty";
+			return -1;
+		}
+
+		h.promise().detached_on = this;
+		ex->pending.fetch_add(1, std::memory_order_relaxed);
+		post(h);
+
+		return 0;
+	};
+
+	void Executor::at(ulong microseconds, std::coroutine_handle<> h, Error *err) {
+		__ox_executor_t *ex = (__ox_executor_t *)handle;
+		Error meh;
+
+		ex->lock.lock(meh);
+		ex->add_timer(__ox_timer_t { __ox_executor_now() + microseconds, h.address() }, *err);
+		ex->lock.unlock(meh);
+
+		// Couldn't queue the timer, resume right away with 'err' set.
+		if(*err != nullptr) {
+			post(h);
+			return;
+		}
+
+		ex->nudge();
+	};
+
+	int Executor::watch(int fd, short events, std::coroutine_handle<> h, int *rc, Error *err) {
+		__ox_executor_t *ex = (__ox_executor_t *)handle;
+
+		ex->lock.lock(*err);
+		ex->watches.push_end(__ox_watch_t { fd, events, h.address(), rc, err }, *err);
+		ex->lock.unlock(*err);
+
+		if(*err != nullptr)
+			return -1;
+
+		ex->nudge();
+		return 0;
+	};
+
+	Executor::ready_t Executor::readable(int fd, Error &err) {
+		if(err == nullptr && fd < 0)
+			err = "'fd' is invalid";
+
+		return ready_t { this, fd, POLLIN, &err };
+	};
+
+	Executor::ready_t Executor::writable(int fd, Error &err) {
+		if(err == nullptr && fd < 0)
+			err = "'fd' is invalid";
+
+		return ready_t { this, fd, POLLOUT, &err };
+	};
+
+	int Executor::run(Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		__ox_executor_t *ex = (__ox_executor_t *)handle;
+		if(ex == nullptr) {
+			err = "Unitialized Executor";
+			return -1;
+		}
+
+		Elastic<pollfd> fds;
+
+		while(ex->pending.load(std::memory_order_acquire) > 0) {
+			ex->lock.lock(err);
+			void *h = ex->pop();
+			ex->lock.unlock(err);
+
+			if(h != nullptr) {
+				__ox_executor_resume(h);
+				continue;
+			}
+
+			// Nothing to run: wait for a timer, a descriptor or a nudge.
+			ex->polling.store(true, std::memory_order_seq_cst);
+
+			ex->lock.lock(err);
+			bool idle = ex->ready_size == 0;
+			long timeout = -1;
+
+			if(ex->timers.size() > 0) {
+				u64 now = __ox_executor_now();
+				u64 deadline = ex->timers[0].deadline;
+				timeout = deadline <= now ? 0 : (long)((deadline - now + 999) / 1000);
+			}
+
+			long n = 1 + ex->watches.size();
+			while(fds.size() < n && fds.push_end(pollfd {}, err) > 0) {};
+
+			if(err == nullptr) {
+				fds[0] = pollfd { ex->pipe_fds[0], POLLIN, 0 };
+				for(long i = 1; i < n; i++)
+					fds[i] = pollfd { ex->watches[i - 1].fd, ex->watches[i - 1].events, 0 };
+			}
+
+			ex->lock.unlock(err);
+
+			if(err != nullptr) {
+				ex->polling.store(false, std::memory_order_relaxed);
+				return -1;
+			}
+
+			if(idle && ex->pending.load(std::memory_order_acquire) > 0)
+				(void)poll(fds.begin(), n, (int)timeout);
+
+			ex->polling.store(false, std::memory_order_relaxed);
+
+			char drain[64];
+			while(read(ex->pipe_fds[0], drain, sizeof(drain)) > 0) {};
+
+			ex->lock.lock(err);
+
+			// Watches only ever get appended meanwhile, the first ones
+			// still line up with 'fds'.
+			for(long i = n - 1; i >= 1; i--) {
+				short revents = fds[i].revents;
+				if(revents == 0)
+					continue;
+
+				__ox_watch_t w = ex->watches[i - 1];
+
+				if(revents & POLLNVAL) {
+					*w.err = "'fd' is invalid";
+					*w.rc = -1;
+				} else {
+					*w.rc = 0;
+				}
+
+				// Out of memory: keep watching, the next round fires it again.
+				if(!ex->push(w.h))
+					continue;
+
+				ex->watches[i - 1] = ex->watches[ex->watches.size() - 1];
+				(void)ex->watches.pop_end(err);
+			};
+
+			// Same for timers, left in the heap until they fit the queue.
+			u64 now = __ox_executor_now();
+			while(ex->timers.size() > 0 && ex->timers[0].deadline <= now && ex->push(ex->timers[0].h))
+				(void)ex->pop_timer();
+
+			bool any = ex->ready_size > 0;
+			ex->lock.unlock(err);
+
+			if(any)
+				ex->wake.notify_all();
+		};
+
+		return err != nullptr ? -1 : 0;
+	};
+};
+#endif
@@ -16,6 +16,8 @@
 **/
 
 #include "../include/core/thread.hpp"
+#include "../include/core/stats.hpp"
+#include <chrono>
 
 #ifdef OX_DISABLE_THREAD
 	#warning "Flag OX_DISABLE_THREAD is set"
@@ -30,116 +32,347 @@
 		#error "No <thread> nor <pthread.h> support"
 	#endif
 
+	// Counts the cores this process may run on, not the machine's.
+	#if defined(OX_OS_LINUX) && ox_has_include(<sched.h>)
+		#define OX_USE_THREAD_AFFINITY
+		#include <sched.h>
+	#endif
+
+	#if defined(OX_OS_LINUX) && !defined(OX_DISABLE_FUTEX) && ox_has_include(<linux/futex.h>) && ox_has_include(<sys/syscall.h>)
+		#define OX_USE_THREAD_FUTEX
+		#include <linux/futex.h>
+		#include <sys/syscall.h>
+		#include <unistd.h>
+		#include <climits>
+		#include <cerrno>
+		#include <time.h>
+	#endif
+
+	// Options are applied through the pthread_t under std::thread too.
+	#if !defined(OX_OS_WINDOWS) && ox_has_include(<pthread.h>)
+		#define OX_USE_THREAD_NATIVE
+		#include <pthread.h>
+		#include <sched.h>
+		#include <cstring>
+	#endif
+
 	#ifdef OX_USE_THREAD_STDCPP
 		#include <thread>
 		#include <mutex>
+		#include <condition_variable>
 		#include <new>
+		#include <chrono>
 	#elif defined(OX_USE_THREAD_PTHREAD)
 		#include <pthread.h>
+		#include <new>
+		#include <sched.h>
+		#include <time.h>
+		#include <unistd.h>
+		#include <cerrno>
 	#else
 		#error "Well, this is awkward..."
 	#endif
 #endif
 
 namespace Ox {
-	Thread::~Thread(void) {
-		#ifdef OX_DISABLE_THREAD
-			return;
-		#elif defined(OX_USE_THREAD_STDCPP)
-			std::thread *t = (std::thread *)handle;
-			if(t != nullptr) {
-				t->join();
-				t->~thread();
-				t = nullptr;
+	static bool __ox_park(std::atomic<u32> *addr, u32 expected, long microseconds);
+	static void __ox_unpark(std::atomic<u32> *addr, u32 n);
+
+	#ifndef OX_DISABLE_THREAD
+		// Owned by the Thread until 'join', so the new thread never reads
+		// from a dead frame.
+		typedef struct __ox_thread_t {
+			Thread::callable_t f;
+			void *user;
+			// 0 while options are being applied, then 1 to run, 2 to bail.
+			std::atomic<u32> gate { 1 };
+
+			#ifdef OX_USE_THREAD_STDCPP
+				std::thread t;
+			#elif defined(OX_USE_THREAD_PTHREAD)
+				pthread_t t;
+			#else
+				#error "Well, this is awkward..."
+			#endif
+		} __ox_thread_t;
+
+		static void __ox_thread_main(__ox_thread_t *th) {
+			u32 g;
+			while((g = th->gate.load(std::memory_order_acquire)) == 0)
+				__ox_park(&th->gate, 0, -1);
+
+			if(g == 1)
+				th->f(th->user);
+		};
+	#endif
+
+	#ifdef OX_USE_THREAD_NATIVE
+		static int __ox_thread_pin(pthread_t t, int cpu, Ox::Error &err) {
+			#ifdef OX_USE_THREAD_AFFINITY
+				if(cpu < 0 || cpu >= CPU_SETSIZE) {
+					err = "'cpu' is out of range";
+					return -1;
+				}
+
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				CPU_SET(cpu, &set);
+
+				int rc = pthread_setaffinity_np(t, sizeof(set), &set);
+				if(rc != 0) {
+					err.from_fmt("Couldn't pin the thread to CPU %i: %s", cpu, std::strerror(rc));
+					err.from_c("Couldn't pin the thread");
+					return -1;
+				}
+
+				return 0;
+			#else
+				(void)t; (void)cpu;
+				err = "CPU pinning isn't supported on this platform";
+				return -1;
+			#endif
+		};
+
+		static int __ox_thread_name(pthread_t t, const char *name, Ox::Error &err) {
+			if(name == nullptr) {
+				err = "'name' is NULL";
+				return -1;
 			}
-		#elif defined(OX_USE_THREAD_PTHREAD)
-			pthread_t *t = (pthread_t *)handle;
-			if(t == nullptr)
-				return;
 
-			pthread_cancel(*t);
-			handle = nullptr;
-		#else
-			#error "Well, this is awkward..."
-		#endif
+			#ifdef OX_OS_LINUX
+				// Linux refuses anything longer than 15 characters.
+				char truncated[16];
+				std::strncpy(truncated, name, 15);
+				truncated[15] = '\0';
+
+				int rc = pthread_setname_np(t, truncated);
+				if(rc != 0) {
+					err.from_fmt("Couldn't name the thread: %s", std::strerror(rc));
+					err.from_c("Couldn't name the thread");
+					return -1;
+				}
+
+				return 0;
+			#else
+				(void)t;
+				err = "Thread naming isn't supported on this platform";
+				return -1;
+			#endif
+		};
+
+		static int __ox_thread_sched(pthread_t t, Thread::sched_t policy, int priority, Ox::Error &err) {
+			int p;
+
+			switch(policy) {
+				case Thread::sched_normal: p = SCHED_OTHER; break;
+				#ifdef SCHED_BATCH
+					case Thread::sched_batch: p = SCHED_BATCH; break;
+				#endif
+				#ifdef SCHED_IDLE
+					case Thread::sched_idle: p = SCHED_IDLE; break;
+				#endif
+				case Thread::sched_fifo: p = SCHED_FIFO; break;
+				case Thread::sched_rr: p = SCHED_RR; break;
+				default:
+					err = "Scheduling policy isn't supported on this platform";
+					return -1;
+			};
+
+			struct sched_param param;
+			std::memset(&param, 0, sizeof(param));
+
+			if(policy == Thread::sched_fifo || policy == Thread::sched_rr) {
+				if(priority < sched_get_priority_min(p) || priority > sched_get_priority_max(p)) {
+					err = "'priority' is out of range for this policy";
+					return -1;
+				}
+
+				param.sched_priority = priority;
+			}
+
+			int rc = pthread_setschedparam(t, p, &param);
+			if(rc != 0) {
+				err.from_fmt("Couldn't set the scheduling policy: %s", std::strerror(rc));
+				err.from_c("Couldn't set the scheduling policy");
+				return -1;
+			}
+
+			return 0;
+		};
+
+		static int __ox_thread_apply(pthread_t t, const Thread::options_t &options, Ox::Error &err) {
+			if(options.cpu >= 0 && __ox_thread_pin(t, options.cpu, err) != 0)
+				return -1;
+			if(options.name != nullptr && __ox_thread_name(t, options.name, err) != 0)
+				return -1;
+			if(options.policy != Thread::sched_normal && __ox_thread_sched(t, options.policy, options.priority, err) != 0)
+				return -1;
+
+			return 0;
+		};
+	#endif
+
+	Thread::~Thread(void) {
+		join();
 	};
 
 	int Thread::init(Ox::Error &err, callable_t f, void *user) {
+		options_t options;
+		return init(err, f, user, options);
+	};
+
+	int Thread::init(Ox::Error &err, callable_t f, void *user, const options_t &options) {
 		if(err != nullptr)
 			return -1;
 
 		if(handle != nullptr) {
-			err = "You can't a thread again";
+			err = "You can't init a thread again";
+			return -1;
+		}
+
+		if(f == nullptr) {
+			err = "'f' is NULL";
 			return -1;
 		}
 
 		#ifdef OX_DISABLE_THREAD
-			(void)err; (void)f; (void)user;
+			(void)user; (void)options;
 			err = "Flag OX_DISABLE_THREAD is set";
 			return -1;
-		#elif defined(OX_USE_THREAD_STDCPP)
-			std::thread *t = Ox::inhale<std::thread>(err);
-			if(t == nullptr)
+		#else
+			bool custom = options.cpu >= 0 || options.name != nullptr || options.policy != sched_normal;
+
+			#ifndef OX_USE_THREAD_NATIVE
+				if(custom) {
+					err = "Thread options aren't supported on this platform";
+					return -1;
+				}
+			#endif
+
+			#ifdef OX_USE_THREAD_STDCPP
+				if(options.stack_size > 0) {
+					err = "Option 'stack_size' needs the pthread backend";
+					return -1;
+				}
+			#endif
+
+			__ox_thread_t *th = Ox::inhale<__ox_thread_t>(err);
+			if(th == nullptr)
 				return -1;
 
 			// I hate this...
-			new (t) std::thread(f, user);
+			new (th) __ox_thread_t();
+			th->f = f;
+			th->user = user;
+			th->gate.store(custom ? 0 : 1, std::memory_order_relaxed);
 
-			handle = t;
+			#ifdef OX_USE_THREAD_STDCPP
+				new (&th->t) std::thread(__ox_thread_main, th);
+				#ifdef OX_USE_THREAD_NATIVE
+					pthread_t native = th->t.native_handle();
+				#endif
+			#elif defined(OX_USE_THREAD_PTHREAD)
+				pthread_attr_t attr;
+				pthread_attr_init(&attr);
 
-			return 0;
-		#elif defined(OX_USE_THREAD_PTHREAD)
-			struct __thread_user_s {
-				callable_t f;
-				void *user;
-			};
+				int rc = options.stack_size > 0 ? pthread_attr_setstacksize(&attr, options.stack_size) : 0;
+				if(rc != 0) {
+					pthread_attr_destroy(&attr);
+					th->~__ox_thread_t();
+					Ox::exhale(th);
 
-			__thread_user_s q;
-			q.f = f;
-			q.user = user;
+					err.from_fmt("Invalid stack size %lu: %s", options.stack_size, std::strerror(rc));
+					err.from_c("Invalid stack size");
+					return -1;
+				}
 
-			pthread_t t;
+				rc = pthread_create(&th->t, &attr, [](void *p) -> void * {
+					__ox_thread_main((__ox_thread_t *)p);
+					return nullptr;
+				}, th);
 
-			int rc = pthread_create(&t, nullptr, [](void *qp) -> void * {
-				__thread_user_s q = *(__thread_user_s *)qp;
-				q.f(q.user);
-				return nullptr;
-			}, &q);
+				pthread_attr_destroy(&attr);
 
-			if(rc != 0) {
-				err = "pthread error";	// [TODO] : Improve error message.
-				return -1;
-			}
-			handle = (void *)t;
+				if(rc != 0) {
+					th->~__ox_thread_t();
+					Ox::exhale(th);
+
+					err.from_fmt("Couldn't create the thread: %s", std::strerror(rc));
+					err.from_c("Couldn't create the thread");
+					return -1;
+				}
+
+				pthread_t native = th->t;
+			#else
+				#error "Well, this is awkward..."
+			#endif
+
+			handle = th;
 
-			pthread_detach(*(pthread_t *)handle);
+			#ifdef OX_USE_THREAD_NATIVE
+				if(custom) {
+					// The thread is held at the gate until it's set up.
+					int rc = __ox_thread_apply(native, options, err);
+
+					th->gate.store(rc == 0 ? 1 : 2, std::memory_order_release);
+					__ox_unpark(&th->gate, 1);
+
+					if(rc != 0) {
+						join();
+						return -1;
+					}
+				}
+			#endif
 
 			return 0;
-		#else
-			#error "Well, this is awkward..."
 		#endif
 	};
 
 	void Thread::join(void) {
 		#ifdef OX_DISABLE_THREAD
 			return;
-		#elif defined(OX_USE_THREAD_STDCPP)
-			std::thread *t = (std::thread *)handle;
-			if(t != nullptr) {
-				t->join();
-				t->~thread();
-				handle = t = nullptr;
-			}
-		#elif defined(OX_USE_THREAD_PTHREAD)
-			pthread_t *t = (pthread_t *)handle;
-			if(t == nullptr)
+		#else
+			__ox_thread_t *th = (__ox_thread_t *)handle;
+			if(th == nullptr)
 				return;
 
-			pthread_join(*t, nullptr);
-			Ox::exhale(t);
+			#ifdef OX_USE_THREAD_STDCPP
+				th->t.join();
+			#elif defined(OX_USE_THREAD_PTHREAD)
+				pthread_join(th->t, nullptr);
+			#else
+				#error "Well, this is awkward..."
+			#endif
+
+			th->~__ox_thread_t();
+			Ox::exhale(th);
 			handle = nullptr;
+		#endif
+	};
+
+	int Thread::pin(int cpu, Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		#ifdef OX_USE_THREAD_NATIVE
+			return __ox_thread_pin(pthread_self(), cpu, err);
 		#else
-			#error "Well, this is awkward..."
+			(void)cpu;
+			err = "CPU pinning isn't supported on this platform";
+			return -1;
+		#endif
+	};
+
+	int Thread::set_name(const char *name, Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		#ifdef OX_USE_THREAD_NATIVE
+			return __ox_thread_name(pthread_self(), name, err);
+		#else
+			(void)name;
+			err = "Thread naming isn't supported on this platform";
+			return -1;
 		#endif
 	};
 
@@ -151,7 +384,7 @@ namespace Ox {
 			std::size_t id_hash = std::hash<std::thread::id>{}(t_id);
 			return (Ox::pointer_t)id_hash;
 		#elif defined(OX_USE_THREAD_PTHREAD)
-			return pthread_self();
+			return (Ox::pointer_t)pthread_self();
 		#else
 			#error "Well, this is awkward..."
 		#endif
@@ -160,174 +393,632 @@ namespace Ox {
 	int Thread::hint_hardware_concurrency(void) {
 		#ifdef OX_DISABLE_THREAD
 			return -1;
+		#else
+			#ifdef OX_USE_THREAD_AFFINITY
+				cpu_set_t set;
+				if(sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) > 0)
+					return CPU_COUNT(&set);
+			#endif
+
+			#if defined(OX_USE_THREAD_STDCPP)
+				int n = (int)std::thread::hardware_concurrency();
+			#elif defined(OX_USE_THREAD_PTHREAD)
+				int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+			#else
+				#error "Well, this is awkward..."
+			#endif
+
+			return n > 0 ? n : 1;
+		#endif
+	};
+
+	void Thread::yield(void) {
+		#ifdef OX_DISABLE_THREAD
+			return;
 		#elif defined(OX_USE_THREAD_STDCPP)
-			return std::thread::hardware_concurrency();
+			std::this_thread::yield();
 		#elif defined(OX_USE_THREAD_PTHREAD)
-			return 1;	// [TODO] : Well, this sucks.
+			sched_yield();
 		#else
 			#error "Well, this is awkward..."
 		#endif
 	};
 
-	Mutex::Mutex(void) {
+	void Thread::sleep(ulong microseconds) {
 		#ifdef OX_DISABLE_THREAD
+			(void)microseconds;
 			return;
 		#elif defined(OX_USE_THREAD_STDCPP)
-			Ox::Error err;
+			std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
+		#elif defined(OX_USE_THREAD_PTHREAD)
+			struct timespec ts;
+			ts.tv_sec = microseconds / 1000000;
+			ts.tv_nsec = (microseconds % 1000000) * 1000;
 
-			std::mutex *m = Ox::inhale<std::mutex>(err);
-			handle = m;
+			while(nanosleep(&ts, &ts) != 0 && errno == EINTR) {};
+		#else
+			#error "Well, this is awkward..."
+		#endif
+	};
 
-			if(m == nullptr)
-				return;
+	static u64 __ox_now_ns(void) {
+		return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	};
 
-			// I hate this...
-			new (m) std::mutex();
+	// Microseconds left before 'deadline', negative meaning "no deadline"
+	// and 0 "time is up".
+	static long __ox_remaining_us(u64 deadline) {
+		if(deadline == 0)
+			return -1;
+
+		u64 now = __ox_now_ns();
+		return now >= deadline ? 0 : (long)((deadline - now + 999) / 1000);
+	};
+
+	static u64 __ox_deadline(long microseconds) {
+		return microseconds < 0 ? 0 : __ox_now_ns() + (u64)microseconds * 1000;
+	};
+
+	#if !defined(OX_DISABLE_THREAD) && !defined(OX_USE_THREAD_FUTEX)
+		// Without futex, waiters sleep on one of a few condition variables
+		// picked from the word's address; wakeups broadcast to the bucket.
+		typedef struct __ox_park_bucket_t {
+			#ifdef OX_USE_THREAD_STDCPP
+				std::mutex m;
+				std::condition_variable cv;
+			#elif defined(OX_USE_THREAD_PTHREAD)
+				pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;
+				pthread_cond_t cv = PTHREAD_COND_INITIALIZER;
+			#else
+				#error "Well, this is awkward..."
+			#endif
+		} __ox_park_bucket_t;
+
+		static __ox_park_bucket_t &__ox_park_bucket(std::atomic<u32> *addr) {
+			static __ox_park_bucket_t buckets[64];
+			return buckets[((pointer_t)addr >> 4) % 64];
+		};
+	#endif
+
+	// Blocks while '*addr == expected', at most 'microseconds' unless
+	// negative. Returns false once the time is up; wakeups can be spurious.
+	static bool __ox_park(std::atomic<u32> *addr, u32 expected, long microseconds) {
+		#ifdef OX_DISABLE_THREAD
+			(void)addr; (void)expected; (void)microseconds;
+			return false;
+		#elif defined(OX_USE_THREAD_FUTEX)
+			struct timespec ts;
+			struct timespec *tp = nullptr;
+
+			if(microseconds >= 0) {
+				ts.tv_sec = microseconds / 1000000;
+				ts.tv_nsec = (microseconds % 1000000) * 1000;
+				tp = &ts;
+			}
+
+			long rc = syscall(SYS_futex, (u32 *)addr, FUTEX_WAIT_PRIVATE, expected, tp, nullptr, 0);
+			return rc == 0 || errno != ETIMEDOUT;
+		#elif defined(OX_USE_THREAD_STDCPP)
+			__ox_park_bucket_t &b = __ox_park_bucket(addr);
+			std::unique_lock<std::mutex> lock(b.m);
+
+			if(addr->load(std::memory_order_acquire) != expected)
+				return true;
+
+			if(microseconds < 0) {
+				b.cv.wait(lock);
+				return true;
+			}
+
+			return b.cv.wait_for(lock, std::chrono::microseconds(microseconds)) == std::cv_status::no_timeout;
 		#elif defined(OX_USE_THREAD_PTHREAD)
-			pthread_mutex_init((pthread_mutex_t *)handle, nullptr);
+			__ox_park_bucket_t &b = __ox_park_bucket(addr);
+			bool ok = true;
+
+			pthread_mutex_lock(&b.m);
+
+			if(addr->load(std::memory_order_acquire) == expected) {
+				if(microseconds < 0) {
+					pthread_cond_wait(&b.cv, &b.m);
+				} else {
+					struct timespec ts;
+					clock_gettime(CLOCK_REALTIME, &ts);
+
+					ts.tv_sec += microseconds / 1000000;
+					ts.tv_nsec += (microseconds % 1000000) * 1000;
+					if(ts.tv_nsec >= 1000000000) {
+						ts.tv_sec++;
+						ts.tv_nsec -= 1000000000;
+					}
+
+					ok = pthread_cond_timedwait(&b.cv, &b.m, &ts) == 0;
+				}
+			}
+
+			pthread_mutex_unlock(&b.m);
+			return ok;
 		#else
 			#error "Well, this is awkward..."
 		#endif
 	};
 
-	Mutex::~Mutex(void) {
+	// Wakes up to 'n' threads parked on 'addr'.
+	static void __ox_unpark(std::atomic<u32> *addr, u32 n) {
 		#ifdef OX_DISABLE_THREAD
-			return;
+			(void)addr; (void)n;
+		#elif defined(OX_USE_THREAD_FUTEX)
+			syscall(SYS_futex, (u32 *)addr, FUTEX_WAKE_PRIVATE, n > INT_MAX ? INT_MAX : (int)n, nullptr, nullptr, 0);
 		#elif defined(OX_USE_THREAD_STDCPP)
-			std::mutex *m = (std::mutex *)handle;
-			if(m == nullptr)
-				return;
+			(void)n;
+			__ox_park_bucket_t &b = __ox_park_bucket(addr);
 
-			m->~mutex();
+			// Taking the lock orders us after any waiter that saw the old value.
+			b.m.lock();
+			b.m.unlock();
+			b.cv.notify_all();
 		#elif defined(OX_USE_THREAD_PTHREAD)
-			pthread_mutex_t *m = (pthread_mutex_t *)handle;
-			if(m != nullptr)
-				pthread_mutex_destroy(m);
+			(void)n;
+			__ox_park_bucket_t &b = __ox_park_bucket(addr);
+
+			pthread_mutex_lock(&b.m);
+			pthread_mutex_unlock(&b.m);
+			pthread_cond_broadcast(&b.cv);
 		#else
 			#error "Well, this is awkward..."
 		#endif
 	};
 
-	bool Mutex::try_lock(Ox::Error &err) {
+	static const u32 __ox_unpark_all = 0xffffffff;
+
+	static bool __ox_can_park(Ox::Error &err) {
 		if(err != nullptr)
 			return false;
-		if(handle == nullptr) {
-			err = "Unitialized Mutex";
-			return false;
-		}
 
 		#ifdef OX_DISABLE_THREAD
 			err = "Flag OX_DISABLE_THREAD is set";
 			return false;
-		#elif defined(OX_USE_THREAD_STDCPP)
-			std::mutex *m = (std::mutex *)handle;
-			bool rc = m->try_lock();
-			Ox::pointer_t id_self = Thread::get_id();
+		#else
+			return true;
+		#endif
+	};
 
-			if(rc)
-				owner = id_self;
-			if(rc == false && owner == id_self)
-				rc = true;
+	int CondVar::block(Mutex &m, long microseconds, Ox::Error &err) {
+		if(!__ox_can_park(err))
+			return -1;
 
-			return rc;
-		#elif defined(OX_USE_THREAD_PTHREAD)
-			pthread_mutex_t *m = (pthread_mutex_t *)handle;
-			int rc = pthread_mutex_trylock(m);
-			Ox::pointer_t id_self = Thread::get_id();
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+		u32 s = seq.load(std::memory_order_seq_cst);
 
-			bool locked = rc == 0;
+		if(m.unlock(err) != 0) {
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+			return -1;
+		}
 
-			if(locked)
-				owner = id_self;
-			if(locked == false && owner == id_self)
-				locked = true;
+		u64 t0 = __ox_now_ns();
+		bool ok = __ox_park(&seq, s, microseconds);
+		Stats::__wait_hook(Stats::wait_condvar, __ox_now_ns() - t0, !ok);
 
-			return locked;
-		#else
-			#error "Well, this is awkward..."
-		#endif
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+
+		if(m.lock(err) != 0)
+			return -1;
+
+		return ok ? 0 : 1;
 	};
 
-	int Mutex::lock(Ox::Error &err) {
+	int CondVar::wait(Mutex &m, Ox::Error &err) {
+		return block(m, -1, err);
+	};
+
+	int CondVar::wait_for(Mutex &m, ulong microseconds, Ox::Error &err) {
+		return block(m, (long)microseconds, err);
+	};
+
+	void CondVar::notify_one(void) {
+		seq.fetch_add(1, std::memory_order_seq_cst);
+		if(waiters.load(std::memory_order_seq_cst) > 0)
+			__ox_unpark(&seq, 1);
+	};
+
+	void CondVar::notify_all(void) {
+		seq.fetch_add(1, std::memory_order_seq_cst);
+		if(waiters.load(std::memory_order_seq_cst) > 0)
+			__ox_unpark(&seq, __ox_unpark_all);
+	};
+
+	bool Semaphore::try_acquire(void) {
+		u32 c = count.load(std::memory_order_relaxed);
+
+		while(c > 0)
+			if(count.compare_exchange_weak(c, c - 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+
+		return false;
+	};
+
+	int Semaphore::block(long microseconds, Ox::Error &err) {
 		if(err != nullptr)
 			return -1;
-		if(handle == nullptr) {
-			err = "Unitialized Mutex";
+
+		if(try_acquire())
+			return 0;
+
+		if(!__ox_can_park(err))
 			return -1;
+
+		u64 t0 = __ox_now_ns();
+		u64 deadline = __ox_deadline(microseconds);
+		int rc = 0;
+
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+
+		while(try_acquire() == false) {
+			long left = __ox_remaining_us(deadline);
+			if(left == 0) {
+				rc = 1;
+				break;
+			}
+
+			__ox_park(&count, 0, left);
+		};
+
+		waiters.fetch_sub(1, std::memory_order_relaxed);
+		Stats::__wait_hook(Stats::wait_semaphore, __ox_now_ns() - t0, rc == 1);
+
+		return rc;
+	};
+
+	int Semaphore::acquire(Ox::Error &err) {
+		return block(-1, err);
+	};
+
+	int Semaphore::acquire_for(ulong microseconds, Ox::Error &err) {
+		return block((long)microseconds, err);
+	};
+
+	void Semaphore::release(u32 n) {
+		count.fetch_add(n, std::memory_order_seq_cst);
+		if(waiters.load(std::memory_order_seq_cst) > 0)
+			__ox_unpark(&count, n);
+	};
+
+	void Latch::count_down(u32 n) {
+		if(count.fetch_sub(n, std::memory_order_acq_rel) == n)
+			__ox_unpark(&count, __ox_unpark_all);
+	};
+
+	bool Latch::try_wait(void) {
+		return count.load(std::memory_order_acquire) == 0;
+	};
+
+	int Latch::wait(Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		u32 c = count.load(std::memory_order_acquire);
+		if(c == 0)
+			return 0;
+
+		if(!__ox_can_park(err))
+			return -1;
+
+		u64 t0 = __ox_now_ns();
+
+		for(; c != 0; c = count.load(std::memory_order_acquire))
+			__ox_park(&count, c, -1);
+
+		Stats::__wait_hook(Stats::wait_latch, __ox_now_ns() - t0, false);
+		return 0;
+	};
+
+	int Barrier::arrive_and_wait(Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		u32 g = generation.load(std::memory_order_acquire);
+
+		if(arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == parties) {
+			// Reset before the next round can start, see the acquire above.
+			arrived.store(0, std::memory_order_relaxed);
+			generation.fetch_add(1, std::memory_order_release);
+			__ox_unpark(&generation, __ox_unpark_all);
+			return 1;
 		}
 
-		#ifdef OX_DISABLE_THREAD
-			err = "Flag OX_DISABLE_THREAD is set";
+		if(!__ox_can_park(err))
+			return -1;
+
+		u64 t0 = __ox_now_ns();
+
+		while(generation.load(std::memory_order_acquire) == g)
+			__ox_park(&generation, g, -1);
+
+		Stats::__wait_hook(Stats::wait_barrier, __ox_now_ns() - t0, false);
+		return 0;
+	};
+
+	void Event::set(void) {
+		state.store(1, std::memory_order_release);
+		__ox_unpark(&state, auto_reset ? 1 : __ox_unpark_all);
+	};
+
+	void Event::reset(void) {
+		state.store(0, std::memory_order_relaxed);
+	};
+
+	bool Event::is_set(void) {
+		return state.load(std::memory_order_acquire) != 0;
+	};
+
+	int Event::block(long microseconds, Ox::Error &err) {
+		if(err != nullptr)
 			return -1;
-		#elif defined(OX_USE_THREAD_STDCPP)
-			Ox::pointer_t id_self = Thread::get_id();
-			if(owner != id_self) {
-				err = "Not mutex current owner or already unlocked";
-				return -1;
-			}
 
-			std::mutex *m = (std::mutex *)handle;
-			m->lock();
-			owner = id_self;
+		// An auto-reset event is consumed by whoever flips it back.
+		auto take = [this](void) -> bool {
+			if(auto_reset == false)
+				return state.load(std::memory_order_acquire) != 0;
 
+			u32 one = 1;
+			return state.compare_exchange_strong(one, 0, std::memory_order_acquire, std::memory_order_relaxed);
+		};
+
+		if(take())
 			return 0;
-		#elif defined(OX_USE_THREAD_PTHREAD)
-			Ox::pointer_t id_self = Thread::get_id();
-			if(owner != id_self) {
-				err = "Not mutex current owner or already unlocked";
-				return -1;
+
+		if(!__ox_can_park(err))
+			return -1;
+
+		u64 t0 = __ox_now_ns();
+		u64 deadline = __ox_deadline(microseconds);
+		int rc = 0;
+
+		while(take() == false) {
+			long left = __ox_remaining_us(deadline);
+			if(left == 0) {
+				rc = 1;
+				break;
 			}
 
-			pthread_mutex_t *m = (pthread_mutex_t *)handle;
-			if(pthread_mutex_lock(m) == 0) {
-				owner = id_self;
-				return 0;
+			__ox_park(&state, 0, left);
+		};
+
+		Stats::__wait_hook(Stats::wait_event, __ox_now_ns() - t0, rc == 1);
+		return rc;
+	};
+
+	int Event::wait(Ox::Error &err) {
+		return block(-1, err);
+	};
+
+	int Event::wait_for(ulong microseconds, Ox::Error &err) {
+		return block((long)microseconds, err);
+	};
+
+	// Only compared against, so the address of a thread_local will do.
+	static thread_local char __ox_self_token;
+
+	static Ox::pointer_t __ox_self(void) {
+		return (Ox::pointer_t)&__ox_self_token;
+	};
+
+	// Spinning on a single core only delays whoever holds the lock.
+	static u32 __ox_max_spin(void) {
+		static const u32 max_spin = Thread::hint_hardware_concurrency() > 1 ? 100 : 0;
+		return max_spin;
+	};
+
+	bool Mutex::try_lock(Ox::Error &err) {
+		if(err != nullptr)
+			return false;
+
+		#ifdef OX_DISABLE_THREAD
+			err = "Flag OX_DISABLE_THREAD is set";
+			return false;
+		#else
+			Ox::pointer_t self = __ox_self();
+			u32 c = 0;
+
+			if(state.compare_exchange_strong(c, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				owner.store(self, order_relaxed);
+				return true;
+			}
+
+			return owner.load(order_relaxed) == self;
+		#endif
+	};
+
+	void Mutex::block(void) {
+		Stats::__contended_hook(Stats::wait_mutex);
+
+		u32 limit = __ox_max_spin();
+		u32 estimate = spin.load(std::memory_order_relaxed);
+		if(limit > estimate * 2 + 10)
+			limit = estimate * 2 + 10;
+
+		u32 i = 0;
+		for(; i < limit; i++) {
+			Thread::relax();
+
+			u32 c = 0;
+			if(state.load(std::memory_order_relaxed) == 0
+				&& state.compare_exchange_weak(c, 1, std::memory_order_acquire, std::memory_order_relaxed)
+			) {
+				spin.store(estimate + ((int)i - (int)estimate) / 8, std::memory_order_relaxed);
+				return;
 			}
+		};
+
+		if(limit > 0)
+			spin.store(estimate + ((int)limit - (int)estimate) / 8, std::memory_order_relaxed);
 
-			err = "pthread error";	// [TODO] : Improve error message.
+		// Marking it contended costs the next unlock a wake up, so only
+		// once spinning didn't work out.
+		u64 t0 = __ox_now_ns();
+		u32 c = state.exchange(2, std::memory_order_acquire);
+
+		while(c != 0) {
+			__ox_park(&state, 2, -1);
+			c = state.exchange(2, std::memory_order_acquire);
+		};
+
+		Stats::__wait_hook(Stats::wait_mutex, __ox_now_ns() - t0, false);
+	};
+
+	int Mutex::lock(Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		#ifdef OX_DISABLE_THREAD
+			err = "Flag OX_DISABLE_THREAD is set";
 			return -1;
 		#else
-			#error "Well, this is awkward..."
+			Ox::pointer_t self = __ox_self();
+			if(owner.load(order_relaxed) == self) {
+				err = "Mutex already locked by this thread";
+				return -1;
+			}
+
+			u32 c = 0;
+			if(!state.compare_exchange_strong(c, 1, std::memory_order_acquire, std::memory_order_relaxed))
+				block();
+
+			owner.store(self, order_relaxed);
+			return 0;
 		#endif
 	};
 
 	int Mutex::unlock(Ox::Error &err) {
 		if(err != nullptr)
 			return -1;
-		if(handle == nullptr) {
-			err = "Unitialized Mutex";
-			return -1;
-		}
 
 		#ifdef OX_DISABLE_THREAD
 			err = "Flag OX_DISABLE_THREAD is set";
 			return -1;
-		#elif defined(OX_USE_THREAD_STDCPP)
-			Ox::pointer_t id_self = Thread::get_id();
-			if(owner != id_self) {
+		#else
+			if(owner.load(order_relaxed) != __ox_self()) {
 				err = "Not mutex current owner or already unlocked";
 				return -1;
 			}
 
-			std::mutex *m = (std::mutex *)handle;
-			m->unlock();
-			owner = 0;
+			// Before unlocking, or it could clobber the next owner.
+			owner.store(0, order_relaxed);
+
+			if(state.exchange(0, std::memory_order_release) == 2)
+				__ox_unpark(&state, 1);
 
 			return 0;
-		#elif defined(OX_USE_THREAD_PTHREAD)
-			Ox::pointer_t id_self = Thread::get_id();
-			if(owner != id_self) {
-				err = "Not mutex current owner or already unlocked";
-				return -1;
+		#endif
+	};
+
+	bool RWLock::try_read_lock(void) {
+		u32 s = state.load(std::memory_order_relaxed);
+
+		while((s & writer) == 0 && writers_waiting.load(std::memory_order_relaxed) == 0)
+			if(state.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+
+		return false;
+	};
+
+	bool RWLock::try_write_lock(void) {
+		u32 s = 0;
+		return state.compare_exchange_strong(s, writer, std::memory_order_acquire, std::memory_order_relaxed);
+	};
+
+	int RWLock::read_lock(Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(try_read_lock())
+			return 0;
+
+		if(!__ox_can_park(err))
+			return -1;
+
+		Stats::__contended_hook(Stats::wait_rwlock_read);
+
+		for(u32 i = 0; i < __ox_max_spin(); i++) {
+			Thread::relax();
+			if(try_read_lock())
+				return 0;
+		};
+
+		u64 t0 = __ox_now_ns();
+		sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+		for(;;) {
+			u32 s = state.load(std::memory_order_seq_cst);
+
+			if((s & writer) == 0 && writers_waiting.load(std::memory_order_seq_cst) == 0) {
+				if(state.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+
+				continue;
 			}
 
-			pthread_mutex_t *m = (pthread_mutex_t *)handle;
-			pthread_mutex_unlock(m);
-			owner = 0;
+			__ox_park(&state, s, -1);
+		};
+
+		sleepers.fetch_sub(1, std::memory_order_relaxed);
+		Stats::__wait_hook(Stats::wait_rwlock_read, __ox_now_ns() - t0, false);
+
+		return 0;
+	};
+
+	void RWLock::read_unlock(void) {
+		// The last reader out lets a waiting writer in.
+		if(state.fetch_sub(1, std::memory_order_seq_cst) == 1 && sleepers.load(std::memory_order_seq_cst) > 0)
+			__ox_unpark(&state, __ox_unpark_all);
+	};
 
+	int RWLock::write_lock(Ox::Error &err) {
+		if(err != nullptr)
+			return -1;
+
+		if(try_write_lock())
 			return 0;
-		#else
-			#error "Well, this is awkward..."
-		#endif
+
+		if(!__ox_can_park(err))
+			return -1;
+
+		Stats::__contended_hook(Stats::wait_rwlock_write);
+
+		// From here on, readers stay out.
+		writers_waiting.fetch_add(1, std::memory_order_seq_cst);
+
+		bool done = false;
+		for(u32 i = 0; i < __ox_max_spin() && !done; i++) {
+			Thread::relax();
+			done = state.load(std::memory_order_relaxed) == 0 && try_write_lock();
+		};
+
+		if(!done) {
+			u64 t0 = __ox_now_ns();
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+			for(;;) {
+				u32 s = 0;
+				if(state.compare_exchange_weak(s, writer, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+
+				if(s != 0)
+					__ox_park(&state, s, -1);
+			};
+
+			sleepers.fetch_sub(1, std::memory_order_relaxed);
+			Stats::__wait_hook(Stats::wait_rwlock_write, __ox_now_ns() - t0, false);
+		}
+
+		writers_waiting.fetch_sub(1, std::memory_order_seq_cst);
+		return 0;
+	};
+
+	void RWLock::write_unlock(void) {
+		state.exchange(0, std::memory_order_seq_cst);
+
+		if(sleepers.load(std::memory_order_seq_cst) > 0)
+			__ox_unpark(&state, __ox_unpark_all);
 	};
 };
@@ -0,0 +1,205 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/threadlocal.hpp"
+#include "../include/core/thread.hpp"
+#include "../include/core/elastic.hpp"
+
+namespace Ox {
+	typedef struct __ox_tls_entry_t {
+		__ox_tls_key_t *key;
+		struct __ox_tls_table_t *table;
+		void *value;
+		__ox_tls_entry_t *prev;
+		__ox_tls_entry_t *next;
+	} __ox_tls_entry_t;
+
+	// Everything below is guarded by this lock. Lookups of a thread's own
+	// values skip it: only that thread grows its table, under the lock.
+	static RWLock __ox_tls_lock;
+	static uint __ox_tls_next_id = 0;
+
+	static Elastic<uint> &__ox_tls_free_ids(void) {
+		static Elastic<uint> ids;
+		return ids;
+	};
+
+	// Slots of the calling thread, indexed by key id. Built on first use,
+	// so threads that never touch a ThreadLocal don't pay for any of it.
+	typedef struct __ox_tls_table_t {
+		__ox_tls_entry_t **slots = nullptr;
+		uint capacity = 0;
+
+		void unlink(__ox_tls_entry_t *e) {
+			__ox_tls_key_t *key = e->key;
+
+			if(e->prev != nullptr)
+				e->prev->next = e->next;
+			else
+				key->entries = e->next;
+
+			if(e->next != nullptr)
+				e->next->prev = e->prev;
+
+			key->count--;
+			slots[key->id] = nullptr;
+		};
+
+		// Drops one entry, the lock being held for writing.
+		static void release(__ox_tls_entry_t *e) {
+			e->table->unlink(e);
+			e->key->drop(e->key->owner, e->value);
+			exhale(e);
+		};
+
+		~__ox_tls_table_t(void) {
+			if(slots == nullptr)
+				return;
+
+			Error err;
+			__ox_tls_lock.write_lock(err);
+
+			for(uint i = 0; i < capacity; i++)
+				if(slots[i] != nullptr)
+					release(slots[i]);
+
+			__ox_tls_lock.write_unlock();
+
+			exhale(slots);
+			slots = nullptr;
+			capacity = 0;
+		};
+	} __ox_tls_table_t;
+
+	static thread_local __ox_tls_table_t __ox_tls_table;
+
+	__ox_tls_key_t::__ox_tls_key_t(void *o, make_t m, drop_t d, drop_t x) : owner(o), make(m), drop(d), discard(x) {
+		Error err;
+		ScopedAllocator heap(*HeapAllocator::instance());
+		__ox_tls_lock.write_lock(err);
+
+		Elastic<uint> &ids = __ox_tls_free_ids();
+		id = ids.is_empty() ? __ox_tls_next_id++ : ids.pop_end(err);
+
+		__ox_tls_lock.write_unlock();
+	};
+
+	__ox_tls_key_t::~__ox_tls_key_t(void) {
+		Error err;
+		__ox_tls_lock.write_lock(err);
+
+		while(entries != nullptr)
+			__ox_tls_table_t::release((__ox_tls_entry_t *)entries);
+
+		// Keeps the slot if the id can't be recycled, it's only a pointer.
+		ScopedAllocator heap(*HeapAllocator::instance());
+		(void)__ox_tls_free_ids().push_end(id, err);
+
+		__ox_tls_lock.write_unlock();
+	};
+
+	void *__ox_tls_key_t::peek(void) {
+		__ox_tls_table_t &t = __ox_tls_table;
+		if(id < t.capacity && t.slots[id] != nullptr)
+			return t.slots[id]->value;
+
+		return nullptr;
+	};
+
+	void *__ox_tls_key_t::get(Error &err) {
+		if(err != nullptr)
+			return nullptr;
+
+		__ox_tls_table_t &t = __ox_tls_table;
+		if(id < t.capacity && t.slots[id] != nullptr)
+			return t.slots[id]->value;
+
+		void *value = make(owner, err);
+		if(value == nullptr)
+			return nullptr;
+
+		ScopedAllocator heap(*HeapAllocator::instance());
+		OX_ALLOC_TAG("threadlocal");
+
+		__ox_tls_entry_t *e = inhale<__ox_tls_entry_t>(err);
+		// Never handed out, 'on_exit' has nothing to see.
+		if(e == nullptr) {
+			discard(owner, value);
+			return nullptr;
+		}
+
+		__ox_tls_lock.write_lock(err);
+
+		if(id >= t.capacity) {
+			uint capacity = t.capacity < 8 ? 8 : t.capacity;
+			while(capacity <= id)
+				capacity *= 2;
+
+			__ox_tls_entry_t **slots = t.slots == nullptr
+				? inhale<__ox_tls_entry_t *>(capacity, err)
+				: respire<__ox_tls_entry_t *>(t.slots, capacity, err);
+
+			if(slots == nullptr) {
+				__ox_tls_lock.write_unlock();
+				exhale(e);
+				discard(owner, value);
+				return nullptr;
+			}
+
+			for(uint i = t.capacity; i < capacity; i++)
+				slots[i] = nullptr;
+
+			t.slots = slots;
+			t.capacity = capacity;
+		}
+
+		e->key = this;
+		e->table = &t;
+		e->value = value;
+		e->prev = nullptr;
+		e->next = (__ox_tls_entry_t *)entries;
+
+		if(e->next != nullptr)
+			e->next->prev = e;
+
+		entries = e;
+		count++;
+		t.slots[id] = e;
+
+		__ox_tls_lock.write_unlock();
+		return value;
+	};
+
+	void __ox_tls_key_t::for_each(visit_t f, void *user) {
+		Error err;
+		__ox_tls_lock.read_lock(err);
+
+		for(__ox_tls_entry_t *e = (__ox_tls_entry_t *)entries; e != nullptr; e = e->next)
+			f(e->value, user);
+
+		__ox_tls_lock.read_unlock();
+	};
+
+	ulong __ox_tls_key_t::size(void) {
+		Error err;
+		__ox_tls_lock.read_lock(err);
+		ulong n = count;
+		__ox_tls_lock.read_unlock();
+
+		return n;
+	};
+};
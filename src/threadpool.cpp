@@ -0,0 +1,445 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "../include/core/threadpool.hpp"
+#include "../include/core/allocator.hpp"
+#include "../include/core/ring.hpp"
+#include <atomic>
+#include <new>
+
+namespace Ox {
+	// Chase-Lev deque ("Dynamic Circular Work-Stealing Deque", with the C11
+	// orderings from Lê et al.), fixed size: a full deque runs tasks inline.
+	typedef struct __ox_deque_t {
+		static const long capacity = 1024;
+
+		std::atomic<long> top { 0 };
+		char pad_top[OX_CACHE_LINE - sizeof(std::atomic<long>)];
+		std::atomic<long> bottom { 0 };
+		char pad_bottom[OX_CACHE_LINE - sizeof(std::atomic<long>)];
+
+		std::atomic<__ox_task_t *> slots[capacity];
+
+		// Owner only.
+		bool push(__ox_task_t *task) {
+			long b = bottom.load(std::memory_order_relaxed);
+			long t = top.load(std::memory_order_acquire);
+			if(b - t >= capacity)
+				return false;
+
+			slots[b & (capacity - 1)].store(task, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+
+			return true;
+		};
+
+		// Owner only, newest first.
+		__ox_task_t *pop(void) {
+			long b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long t = top.load(std::memory_order_relaxed);
+
+			if(t > b) {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			__ox_task_t *task = slots[b & (capacity - 1)].load(std::memory_order_relaxed);
+
+			// Last one: race the thieves for it.
+			if(t == b) {
+				if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					task = nullptr;
+
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+
+			return task;
+		};
+
+		// Anyone, oldest first.
+		__ox_task_t *steal(void) {
+			long t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long b = bottom.load(std::memory_order_acquire);
+
+			if(t >= b)
+				return nullptr;
+
+			__ox_task_t *task = slots[t & (capacity - 1)].load(std::memory_order_relaxed);
+			if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+
+			return task;
+		};
+	} __ox_deque_t;
+
+	typedef struct __ox_threadpool_t __ox_threadpool_t;
+
+	typedef struct __ox_worker_t {
+		__ox_deque_t deque;
+		__ox_threadpool_t *pool = nullptr;
+		u64 rng = 0;
+	} __ox_worker_t;
+
+	typedef struct __ox_threadpool_t {
+		Thread *threads = nullptr;
+		__ox_worker_t *workers = nullptr;
+		// Deques to steal from, set before any worker starts.
+		int num_threads = 0;
+		int num_started = 0;
+
+		// Tasks spawned from threads that aren't workers.
+		MPMCRing<__ox_task_t *> inbox;
+		std::atomic<bool> quit { false };
+
+		// Idle workers park here, new tasks wake one of them.
+		Semaphore wake;
+		std::atomic<int> sleepers { 0 };
+	} __ox_threadpool_t;
+
+	static thread_local __ox_worker_t *__ox_current_worker = nullptr;
+
+	__ox_task_t *__ox_task_alloc(ulong payload, Error &err) {
+		if(err != nullptr)
+			return nullptr;
+
+		const char *e = nullptr;
+		__ox_task_t *task = (__ox_task_t *)PoolAllocator::instance()->alloc(sizeof(__ox_task_t) + payload, false, &e);
+		if(task == nullptr) {
+			err = e;
+			return nullptr;
+		}
+
+		task->run = nullptr;
+		task->group = nullptr;
+		task->f = nullptr;
+		task->user = nullptr;
+		task->size = sizeof(__ox_task_t) + payload;
+
+		return task;
+	};
+
+	void __ox_task_free(__ox_task_t *task) {
+		PoolAllocator::instance()->free(task, task->size);
+	};
+
+	void __ox_task_done(__ox_task_t *task) {
+		TaskGroup *group = task->group;
+
+		task->run(task);
+		__ox_task_free(task);
+
+		group->pending.fetch_sub(1, std::memory_order_acq_rel);
+	};
+
+	// Runs one task if any can be found, as seen from 'self' (NULL when not
+	// a worker of 'p').
+	static bool __ox_threadpool_help(__ox_threadpool_t *p, __ox_worker_t *self) {
+		__ox_task_t *task = nullptr;
+
+		if(self != nullptr)
+			task = self->deque.pop();
+
+		if(task == nullptr)
+			(void)p->inbox.pop(task);
+
+		if(task == nullptr && p->num_threads > 0) {
+			u64 r = self != nullptr ? self->rng : (u64)(pointer_t)&task;
+			r ^= r << 13;
+			r ^= r >> 7;
+			r ^= r << 17;
+			if(self != nullptr)
+				self->rng = r;
+
+			int start = (int)(r % (u64)p->num_threads);
+			for(int i = 0; i < p->num_threads && task == nullptr; i++) {
+				__ox_worker_t *victim = &p->workers[(start + i) % p->num_threads];
+				if(victim != self)
+					task = victim->deque.steal();
+			};
+		}
+
+		if(task == nullptr)
+			return false;
+
+		__ox_task_done(task);
+		return true;
+	};
+
+	// After pushing a task. Pairs with the fence in '__ox_threadpool_park':
+	// either the sleeper sees the task or we see the sleeper.
+	static void __ox_threadpool_notify(__ox_threadpool_t *p) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(p->sleepers.load(std::memory_order_relaxed) > 0)
+			p->wake.release();
+	};
+
+	// Blocks until some task shows up or the pool quits. False if a task
+	// was found and run instead.
+	static bool __ox_threadpool_park(__ox_threadpool_t *p, __ox_worker_t *self) {
+		p->sleepers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		// Anything pushed before we showed up as a sleeper.
+		bool ran = __ox_threadpool_help(p, self);
+
+		if(ran == false && p->quit.load(std::memory_order_acquire) == false) {
+			Error meh;
+			if(p->wake.acquire(meh) != 0)
+				Thread::sleep(100);
+		}
+
+		p->sleepers.fetch_sub(1, std::memory_order_relaxed);
+		return !ran;
+	};
+
+	// Spins, then yields, then parks: idle workers shouldn't eat a core.
+	static void __ox_threadpool_backoff(__ox_threadpool_t *p, __ox_worker_t *self, uint &idle) {
+		if(idle < 64) {
+			idle++;
+		} else if(idle < 128) {
+			idle++;
+			Thread::yield();
+		} else if(__ox_threadpool_park(p, self) == false) {
+			idle = 0;
+		}
+	};
+
+	static void __ox_threadpool_worker(void *user) {
+		__ox_worker_t *self = (__ox_worker_t *)user;
+		__ox_threadpool_t *p = self->pool;
+		__ox_current_worker = self;
+
+		uint idle = 0;
+
+		while(p->quit.load(std::memory_order_acquire) == false) {
+			if(__ox_threadpool_help(p, self))
+				idle = 0;
+			else
+				__ox_threadpool_backoff(p, self, idle);
+		};
+
+		__ox_current_worker = nullptr;
+	};
+
+	void TaskGroup::submit(__ox_task_t *task) {
+		task->group = this;
+		pending.fetch_add(1, std::memory_order_relaxed);
+
+		__ox_threadpool_t *p = (__ox_threadpool_t *)pool->handle;
+		__ox_worker_t *self = __ox_current_worker;
+
+		bool queued = false;
+		if(p != nullptr && p->num_started > 0) {
+			if(self != nullptr && self->pool == p)
+				queued = self->deque.push(task);
+			else
+				queued = p->inbox.push(task);
+		}
+
+		if(queued)
+			__ox_threadpool_notify(p);
+		else
+			__ox_task_done(task);
+	};
+
+	int TaskGroup::spawn(Ox::Error &err, ThreadPool::task_t f, void *user) {
+		if(err != nullptr)
+			return -1;
+
+		if(f == nullptr) {
+			err = "'f' is NULL";
+			return -1;
+		}
+
+		__ox_task_t *task = __ox_task_alloc(0, err);
+		if(task == nullptr) {
+			err.clear();
+			f(user);
+			return 0;
+		}
+
+		task->f = f;
+		task->user = user;
+		task->run = [](__ox_task_t *self) {
+			self->f(self->user);
+		};
+
+		submit(task);
+		return 0;
+	};
+
+	void TaskGroup::wait(void) {
+		__ox_threadpool_t *p = (__ox_threadpool_t *)pool->handle;
+		__ox_worker_t *self = __ox_current_worker;
+		if(self != nullptr && self->pool != p)
+			self = nullptr;
+
+		uint idle = 0;
+		while(pending.load(std::memory_order_acquire) > 0) {
+			if(p != nullptr && __ox_threadpool_help(p, self)) {
+				idle = 0;
+				continue;
+			}
+
+			// Whatever is left is running elsewhere and finishes soon.
+			if(idle < 64)
+				idle++;
+			else
+				Thread::yield();
+		};
+	};
+
+	TaskGroup::~TaskGroup(void) {
+		wait();
+	};
+
+	ThreadPool::~ThreadPool(void) {
+		release();
+	};
+
+	int ThreadPool::init(Ox::Error &err, int size) {
+		if(err != nullptr)
+			return -1;
+
+		if(handle != nullptr) {
+			err = "ThreadPool already initialized";
+			return -1;
+		}
+
+		if(size <= 0)
+			size = Thread::hint_hardware_concurrency();
+		if(size <= 0)
+			size = 1;
+
+		__ox_threadpool_t *p = inhale<__ox_threadpool_t>(err);
+		if(p == nullptr)
+			return -1;
+
+		new (p) __ox_threadpool_t();
+
+		if(size > 1) {
+			if(p->inbox.init(4096, err) != 0
+				|| (p->threads = inhale<Thread>(size - 1, err)) == nullptr
+				|| (p->workers = inhale<__ox_worker_t>(size - 1, err)) == nullptr
+			) {
+				if(p->threads != nullptr)
+					exhale(p->threads);
+
+				p->~__ox_threadpool_t();
+				exhale(p);
+				return -1;
+			}
+
+			for(int i = 0; i < size - 1; i++) {
+				new (&p->workers[i]) __ox_worker_t();
+				p->workers[i].pool = p;
+				p->workers[i].rng = 0x9e3779b97f4a7c15 * (i + 1);
+			};
+
+			// Set before any thread starts, workers read it unlocked.
+			p->num_threads = size - 1;
+
+			// Whatever started is still useful, the other deques stay empty.
+			for(int i = 0; i < size - 1; i++) {
+				new (&p->threads[i]) Thread();
+
+				if(p->threads[i].init(err, __ox_threadpool_worker, &p->workers[i]) != 0) {
+					p->threads[i].~Thread();
+					err.clear();
+					break;
+				}
+
+				p->num_started++;
+			};
+		}
+
+		handle = p;
+		return 0;
+	};
+
+	void ThreadPool::release(void) {
+		__ox_threadpool_t *p = (__ox_threadpool_t *)handle;
+		if(p == nullptr)
+			return;
+
+		p->quit.store(true, std::memory_order_release);
+		// Permits stick around, even workers about to park get one.
+		p->wake.release(p->num_started);
+
+		for(int i = 0; i < p->num_started; i++) {
+			p->threads[i].join();
+			p->threads[i].~Thread();
+		};
+
+		// Anything left behind by a group nobody waited for.
+		while(__ox_threadpool_help(p, nullptr)) {};
+
+		if(p->threads != nullptr)
+			exhale(p->threads);
+
+		if(p->workers != nullptr) {
+			for(int i = 0; i < p->num_threads; i++)
+				p->workers[i].~__ox_worker_t();
+
+			exhale(p->workers);
+		}
+
+		p->~__ox_threadpool_t();
+		exhale(p);
+
+		handle = nullptr;
+	};
+
+	int ThreadPool::run(Ox::Error &err, long n, job_t f, void *user) {
+		if(err != nullptr)
+			return -1;
+
+		if(f == nullptr) {
+			err = "'f' is NULL";
+			return -1;
+		}
+
+		return parallel_for(err, 0, n, [f, user](long from, long to) {
+			for(long i = from; i < to; i++)
+				f(user, i);
+		}, 1);
+	};
+
+	int ThreadPool::size(void) {
+		__ox_threadpool_t *p = (__ox_threadpool_t *)handle;
+		if(p == nullptr)
+			return 1;
+
+		return p->num_started + 1;
+	};
+
+	ThreadPool &ThreadPool::global(void) {
+		static ThreadPool pool;
+		static int rc = [](void) {
+			// Lives for the whole process, whatever allocator touched it first.
+			ScopedAllocator heap(*HeapAllocator::instance());
+			Ox::Error err;
+			return pool.init(err);
+		}();
+
+		(void)rc;
+		return pool;
+	};
+};
@@ -0,0 +1,765 @@
+/* Ox: a general-purpose library.
+** Copyright (C) 2024-2025  Rivest Osz
+** 
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+** 
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+** 
+** You should have received a copy of the GNU General Public License
+** along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifdef OX_BENCH
+
+#include "../include/nuclei.hpp"
+#include "../include/core/string.hpp"
+#include "../include/core/elastic.hpp"
+#include "../include/core/parallel.hpp"
+#include "../include/core/hashmap.hpp"
+#include "../include/core/ring.hpp"
+#include "../include/core/thread.hpp"
+#include "../include/core/stats.hpp"
+#include "../include/core/clock.hpp"
+#include "../include/core/profile.hpp"
+#include "../include/io/filesystem.hpp"
+#include "../include/io/fstream.hpp"
+#include "../include/io/buffered.hpp"
+#include "../include/io/mapped.hpp"
+#include "../include/io/async.hpp"
+#include <atomic>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <clocale>
+
+// Runs 'body' 'iters' times and prints the time per iteration.
+#define MEASURE(bench_name, iters, body)	\
+	{	\
+		auto __t0 = std::chrono::steady_clock::now();	\
+		for(long __i = 0; __i < (long)(iters); __i++) { body; };	\
+		auto __t1 = std::chrono::steady_clock::now();	\
+		double __ns = std::chrono::duration<double, std::nano>(__t1 - __t0).count();	\
+		std::printf("  %-40s %10.2f ns/op\n", bench_name, __ns / (double)(iters));	\
+	}
+//
+
+// Keeps the optimiser from dropping a result.
+static volatile Ox::ulong sink;
+
+void bench_string(void) {
+	std::printf("[Core/String] backend: %s\n", Ox::simd_backend());
+
+	static char path[4096];
+	for(int i = 0; i < 4095; i++)
+		path[i] = (i % 24 == 0) ? '/' : 'a' + (i % 26);
+	path[4095] = '\0';
+
+	static char other[4096];
+	std::memcpy(other, path, 4096);
+
+	const Ox::ulong sizes[] = { 24, 96, 512, 4095 };
+
+	for(Ox::ulong n : sizes) {
+		char *s = path + 4095 - n;
+		std::printf(" %lu bytes\n", n);
+
+		MEASURE("Ox::strlen", 2'000'000, sink += Ox::strlen(s));
+		MEASURE("std::strlen", 2'000'000, sink += std::strlen(s));
+
+		MEASURE("Ox::memchr (miss)", 2'000'000, sink += (Ox::ulong)Ox::memchr(s, '#', n));
+		MEASURE("std::memchr (miss)", 2'000'000, sink += (Ox::ulong)std::memchr(s, '#', n));
+
+		MEASURE("Ox::memeq", 2'000'000, sink += Ox::memeq(s, other + 4095 - n, n));
+		MEASURE("std::memcmp", 2'000'000, sink += std::memcmp(s, other + 4095 - n, n) == 0);
+
+		MEASURE("Ox::is_utf8", 2'000'000, sink += Ox::is_utf8(s, n));
+	};
+
+	static wchar_t wide[1024];
+	static char utf8[4096];
+	for(int i = 0; i < 1023; i++)
+		wide[i] = (i % 64 == 63) ? 0xe9 : L'a' + (i % 26);
+	wide[1023] = 0;
+
+	std::printf(" 1023 wchar_t, mostly ASCII\n");
+	MEASURE("Ox::utf8_from_wide", 200'000, sink += Ox::utf8_from_wide(wide, 1023, utf8));
+
+	if(std::setlocale(LC_CTYPE, "C.UTF-8") != nullptr)
+		MEASURE("std::wcstombs (C.UTF-8)", 200'000, sink += std::wcstombs(utf8, wide, sizeof(utf8)));
+};
+
+// Counts capacity changes, i.e. reallocations, and times the whole run.
+template<typename Policy>
+static void bench_elastic_policy(const char *name) {
+	Ox::Error err;
+	Ox::Elastic<Ox::ulong, Policy> e;
+	long resizes = 0, cap = 0;
+
+	auto count = [&](void) {
+		if(e.capacity() != cap) {
+			resizes++;
+			cap = e.capacity();
+		}
+	};
+
+	// Fill, swing between 100% and 40% a few hundred times, then drain.
+	auto t0 = std::chrono::steady_clock::now();
+	for(long i = 0; i < 100'000; i++) {
+		e.push_end(i, err);
+		count();
+	};
+
+	long grows = resizes;
+	for(long round = 0; round < 200; round++) {
+		while(e.size() > 40'000) {
+			sink += e.pop_end(err);
+			count();
+		};
+
+		while(e.size() < 100'000) {
+			e.push_end(round, err);
+			count();
+		};
+	};
+
+	while(!e.is_empty()) {
+		sink += e.pop_end(err);
+		count();
+	};
+	auto t1 = std::chrono::steady_clock::now();
+
+	double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+	std::printf("  %-24s %6li reallocs filling %6li after %8.2f ns/op\n", name, grows, resizes - grows, ns / 24'200'000.0);
+};
+
+void bench_elastic(void) {
+	std::printf("Elastic<ulong>: 100k pushes, 200 swings down to 40k and back, drain\n");
+
+	bench_elastic_policy<Ox::ElasticPolicy::Legacy>("Legacy");
+	bench_elastic_policy<Ox::ElasticPolicy::Geometric<3, 2>>("Geometric<3, 2>");
+	bench_elastic_policy<Ox::ElasticPolicy::Geometric<2, 1>>("Geometric<2, 1>");
+	bench_elastic_policy<Ox::ElasticPolicy::NoShrink<3, 2>>("NoShrink<3, 2>");
+	bench_elastic_policy<Ox::ElasticPolicy::Hysteresis<3, 2>>("Hysteresis<3, 2>");
+	bench_elastic_policy<Ox::ElasticPolicy::Hysteresis<2, 1>>("Hysteresis<2, 1>");
+};
+
+void bench_parallel(void) {
+	Ox::Error err;
+	Ox::Elastic<Ox::ulong> e;
+	for(Ox::ulong i = 0; i < 4'000'000; i++)
+		e.push_end((i * 2654435761u) % 1'000'003, err);
+
+	std::printf("Elastic<ulong>, 4M items, %i threads\n", Ox::ThreadPool::global().size());
+
+	MEASURE("sum, operator[]", 20, {
+		Ox::ulong s = 0;
+		for(long i = 0; i < e.size(); i++)
+			s += e[i];
+		sink += s;
+	});
+
+	MEASURE("sum, begin()/end()", 20, {
+		Ox::ulong s = 0;
+		for(Ox::ulong v : e)
+			s += v;
+		sink += s;
+	});
+
+	MEASURE("Parallel::reduce", 20, sink += Ox::Parallel::reduce(e.span(), (Ox::ulong)0, [](Ox::ulong a, Ox::ulong b) { return a + b; }, err));
+
+	Ox::Elastic<Ox::ulong> copy;
+	copy.append(e.data(err), e.size(), err);
+
+	MEASURE("std::sort", 5, {
+		std::copy(e.begin(), e.end(), copy.begin());
+		std::sort(copy.begin(), copy.end());
+	});
+
+	MEASURE("TaskGroup, 1000 empty tasks", 100, {
+		Ox::TaskGroup group;
+		for(int t = 0; t < 1000; t++)
+			group.spawn(err, [](void) { sink += 1; });
+	});
+
+	MEASURE("parallel_for sum, adaptive grain", 20, {
+		std::atomic<Ox::ulong> total { 0 };
+		Ox::ThreadPool::global().parallel_for(err, 0, e.size(), [&](long from, long to) {
+			Ox::ulong s = 0;
+			for(long i = from; i < to; i++)
+				s += e.begin()[i];
+			total += s;
+		});
+		sink += total.load();
+	});
+
+	MEASURE("Parallel::sort", 5, {
+		std::copy(e.begin(), e.end(), copy.begin());
+		Ox::Parallel::sort(copy.span(), err);
+	});
+};
+
+void bench_hashmap(void) {
+	const long n = 1'000'000;
+	Ox::Error err;
+
+	// Scattered keys, looked up in a different order than inserted.
+	auto key = [](long i) -> Ox::u64 { return (Ox::u64)i * 0x9e3779b97f4a7c15; };
+
+	std::printf("1M u64 -> u64\n");
+
+	Ox::HashMap<Ox::u64, Ox::u64> ox;
+	std::unordered_map<Ox::u64, Ox::u64> st;
+
+	MEASURE("Ox::HashMap::set", n, ox.set(key(__i), __i, err));
+	MEASURE("std::unordered_map::emplace", n, st.emplace(key(__i), __i));
+
+	MEASURE("Ox::HashMap::find (hit)", n, sink += *ox.find(key((__i * 7) % n)));
+	MEASURE("std::unordered_map::find (hit)", n, sink += st.find(key((__i * 7) % n))->second);
+
+	MEASURE("Ox::HashMap::find (miss)", n, sink += ox.find(key(n + __i)) != nullptr);
+	MEASURE("std::unordered_map::find (miss)", n, sink += st.find(key(n + __i)) != st.end());
+
+	MEASURE("Ox::HashMap iteration", 10, for(auto &e : ox) sink += e.value);
+	MEASURE("std::unordered_map iteration", 10, for(auto &e : st) sink += e.second);
+
+	MEASURE("Ox::HashMap::remove", n, sink += ox.remove(key(__i)));
+	MEASURE("std::unordered_map::erase", n, sink += st.erase(key(__i)));
+
+	std::printf("100k String -> int, ~30 characters\n");
+
+	Ox::Elastic<Ox::String> keys;
+	for(long i = 0; i < 100'000; i++) {
+		Ox::String s;
+		s.from_fmt(err, "/usr/share/some/thing/%08li", i);
+		keys.push_end(std::move(s), err);
+	};
+
+	Ox::HashMap<Ox::String, int> oxs;
+	std::unordered_map<std::string, int> sts;
+
+	MEASURE("Ox::HashMap::set", 100'000, oxs.set(keys[__i], (int)__i, err));
+	MEASURE("std::unordered_map::emplace", 100'000, sts.emplace(keys[__i].c_str(), (int)__i));
+
+	MEASURE("Ox::HashMap::find (hit)", 100'000, sink += *oxs.find(keys[(__i * 7) % 100'000]));
+	{
+		// Keys converted up front, as a std::string user would have them.
+		std::string *skeys = new std::string[100'000];
+		for(long i = 0; i < 100'000; i++)
+			skeys[i] = keys[i].c_str();
+
+		MEASURE("std::unordered_map::find (hit)", 100'000, sink += sts.find(skeys[(__i * 7) % 100'000])->second);
+		delete[] skeys;
+	}
+};
+
+static const long ring_items = 2'000'000;
+static Ox::MPMCRing<Ox::ulong> ring_mpmc;
+
+static void ring_producer(void *user) {
+	long n = (long)(Ox::pointer_t)user;
+	Ox::ulong batch[16];
+
+	for(long i = 0; i < n; ) {
+		long k = n - i < 16 ? n - i : 16;
+		for(long j = 0; j < k; j++)
+			batch[j] = i + j;
+
+		long pushed = ring_mpmc.push_n(batch, k);
+		if(pushed == 0)
+			Ox::Thread::yield();
+
+		i += pushed;
+	};
+};
+
+void bench_ring(void) {
+	Ox::Error err;
+
+	std::printf("Rings, %li items\n", ring_items);
+
+	{
+		// Round trip through two SPSC rings, one item at a time.
+		static Ox::SPSCRing<Ox::ulong> ping, pong;
+		ping.init(64, err);
+		pong.init(64, err);
+
+		Ox::Thread echo;
+		echo.init(err, [](void *) {
+			Ox::ulong v = 0;
+			for(long i = 0; i < 100'000; i++) {
+				while(ping.pop(v) == false) Ox::Thread::yield();
+				while(pong.push(v) == false) Ox::Thread::yield();
+			};
+		}, nullptr);
+
+		Ox::ulong v = 0;
+		MEASURE("SPSC round trip", 100'000, {
+			while(ping.push((Ox::ulong)__i) == false) Ox::Thread::yield();
+			while(pong.pop(v) == false) Ox::Thread::yield();
+			sink += v;
+		});
+
+		echo.join();
+	}
+
+	{
+		static Ox::SPSCRing<Ox::ulong> spsc;
+		spsc.init(4096, err);
+
+		Ox::Thread producer;
+		auto t0 = std::chrono::steady_clock::now();
+
+		producer.init(err, [](void *) {
+			Ox::ulong batch[16];
+			for(long i = 0; i < ring_items; ) {
+				long k = ring_items - i < 16 ? ring_items - i : 16;
+				for(long j = 0; j < k; j++)
+					batch[j] = i + j;
+
+				long pushed = spsc.push_n(batch, k);
+				if(pushed == 0)
+					Ox::Thread::yield();
+
+				i += pushed;
+			};
+		}, nullptr);
+
+		Ox::ulong batch[16];
+		for(long got = 0; got < ring_items; ) {
+			long k = spsc.pop_n(batch, 16);
+			if(k == 0)
+				Ox::Thread::yield();
+
+			for(long j = 0; j < k; j++)
+				sink += batch[j];
+			got += k;
+		};
+
+		producer.join();
+
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+		std::printf("  %-40s %10.2f ns/item\n", "SPSC, batches of 16", ns / ring_items);
+	}
+
+	ring_mpmc.init(4096, err);
+
+	int most = Ox::Thread::hint_hardware_concurrency();
+	if(most < 4)
+		most = 4;
+	if(most > 64)
+		most = 64;
+
+	for(int producers = 1; producers <= most; producers <<= 1) {
+		Ox::Thread threads[64];
+		long each = ring_items / producers;
+		auto t0 = std::chrono::steady_clock::now();
+
+		for(int t = 0; t < producers; t++)
+			threads[t].init(err, ring_producer, (void *)(Ox::pointer_t)each);
+
+		Ox::ulong batch[16];
+		for(long got = 0; got < each * producers; ) {
+			long k = ring_mpmc.pop_n(batch, 16);
+			if(k == 0)
+				Ox::Thread::yield();
+
+			for(long j = 0; j < k; j++)
+				sink += batch[j];
+			got += k;
+		};
+
+		for(int t = 0; t < producers; t++)
+			threads[t].join();
+
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+		char name[64];
+		std::snprintf(name, sizeof(name), "MPMC, %i producer(s), 1 consumer", producers);
+		std::printf("  %-40s %10.2f ns/item\n", name, ns / (each * producers));
+	};
+};
+
+// Lock wrappers, so that one worker can drive every kind of lock.
+typedef struct bench_ox_mutex_t {
+	Ox::Mutex m;
+	void lock(void) { Ox::Error err; m.lock(err); };
+	void unlock(void) { Ox::Error err; m.unlock(err); };
+	void lock_shared(void) { lock(); };
+	void unlock_shared(void) { unlock(); };
+} bench_ox_mutex_t;
+
+typedef struct bench_ox_rwlock_t {
+	Ox::RWLock m;
+	void lock(void) { Ox::Error err; m.write_lock(err); };
+	void unlock(void) { m.write_unlock(); };
+	void lock_shared(void) { Ox::Error err; m.read_lock(err); };
+	void unlock_shared(void) { m.read_unlock(); };
+} bench_ox_rwlock_t;
+
+typedef struct bench_std_mutex_t {
+	std::mutex m;
+	void lock(void) { m.lock(); };
+	void unlock(void) { m.unlock(); };
+	void lock_shared(void) { lock(); };
+	void unlock_shared(void) { unlock(); };
+} bench_std_mutex_t;
+
+static const long lock_ops = 200'000;
+static Ox::ulong lock_counter;
+
+// Every 'write_every'th operation takes the lock exclusively.
+template<typename L, long write_every>
+static void lock_worker(void *user) {
+	L *l = (L *)user;
+
+	for(long i = 0; i < lock_ops; i++) {
+		if(i % write_every == 0) {
+			l->lock();
+			lock_counter++;
+			l->unlock();
+		} else {
+			l->lock_shared();
+			sink += lock_counter;
+			l->unlock_shared();
+		}
+	};
+}
+
+template<typename L, long write_every>
+static void bench_lock(const char *name, int threads) {
+	static L l;
+	Ox::Error err;
+	Ox::Thread workers[64];
+
+	auto t0 = std::chrono::steady_clock::now();
+
+	for(int t = 0; t < threads; t++)
+		workers[t].init(err, lock_worker<L, write_every>, &l);
+	for(int t = 0; t < threads; t++)
+		workers[t].join();
+
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+	char label[64];
+	std::snprintf(label, sizeof(label), "%s, %i thread(s)", name, threads);
+	std::printf("  %-40s %10.2f ns/op\n", label, ns / ((double)lock_ops * threads));
+}
+
+void bench_locks(void) {
+	std::printf("Locks, uncontended\n");
+
+	{
+		Ox::Error err;
+		Ox::Mutex m;
+		std::mutex sm;
+		Ox::RWLock rw;
+		std::shared_mutex srw;
+
+		MEASURE("Ox::Mutex", 5'000'000, { m.lock(err); sink += __i; m.unlock(err); });
+		MEASURE("std::mutex", 5'000'000, { sm.lock(); sink += __i; sm.unlock(); });
+		MEASURE("Ox::RWLock (read)", 5'000'000, { rw.read_lock(err); sink += __i; rw.read_unlock(); });
+		MEASURE("std::shared_mutex (read)", 5'000'000, { srw.lock_shared(); sink += __i; srw.unlock_shared(); });
+		MEASURE("Ox::RWLock (write)", 5'000'000, { rw.write_lock(err); sink += __i; rw.write_unlock(); });
+		MEASURE("std::shared_mutex (write)", 5'000'000, { srw.lock(); sink += __i; srw.unlock(); });
+	}
+
+	int most = Ox::Thread::hint_hardware_concurrency();
+	if(most < 4)
+		most = 4;
+	if(most > 64)
+		most = 64;
+
+	std::printf("Locks, contended\n");
+
+	for(int threads = 2; threads <= most; threads <<= 1) {
+		bench_lock<bench_ox_mutex_t, 1>("Ox::Mutex", threads);
+		bench_lock<bench_std_mutex_t, 1>("std::mutex", threads);
+	};
+
+	std::printf("Locks, 1 write in 16\n");
+
+	for(int threads = 2; threads <= most; threads <<= 1) {
+		bench_lock<bench_ox_mutex_t, 16>("Ox::Mutex", threads);
+		bench_lock<bench_ox_rwlock_t, 16>("Ox::RWLock", threads);
+		bench_lock<std::shared_mutex, 16>("std::shared_mutex", threads);
+	};
+
+	Ox::Stats::wait_snapshot_t s = Ox::Stats::wait_snapshot();
+	for(Ox::uint k = Ox::Stats::wait_mutex; k <= Ox::Stats::wait_rwlock_write; k++)
+		std::printf("  %-14s %10lu contended, %10lu parked, %8.2f ms blocked\n",
+			s.kinds[k].name, s.kinds[k].contended, s.kinds[k].waits, s.kinds[k].wait_ns / 1e6);
+};
+
+static const long counter_adds = 1'000'000;
+static std::atomic<long> counter_shared { 0 };
+static Ox::Counter counter_sharded;
+
+void bench_counter(void) {
+	Ox::Error err;
+
+	int most = Ox::Thread::hint_hardware_concurrency();
+	if(most < 4)
+		most = 4;
+	if(most > 64)
+		most = 64;
+
+	std::printf("Counters, %li adds per thread\n", counter_adds);
+
+	for(int threads = 1; threads <= most; threads <<= 1) {
+		const char *names[2] = { "std::atomic<long>", "Ox::Counter" };
+		Ox::Thread::callable_t workers[2] = {
+			[](void *) {
+				for(long i = 0; i < counter_adds; i++)
+					counter_shared.fetch_add(1, std::memory_order_relaxed);
+			},
+			[](void *) {
+				for(long i = 0; i < counter_adds; i++)
+					counter_sharded.add();
+			}
+		};
+
+		for(int w = 0; w < 2; w++) {
+			Ox::Thread pool[64];
+			auto t0 = std::chrono::steady_clock::now();
+
+			for(int t = 0; t < threads; t++)
+				pool[t].init(err, workers[w], nullptr);
+			for(int t = 0; t < threads; t++)
+				pool[t].join();
+
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "%s, %i thread(s)", names[w], threads);
+			std::printf("  %-40s %10.2f ns/add\n", label, ns / ((double)counter_adds * threads));
+		};
+	};
+
+	sink += counter_shared.load() + counter_sharded.value();
+};
+
+void bench_clock(void) {
+	std::printf("[Core/Clock] %s, %.3f ticks/ns\n", Ox::Clock::is_tsc() ? "TSC" : "OS clock", Ox::Clock::ticks_per_ns());
+
+	MEASURE("Clock::ticks", 1'000'000, sink += Ox::Clock::ticks());
+	MEASURE("Clock::now", 1'000'000, sink += Ox::Clock::now());
+	MEASURE("std::chrono::steady_clock::now", 1'000'000,
+		sink += std::chrono::steady_clock::now().time_since_epoch().count());
+	MEASURE("Profile::Zone", 1'000'000, Ox::Profile::Zone z("bench"));
+
+	Ox::Profile::clear();
+};
+
+void bench_streams(void) {
+	std::printf("[IO/Buffered streams]\n");
+
+	static const long values = 1 << 18;
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-bench.bin";
+
+	{
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+		MEASURE("FileStream::writeU32BE", values, fs.writeU32BE((Ox::u32)__i, err));
+	}
+
+	{
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+		Ox::BufferedWriter w;
+		w.init(fs, err);
+		MEASURE("BufferedWriter::writeU32BE", values, w.writeU32BE((Ox::u32)__i, err));
+		w.flush(err);
+	}
+
+	{
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::in, err);
+		MEASURE("FileStream::readU8", values * 4, sink += fs.readU8(err));
+	}
+
+	{
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::in, err);
+		Ox::BufferedReader r;
+		r.init(fs, err);
+		MEASURE("BufferedReader::readU8", values * 4, sink += r.readU8(err));
+	}
+
+	{
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::in, err);
+		Ox::BufferedReader r;
+		r.init(fs, err);
+		Ox::BasicIOStream &rs = r;
+		MEASURE("BufferedReader as BasicIOStream::readU8", values * 4, sink += rs.readU8(err));
+	}
+
+	{
+		Ox::MappedFileStream ms;
+		ms.open(path.c_str(), Ox::in, err);
+		MEASURE("MappedFileStream::readU8", values * 4, sink += ms.readU8(err));
+	}
+
+	{
+		// Large sequential writes, where the native backend skips a copy.
+		static Ox::u8 block[1 << 20];
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+		std::printf(" %s backend\n", fs.native_handle() >= 0 ? "native" : "std::fstream");
+
+		fs.preallocate(0, 32 * sizeof(block), err);
+		err.clear();
+
+		MEASURE("FileStream::write, 1 MiB blocks", 32, fs.write(block, sizeof(block), err));
+		fs.sync(err);
+	}
+
+	{
+		// Small records made of a header and a payload, one call or two.
+		static Ox::u8 header[16];
+		static Ox::u8 payload[240];
+		Ox::io_slice_t record[2] = { { header, sizeof(header) }, { payload, sizeof(payload) } };
+
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+		MEASURE("FileStream::write, header then payload", values >> 4,
+			fs.write(header, sizeof(header), err); fs.write(payload, sizeof(payload), err));
+
+		fs.seekp(0);
+		MEASURE("FileStream::writev, header and payload", values >> 4, fs.writev(record, 2, err));
+	}
+
+	if(err != nullptr)
+		std::printf("  failed: %s\n", err.c_str());
+};
+
+typedef struct bench_reader_t {
+	Ox::AsyncIO *io;
+	int file;
+	Ox::ulong blocks;
+	// Reads still to queue.
+	long left;
+	Ox::u64 rng;
+} bench_reader_t;
+
+static Ox::ulong bench_random_block(bench_reader_t *b) {
+	b->rng = b->rng * 6364136223846793005ull + 1442695040888963407ull;
+	return (b->rng >> 33) % b->blocks;
+};
+
+// Keeps the queue full: every completion queues the next read.
+static void bench_reader_next(Ox::AsyncIO::request_t &r, void *user) {
+	bench_reader_t *b = (bench_reader_t *)user;
+	if(b->left <= 0)
+		return;
+
+	b->left--;
+
+	Ox::Error err;
+	b->io->read(r, b->file, r.data, 4096, bench_random_block(b) * 4096, err);
+};
+
+void bench_async(void) {
+	std::printf("[IO/Asynchronous I/O]\n");
+
+	static const Ox::ulong file_size = 64 << 20;
+	static const long reads = 1 << 14;
+	static const Ox::uint depths[] = { 1, 4, 16, 64, 128 };
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-bench-async.bin";
+
+	{
+		static Ox::u8 block[1 << 20];
+		std::memset(block, 'x', sizeof(block));
+
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+		for(Ox::ulong i = 0; i < file_size / sizeof(block); i++)
+			fs.write(block, sizeof(block), err);
+	}
+
+	Ox::u8 *buffers = (Ox::u8 *)std::aligned_alloc(4096, 128 * 4096);
+	Ox::AsyncIO::backend_t backends[2] = { Ox::AsyncIO::backend_uring, Ox::AsyncIO::backend_threads };
+	const char *names[2] = { "io_uring", "threads" };
+
+	for(int k = 0; k < 2; k++) {
+		for(Ox::uint depth : depths) {
+			Ox::AsyncIO::options_t options;
+			options.depth = depth;
+			options.backend = backends[k];
+
+			Ox::AsyncIO io;
+			if(io.init(options, err) != 0) {
+				std::printf("  %s unavailable: %s\n", names[k], err.c_str());
+				err.clear();
+				break;
+			}
+
+			// Past the page cache where the file system allows it.
+			Ox::FileStream::options_t fo;
+			fo.direct = true;
+			fo.advice = Ox::FileStream::advice_random;
+
+			int file = io.open(path.c_str(), Ox::in, fo, err);
+			if(file < 0) {
+				err.clear();
+				fo.direct = false;
+				file = io.open(path.c_str(), Ox::in, fo, err);
+			}
+
+			Ox::io_slice_t registered = { buffers, 128 * 4096 };
+			io.register_buffers(&registered, 1, err);
+
+			bench_reader_t b = { &io, file, file_size / 4096, reads - (long)depth, 0x9e3779b97f4a7c15ull };
+			Ox::AsyncIO::request_t requests[128];
+
+			auto t0 = std::chrono::steady_clock::now();
+
+			for(Ox::uint i = 0; i < depth; i++) {
+				requests[i].callback = bench_reader_next;
+				requests[i].user = &b;
+				io.read(requests[i], file, buffers + i * 4096, 4096, bench_random_block(&b) * 4096, err);
+			};
+
+			io.drain(err);
+
+			auto t1 = std::chrono::steady_clock::now();
+			double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+			char name[64];
+			std::snprintf(name, sizeof(name), "%s 4K random reads, QD %u%s", names[k], depth, fo.direct ? "" : " (cached)");
+			std::printf("  %-40s %10.2f ns/op %10.0f IOPS\n", name, ns / reads, reads * 1e9 / ns);
+
+			io.close(file);
+		};
+	};
+
+	std::free(buffers);
+
+	if(err != nullptr)
+		std::printf("  failed: %s\n", err.c_str());
+};
+
+int main(void) {
+	bench_string();
+	bench_elastic();
+	bench_parallel();
+	bench_hashmap();
+	bench_ring();
+	bench_locks();
+	bench_counter();
+	bench_clock();
+	bench_streams();
+	bench_async();
+
+	return 0;
+};
+
+#endif
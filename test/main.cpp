@@ -18,12 +18,32 @@
 #ifdef OX_TEST
 
 #include "../include/nuclei.hpp"
+#include "../include/core/allocator.hpp"
+#include "../include/core/stats.hpp"
+#include "../include/core/string.hpp"
+#include "../include/core/atom.hpp"
+#include "../include/core/elastic.hpp"
+#include "../include/core/parallel.hpp"
+#include "../include/core/threadpool.hpp"
+#include "../include/core/hashmap.hpp"
+#include "../include/core/ring.hpp"
+#include "../include/core/threadlocal.hpp"
+#include "../include/core/task.hpp"
+#include "../include/core/clock.hpp"
+#include "../include/core/profile.hpp"
+#include <atomic>
 #include "../include/crypto/crc.hpp"
 #include "../include/io/filesystem.hpp"
 #include "../include/io/fstream.hpp"
+#include "../include/io/buffered.hpp"
+#include "../include/io/memstream.hpp"
+#include "../include/io/mapped.hpp"
+#include "../include/io/async.hpp"
 #include "../include/formats/qoi.hpp"
+#include <algorithm>
 #include <cstdarg>
 #include <cstring>
+#include <cerrno>
 #include <cstdio>
 
 #define SUPERVISE(test_name)	\
@@ -66,6 +86,568 @@ void test_endian(void) {
 	OK();
 };
 
+void test_atomic(void) {
+	SUPERVISE("Nuclei/Atomic");
+
+	Ox::Atomic<Ox::u32> a { 5 };
+	Ox::u32 expected = 4;
+
+	ENFORCE(a.compare_exchange(expected, 9) == false && expected == 5, "CAS succeeded on a wrong value");
+	ENFORCE(a.compare_exchange(expected, 9, Ox::order_acq_rel) && a.load(Ox::order_acquire) == 9, "CAS failed");
+	ENFORCE(a.exchange(1) == 9 && a.fetch_add(2) == 1 && a.fetch_or(8) == 3 && a.load() == 11, "Atomic arithmetic is off");
+
+	Ox::Atomic<const char *> p { nullptr };
+	p.store("ox", Ox::order_release);
+	ENFORCE(p.load(Ox::order_acquire)[0] == 'o', "Atomic pointer lost its value");
+
+	static Ox::Padded<long> pair[2];
+	ENFORCE((Ox::pointer_t)&pair[1] - (Ox::pointer_t)&pair[0] == OX_CACHE_LINE
+		&& (Ox::pointer_t)&pair[0] % OX_CACHE_LINE == 0, "Padded items share a cache line");
+
+	static Ox::Counter counter;
+	Ox::Error err;
+	Ox::Thread threads[4];
+
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			for(int i = 0; i < 100'000; i++)
+				counter.add();
+
+			counter.sub(10);
+		}, nullptr);
+
+	for(int t = 0; t < 4; t++)
+		threads[t].join();
+
+	ENFORCE(err == nullptr && counter.value() == 4 * (100'000 - 10), "Counter lost adds: %li", (long)counter.value());
+
+	counter.reset();
+	ENFORCE(counter.value() == 0, "Counter didn't reset");
+
+	OK();
+};
+
+void test_arena(void) {
+	SUPERVISE("Nuclei/Arena");
+
+	Ox::Error err;
+	Ox::Arena arena(4096);
+	Ox::u8 *outside = Ox::inhale<Ox::u8>(16, err);
+
+	{
+		Ox::ScopedAllocator scope(arena);
+
+		Ox::u32 *a = Ox::inhale<Ox::u32>(64, err);
+		ENFORCE(err == nullptr, "Couldn't allocate from the arena: %s", err.c_str());
+		ENFORCE(arena.owns(a), "Allocation didn't come from the arena");
+
+		for(int i = 0; i < 64; i++)
+			ENFORCE(a[i] == 0, "Arena memory isn't zero-filled");
+
+		a = Ox::respire<Ox::u32>(a, 128, err);
+		ENFORCE(err == nullptr && arena.owns(a), "Couldn't grow an arena block: %s", err.c_str());
+
+		Ox::u8 *big = Ox::inhale<Ox::u8>(16384, err);
+		ENFORCE(err == nullptr && arena.owns(big), "Couldn't allocate an oversized block: %s", err.c_str());
+
+		// Blocks from before the scope still go back to the heap.
+		Ox::exhale(outside);
+	}
+
+	ENFORCE(Ox::current_allocator() == Ox::HeapAllocator::instance(), "Scope didn't restore the heap");
+
+	Ox::Error failure;
+	{
+		Ox::ScopedAllocator scope(arena);
+		failure.from_fmt("Failed after %d tries", 3);
+		ENFORCE(!arena.owns(failure.c_str()), "Error message came from the arena");
+	}
+
+	arena.reset();
+	ENFORCE(arena.used() == 0, "Arena wasn't reset");
+	ENFORCE(std::strcmp(failure.c_str(), "Failed after 3 tries") == 0, "Error message didn't survive the arena");
+
+	OK();
+};
+
+void test_pool(void) {
+	SUPERVISE("Nuclei/Pool");
+
+	Ox::Error err;
+	Ox::PoolAllocator *pool = Ox::PoolAllocator::instance();
+	Ox::PoolAllocator::stats_t before = pool->stats();
+
+	{
+		Ox::ScopedAllocator scope(*pool);
+
+		for(int i = 0; i < 1000; i++) {
+			char *s = Ox::inhale_raw<char>(24, err);
+			ENFORCE(err == nullptr, "Couldn't allocate from the pool: %s", err.c_str());
+			Ox::exhale(s);
+		};
+
+		Ox::u8 *z = Ox::inhale<Ox::u8>(100, err);
+		for(int i = 0; i < 100; i++)
+			ENFORCE(z[i] == 0, "Pool memory isn't zero-filled");
+
+		z = Ox::respire<Ox::u8>(z, 10000, err);
+		ENFORCE(err == nullptr && z[99] == 0, "Couldn't move a block out of the pool: %s", err.c_str());
+		Ox::exhale(z);
+	}
+
+	Ox::PoolAllocator::stats_t after = pool->stats();
+	ENFORCE(after.hits - before.hits >= 999, "Expecting at least 999 hits, got %lu", (unsigned long)(after.hits - before.hits));
+
+	OK();
+};
+
+void test_alloc_stats(void) {
+	SUPERVISE("Nuclei/Allocation stats");
+
+	Ox::Stats::alloc_snapshot_t before = Ox::Stats::alloc_snapshot();
+
+	{
+		Ox::String s("Oxygen lives, and it needs the heap for that!");
+		s = "Oxygen still lives, and it still needs the heap!";
+	}
+
+	Ox::Stats::alloc_snapshot_t after = Ox::Stats::alloc_snapshot();
+
+	if(after.enabled) {
+		ENFORCE(after.allocs - before.allocs >= 2, "Expecting at least 2 allocations");
+		ENFORCE(after.live_bytes == before.live_bytes, "Expecting no leaked bytes");
+		ENFORCE(after.peak_bytes >= after.live_bytes, "Peak is below live bytes");
+
+		bool found = false;
+		for(Ox::uint i = 0; i < after.num_tags; i++)
+			if(std::strcmp(after.tags[i].name, "string") == 0)
+				found = true;
+
+		ENFORCE(found, "Tag \"string\" is missing");
+	} else {
+		ENFORCE(after.allocs == 0, "Disabled stats shouldn't count");
+	}
+
+	OK();
+};
+
+void test_string(void) {
+	SUPERVISE("Core/String");
+
+	Ox::String empty;
+	ENFORCE(empty.c_str() == nullptr, "Default String isn't NULL");
+
+	Ox::String a("/usr");
+	Ox::String b = a + "/share/ox/some/long/enough/path";
+
+	ENFORCE(b.err == nullptr && a.err == nullptr, "Concatenation failed: %s", b.err.c_str());
+	ENFORCE(b.length() == 35, "Expecting length 35, got %lu", b.length());
+	ENFORCE(std::strcmp(b.c_str(), "/usr/share/ox/some/long/enough/path") == 0, "Bad concatenation \"%s\"", b.c_str());
+
+	Ox::String c = b;
+	ENFORCE(c.c_str() != b.c_str() && std::strcmp(c.c_str(), b.c_str()) == 0, "Bad copy");
+
+	Ox::String d = static_cast<Ox::String &&>(c);
+	ENFORCE(c.c_str() == nullptr && d.length() == 35, "Bad move");
+
+	Ox::String e;
+	e.from_fmt(e.err, "%s-%i", "ox", 42);
+	ENFORCE(std::strcmp(e.c_str(), "ox-42") == 0, "Bad format \"%s\"", e.c_str());
+
+	e = d;
+	e = e.c_str() + 5;
+	ENFORCE(std::strcmp(e.c_str(), "share/ox/some/long/enough/path") == 0, "Bad self-assignment \"%s\"", e.c_str());
+
+	OK();
+};
+
+void test_string_simd(void) {
+	SUPERVISE("Core/String primitives");
+
+	char buff[300];
+	for(int i = 0; i < 299; i++)
+		buff[i] = 'a' + (i % 26);
+	buff[299] = '\0';
+
+	for(int off = 0; off < 40; off++) {
+		ENFORCE(Ox::strlen(buff + off) == std::strlen(buff + off), "strlen mismatch at offset %i (%s)", off, Ox::simd_backend());
+
+		const char *p = Ox::memchr(buff + off, 'z', 299 - off);
+		ENFORCE(p == std::memchr(buff + off, 'z', 299 - off), "memchr mismatch at offset %i", off);
+	};
+
+	char other[300];
+	std::memcpy(other, buff, 300);
+	ENFORCE(Ox::memeq(buff, other, 300), "memeq failed on equal buffers");
+
+	other[217] = 'A';
+	ENFORCE(Ox::memeq(buff, other, 300) == false, "memeq missed a difference");
+	ENFORCE(Ox::memcmp(buff, other, 300) > 0 && Ox::memcmp(other, buff, 300) < 0, "memcmp got the order wrong");
+
+	ENFORCE(Ox::is_utf8("/home/ox/caf\xc3\xa9/\xf0\x9f\x90\x82", 19), "Rejected valid UTF-8");
+	ENFORCE(Ox::is_utf8("/home/ox/\xc0\xaf", 11) == false, "Accepted an overlong sequence");
+	ENFORCE(Ox::is_utf8("/home/ox/\xed\xa0\x80", 12) == false, "Accepted a surrogate");
+
+	Ox::String w;
+	w.from_c(L"/home/ox/some/long/ascii/path/caf\u00e9/\u20ac/\U0001f402", w.err);
+	ENFORCE(w.err == nullptr, "Couldn't convert a wide string: %s", w.err.c_str());
+	ENFORCE(std::strcmp(w.c_str(), "/home/ox/some/long/ascii/path/caf\xc3\xa9/\xe2\x82\xac/\xf0\x9f\x90\x82") == 0, "Bad wide conversion \"%s\"", w.c_str());
+
+	OK();
+};
+
+void test_atom(void) {
+	SUPERVISE("Core/Atom");
+
+	Ox::Error err;
+	Ox::StringPool pool;
+
+	Ox::Atom a = pool.intern("/usr/share/ox", err);
+	Ox::String s("/usr/share/ox");
+	Ox::Atom b = pool.intern(s.c_str(), s.length(), err);
+	Ox::Atom c = pool.intern("/usr/share/ox/", err);
+
+	ENFORCE(err == nullptr, "Couldn't intern: %s", err.c_str());
+	ENFORCE(a == b && a.c_str() == b.c_str(), "Same string interned twice");
+	ENFORCE(a != c, "Different strings share an atom");
+	ENFORCE(pool.size() == 2, "Expecting 2 entries, got %lu", pool.size());
+
+	c = a;
+	ENFORCE(pool.size() == 1, "Unreferenced entry wasn't dropped");
+
+	Ox::FS::Directory dir = Ox::FS::opendir(".", err);
+	Ox::ulong n = 0;
+
+	while(true) {
+		Ox::Atom name = dir.next_atom(err);
+		ENFORCE(err == nullptr, "Couldn't read the next file in the directory: %s", err.c_str());
+
+		if(name.is_null())
+			break;
+
+		ENFORCE(Ox::StringPool::global()->intern(name.c_str(), err) == name, "Directory entry isn't interned");
+		n++;
+	};
+
+	ENFORCE(n > 0, "Directory looks empty");
+
+	OK();
+};
+
+void test_string_builder(void) {
+	SUPERVISE("Core/StringBuilder");
+
+	Ox::Error err;
+	Ox::StringBuilder sb;
+
+	sb.append("/tmp", err);
+	for(int i = 0; i < 100; i++) {
+		sb.append_char('/', err);
+		sb.append_int(i - 50, err);
+	};
+
+	sb.append_fmt(err, "/%s.%u", "frame", 7u);
+	ENFORCE(err == nullptr, "Couldn't build the string: %s", err.c_str());
+	ENFORCE(Ox::strlen(sb.c_str()) == sb.length(), "Cached length mismatch");
+
+	const char *buff = sb.c_str();
+	Ox::String s = sb.take();
+
+	ENFORCE(s.c_str() == buff, "take() copied the buffer");
+	ENFORCE(sb.c_str() == nullptr && sb.length() == 0, "Builder wasn't emptied");
+	ENFORCE(std::strncmp(s.c_str(), "/tmp/-50/-49/", 13) == 0, "Bad prefix \"%.16s\"", s.c_str());
+	ENFORCE(std::strcmp(s.c_str() + s.length() - 11, "/49/frame.7") == 0, "Bad suffix \"%s\"", s.c_str() + s.length() - 11);
+
+	OK();
+};
+
+// Freed from a static destructor, once the allocators are long set up.
+static Ox::Elastic<int> test_static_elastic;
+
+void test_elastic(void) {
+	SUPERVISE("Core/Elastic");
+
+	Ox::Error err;
+	test_static_elastic.push_end(1, err);
+	ENFORCE(err == nullptr, "Couldn't push: %s", err.c_str());
+
+	Ox::Elastic<int> ints;
+
+	int some[5] = { 1, 2, 3, 4, 5 };
+	ints.append(some, 5, err);
+	ints.append(ints.data(err), 5, err);
+	ENFORCE(err == nullptr && ints.size() == 10, "Couldn't append: %s", err.c_str());
+	ENFORCE(ints[9] == 5 && ints.pop_end(err) == 5 && ints.size() == 9, "Bad append/pop");
+
+	ints.shrink_to_fit(err);
+	ENFORCE(ints.capacity() == 9, "Expecting capacity 9, got %li", ints.capacity());
+
+	Ox::Elastic<Ox::String> strings;
+	for(int i = 0; i < 100; i++) {
+		Ox::String s;
+		s.from_fmt(s.err, "/some/rather/long/path/number/%i", i);
+		strings.push_end(static_cast<Ox::String &&>(s), err);
+		strings.emplace_end(err, "short");
+	};
+
+	ENFORCE(err == nullptr && strings.size() == 200, "Couldn't push strings: %s", err.c_str());
+	ENFORCE(std::strcmp(strings[198].c_str(), "/some/rather/long/path/number/99") == 0, "Bad string \"%s\"", strings[198].c_str());
+	ENFORCE(std::strcmp(strings[1].c_str(), "short") == 0, "Bad inline string after growth");
+
+	Ox::String last = strings.pop_end(err);
+	ENFORCE(std::strcmp(last.c_str(), "short") == 0, "Bad popped string");
+
+	Ox::Elastic<Ox::Elastic<int>> nested;
+	nested.emplace_end(err);
+	nested[0].push_end(42, err);
+	nested.emplace_end(err);
+	nested.emplace_end(err);
+	nested.emplace_end(err);
+	ENFORCE(err == nullptr && nested[0][0] == 42, "Move-only items didn't survive growth");
+
+	// Bouncing around a capacity boundary shouldn't reallocate every time.
+	Ox::Elastic<int> bouncy;
+	for(int i = 0; i < 64; i++)
+		bouncy.push_end(i, err);
+
+	long cap = bouncy.capacity();
+	for(int i = bouncy.size(); i > cap / 2; i--)
+		bouncy.pop_end(err);
+
+	for(int i = 0; i < 100; i++) {
+		bouncy.pop_end(err);
+		bouncy.push_end(i, err);
+	};
+
+	ENFORCE(bouncy.capacity() == cap, "Hysteresis didn't hold, capacity %li -> %li", cap, bouncy.capacity());
+
+	Ox::Elastic<int, Ox::ElasticPolicy::NoShrink<2, 1>> greedy;
+	for(int i = 0; i < 100; i++)
+		greedy.push_end(i, err);
+	cap = greedy.capacity();
+	while(!greedy.is_empty())
+		greedy.pop_end(err);
+	ENFORCE(err == nullptr && greedy.capacity() == cap, "NoShrink gave memory back");
+
+	#ifndef NDEBUG
+		(void)bouncy[bouncy.size()];
+		ENFORCE(bouncy.error != nullptr, "Indexing past the end went unchecked");
+	#endif
+
+	OK();
+};
+
+void test_parallel(void) {
+	SUPERVISE("Core/Parallel");
+
+	Ox::Error err;
+	Ox::ThreadPool pool;
+	pool.init(err, 4);
+	ENFORCE(err == nullptr && pool.size() >= 1, "Couldn't start the pool: %s", err.c_str());
+
+	Ox::Elastic<long> items;
+	for(long i = 0; i < 100'000; i++)
+		items.push_end((i * 7919) % 100'003, err);
+
+	long serial = 0;
+	for(long v : items)
+		serial += v;
+
+	long sum = Ox::Parallel::reduce(pool, items.span(), 0L, [](long a, long b) { return a + b; }, err);
+	ENFORCE(err == nullptr && sum == serial, "Bad reduce: %li, expected %li", sum, serial);
+
+	Ox::Parallel::for_each(pool, items.span(), [](long &v) { v *= 2; }, err);
+	ENFORCE(items[5] == ((5 * 7919) % 100'003) * 2, "Bad for_each");
+
+	Ox::Elastic<int> small;
+	small.resize(items.size(), err);
+	for(long i = 0; i < items.size(); i++)
+		small.push_end(0, err);
+
+	Ox::Parallel::transform(pool, items.span(), small.span(), [](long v) { return (int)(v & 1); }, err);
+	long odd = Ox::Parallel::reduce(pool, small.span(), 0L, [](long a, int b) { return a + b; }, err);
+	ENFORCE(err == nullptr && odd == 0, "Bad transform");
+
+	Ox::Parallel::sort(pool, items.span(), [](long a, long b) { return a > b; }, err);
+	ENFORCE(err == nullptr && std::is_sorted(items.begin(), items.end(), [](long a, long b) { return a > b; }), "Bad sort");
+
+	// The global pool first starts inside an arena and has to outlive it.
+	{
+		Ox::Arena arena;
+		Ox::ScopedAllocator scope(arena);
+		Ox::Parallel::sort(items.span(), err);
+	}
+
+	ENFORCE(err == nullptr && std::is_sorted(items.begin(), items.end()), "Bad sort on the global pool");
+	ENFORCE(Ox::Parallel::reduce(items.span(), 0L, [](long a, long b) { return a + b; }, err) == serial * 2, "Sorting lost items");
+
+	// Nested groups spawned from inside tasks, stolen across workers.
+	static std::atomic<long> leaves { 0 };
+	{
+		Ox::TaskGroup group(pool);
+		for(int i = 0; i < 16; i++)
+			group.spawn(err, [&pool](void) {
+				Ox::Error e;
+				Ox::TaskGroup inner(pool);
+				for(int j = 0; j < 64; j++)
+					inner.spawn(e, [](void) { leaves++; });
+				inner.wait();
+			});
+	}
+	ENFORCE(err == nullptr && leaves.load() == 16 * 64, "Lost tasks: %li", leaves.load());
+
+	static std::atomic<long> covered { 0 };
+	pool.parallel_for(err, 3, 100'003, [](long from, long to) {
+		covered += to - from;
+	});
+	ENFORCE(err == nullptr && covered.load() == 100'000, "parallel_for covered %li items", covered.load());
+	ENFORCE(Ox::Thread::hint_hardware_concurrency() >= 1, "No cores?");
+
+	// Idle workers park instead of napping, 'release' has to wake them up
+	// or it never joins. Whether they got that far in time isn't checked.
+	Ox::Thread::sleep(20'000);
+	pool.release();
+	ENFORCE(pool.size() == 1, "Pool still running after release");
+
+	OK();
+};
+
+void test_hashmap(void) {
+	SUPERVISE("Core/HashMap");
+
+	Ox::Error err;
+	Ox::HashMap<long, long> ints;
+
+	for(long i = 0; i < 10'000; i++)
+		ints.set(i * 31, i, err);
+	ENFORCE(err == nullptr && ints.size() == 10'000, "Couldn't insert: %s", err.c_str());
+
+	long *v = ints.find(31 * 777);
+	ENFORCE(v != nullptr && *v == 777, "Couldn't find a key");
+	ENFORCE(ints.find(32) == nullptr, "Found a missing key");
+	ENFORCE(ints.set(0, 42, err) == 0 && ints[0] == 42, "Couldn't replace a value");
+
+	// Churn enough to fill the table with tombstones.
+	long cap = ints.capacity();
+	for(long r = 0; r < 50; r++) {
+		for(long i = 0; i < 10'000; i += 2)
+			ints.remove(i * 31);
+		for(long i = 0; i < 10'000; i += 2)
+			ints.set(i * 31, i, err);
+	};
+
+	ENFORCE(err == nullptr && ints.size() == 10'000 && ints.capacity() == cap, "Tombstones made it grow: %li -> %li", cap, ints.capacity());
+
+	long sum = 0, n = 0;
+	for(auto &e : ints) {
+		sum += e.key / 31;
+		n++;
+	};
+	ENFORCE(n == 10'000 && sum == 9'999 * 10'000 / 2, "Bad iteration");
+
+	ints.at(-1, err);
+	ENFORCE(err != nullptr, "'at' should fail on a missing key");
+	err.clear();
+
+	Ox::HashMap<Ox::String, Ox::Elastic<int>> strings;
+	strings["/usr/lib"].push_end(1, err);
+	strings["/some/rather/long/path/to/something"].push_end(2, err);
+	strings["/usr/lib"].push_end(3, err);
+	ENFORCE(strings.size() == 2 && strings["/usr/lib"].size() == 2, "Bad String keys");
+	ENFORCE(strings.remove("/usr/lib") && !strings.contains("/usr/lib"), "Couldn't remove a String key");
+
+	OK();
+};
+
+void test_ring(void) {
+	SUPERVISE("Core/Ring");
+
+	Ox::Error err;
+
+	static Ox::SPSCRing<long> spsc;
+	spsc.init(100, err);
+	ENFORCE(err == nullptr && spsc.capacity() == 128, "Couldn't init: %s", err.c_str());
+
+	Ox::Thread producer;
+	producer.init(err, [](void *) {
+		long batch[7];
+		long next = 0;
+
+		while(next < 100'000) {
+			long n = 0;
+			for(; n < 7 && next + n < 100'000; n++)
+				batch[n] = next + n;
+
+			long k = spsc.push_n(batch, n);
+			if(k == 0)
+				Ox::Thread::yield();
+
+			next += k;
+		};
+	}, nullptr);
+
+	long expected = 0;
+	bool ordered = true;
+	while(expected < 100'000) {
+		long batch[5];
+		long n = spsc.pop_n(batch, 5);
+		if(n == 0)
+			Ox::Thread::yield();
+
+		for(long i = 0; i < n; i++)
+			ordered = ordered && batch[i] == expected++;
+	};
+
+	producer.join();
+	ENFORCE(ordered && spsc.size() == 0, "SPSC items came out of order");
+
+	static Ox::MPMCRing<long> mpmc;
+	static std::atomic<long> total { 0 };
+	static std::atomic<long> popped { 0 };
+	mpmc.init(64, err);
+
+	Ox::Thread threads[6];
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			for(long i = 1; i <= 20'000; i++) {
+				if(i % 3 == 0) {
+					// A nearly full ring may only take the first half.
+					long pair[2] = { i, 0 };
+					for(long k = 0; k < 2; ) {
+						long n = mpmc.push_n(pair + k, 2 - k);
+						if(n == 0)
+							Ox::Thread::yield();
+
+						k += n;
+					};
+				} else {
+					while(mpmc.push(i) == false) Ox::Thread::yield();
+				}
+			};
+		}, nullptr);
+
+	for(int t = 4; t < 6; t++)
+		threads[t].init(err, [](void *) {
+			long batch[4];
+			while(popped.load() < 4 * (20'000 + 20'000 / 3)) {
+				long n = mpmc.pop_n(batch, 4);
+				if(n == 0)
+					Ox::Thread::yield();
+
+				for(long i = 0; i < n; i++)
+					total += batch[i];
+				popped += n;
+			};
+		}, nullptr);
+
+	for(int t = 0; t < 6; t++)
+		threads[t].join();
+
+	ENFORCE(err == nullptr && total.load() == 4L * 20'000 * 20'001 / 2, "MPMC lost items: %li", total.load());
+
+	OK();
+};
+
 void test_crc32(void) {
 	SUPERVISE("Crypto/CRC32");
 	
@@ -131,6 +713,269 @@ void test_file_read(void) {
 	OK();
 };
 
+void test_file_native(void) {
+	SUPERVISE("File system/Positional and direct I/O");
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-native.bin";
+
+	Ox::FileStream::options_t options;
+	options.advice = Ox::FileStream::advice_sequential;
+
+	Ox::FileStream fs;
+	ENFORCE(fs.open(path.c_str(), Ox::out, options, err) == 0, "Couldn't open the file: %s", err.c_str());
+	ENFORCE(fs.write((Ox::u8 *)"0123456789", 10, err) == 0, "Couldn't write the file: %s", err.c_str());
+
+	// Positional writes leave the position alone, even past the end.
+	ENFORCE(fs.pwrite((Ox::u8 *)"ab", 2, 2, err) == 0 && fs.tellp() == 10, "pwrite moved the position");
+	ENFORCE(fs.pwrite((Ox::u8 *)"z", 1, 11, err) == 0, "Couldn't pwrite past the end: %s", err.c_str());
+	ENFORCE(fs.sync(err) == 0, "Couldn't sync: %s", err.c_str());
+
+	if(fs.native_handle() >= 0) {
+		// Not every file system can, e.g. some overlays.
+		if(fs.preallocate(0, 1 << 20, err) == 0)
+			ENFORCE(Ox::FS::file_size(path.c_str(), err) == 12, "Preallocation changed the size");
+
+		err.clear();
+	}
+
+	fs.close();
+
+	ENFORCE(fs.open(path.c_str(), Ox::in, err) == 0, "Couldn't reopen the file: %s", err.c_str());
+
+	char b[13] = {};
+	ENFORCE(fs.pread((Ox::u8 *)b, 12, 0, err) == 12 && std::memcmp(b, "01ab456789\0z", 12) == 0, "pread got \"%s\"", b);
+	ENFORCE(fs.tellg() == 0 && !fs.eof(err), "pread moved the position");
+	ENFORCE(fs.pread((Ox::u8 *)b, 12, 8, err) == 4, "pread past the end");
+
+	ENFORCE(fs.ignore(100, 'b', err) == 4 && fs.readU8(err) == '4', "Delimited ignore stopped in the wrong place");
+	ENFORCE(fs.ignore(100, err) == 7 && fs.eof(err), "Expecting the end of the file");
+
+	fs.seekg(-1, Ox::seekdir::end);
+	ENFORCE(fs.readU8(err) == 'z' && err == nullptr, "Couldn't seek back from the end: %s", err.c_str());
+	fs.close();
+
+	// tmpfs and a few others refuse O_DIRECT altogether.
+	options.direct = true;
+	if(fs.open(path.c_str(), (Ox::openmode)(Ox::in | Ox::out), options, err) == 0) {
+		Ox::u8 *block = (Ox::u8 *)std::aligned_alloc(Ox::FileStream::direct_alignment, Ox::FileStream::direct_alignment);
+		std::memset(block, 'd', Ox::FileStream::direct_alignment);
+
+		ENFORCE(fs.pwrite(block, Ox::FileStream::direct_alignment, 0, err) == 0, "Direct write failed: %s", err.c_str());
+		ENFORCE(fs.pread(block, Ox::FileStream::direct_alignment, 0, err) == (long)Ox::FileStream::direct_alignment && block[100] == 'd',
+			"Direct read failed: %s", err.c_str());
+
+		ENFORCE(fs.pwrite(block, 3, 0, err) == -1, "Misaligned direct write went through");
+		std::free(block);
+	}
+
+	err.clear();
+	fs.close();
+
+	OK();
+};
+
+void test_file_vectored(void) {
+	SUPERVISE("File system/Vectored I/O");
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-vectored.bin";
+
+	Ox::u8 header[4] = { 'O', 'X', 0, 3 };
+	Ox::u8 payload[300];
+	for(int i = 0; i < 300; i++)
+		payload[i] = i & 0xff;
+
+	// More slices than one batch, a few of them empty.
+	Ox::io_slice_t out[100];
+	out[0] = { header, sizeof(header) };
+	for(int i = 1; i < 100; i++)
+		out[i] = { payload + (i - 1) * 3, (Ox::ulong)(i % 7 == 0 ? 0 : 3) };
+
+	Ox::FileStream fs;
+	ENFORCE(fs.open(path.c_str(), Ox::out, err) == 0, "Couldn't open the file: %s", err.c_str());
+	ENFORCE(fs.writev(out, 100, err) == 0, "Couldn't writev: %s", err.c_str());
+
+	Ox::ulong total = fs.tellp();
+	ENFORCE(total == 4 + 3 * 85, "Expecting %d bytes, got %lu", 4 + 3 * 85, total);
+
+	Ox::io_slice_t patch[2] = { { (Ox::u8 *)"P", 1 }, { (Ox::u8 *)"Q", 1 } };
+	ENFORCE(fs.pwritev(patch, 2, 1, err) == 0 && fs.tellp() == total, "pwritev moved the position");
+	fs.close();
+
+	ENFORCE(fs.open(path.c_str(), Ox::in, err) == 0, "Couldn't reopen the file: %s", err.c_str());
+
+	Ox::u8 h[4];
+	Ox::u8 rest[512];
+	Ox::io_slice_t in[3] = { { h, 4 }, { nullptr, 0 }, { rest, sizeof(rest) } };
+
+	// Runs out in the last slice.
+	ENFORCE(fs.readv(in, 3, err) == (long)total && fs.eof(err), "Short readv didn't stop at the end: %s", err.c_str());
+	ENFORCE(h[0] == 'O' && h[1] == 'P' && h[2] == 'Q' && h[3] == 3, "Header didn't come back patched");
+	ENFORCE(rest[0] == 0 && rest[5] == 5 && rest[18] == 21, "Payload came back scrambled");
+
+	Ox::u8 b[2];
+	Ox::io_slice_t one[1] = { { b, 2 } };
+	ENFORCE(fs.preadv(one, 1, 5, err) == 2 && b[0] == 1 && b[1] == 2, "preadv read the wrong bytes");
+	ENFORCE(fs.readv(nullptr, 1, err) == -1, "NULL slices went unnoticed");
+	err.clear();
+	fs.close();
+
+	// A whole batch of empty slices ahead of the data.
+	Ox::io_slice_t sparse[65] = {};
+	Ox::u8 z = 'z';
+	sparse[64] = { &z, 1 };
+
+	ENFORCE(fs.open(path.c_str(), Ox::out, err) == 0 && fs.writev(sparse, 65, err) == 0 && fs.tellp() == 1,
+		"Empty slices stopped writev: %s", err.c_str());
+	fs.close();
+
+	z = 0;
+	ENFORCE(fs.open(path.c_str(), Ox::in, err) == 0 && fs.readv(sparse, 65, err) == 1 && z == 'z',
+		"Empty slices stopped readv: %s", err.c_str());
+	fs.close();
+
+	// Streams without native support loop over the slices.
+	Ox::MemoryStream ms;
+	ENFORCE(ms.writev(out, 100, err) == 0 && ms.size() == total, "MemoryStream writev failed: %s", err.c_str());
+
+	ms.seekg(0);
+	ENFORCE(ms.readv(in, 3, err) == (long)total && h[1] == 'X' && rest[5] == 5, "MemoryStream readv failed: %s", err.c_str());
+
+	OK();
+};
+
+static void async_count(Ox::AsyncIO::request_t &r, void *user) {
+	if(r.result == (long)r.length)
+		(*(int *)user)++;
+};
+
+typedef struct async_chain_t {
+	Ox::AsyncIO *io;
+	int file;
+	int queued;
+	int finished;
+	Ox::AsyncIO::request_t requests[64];
+	Ox::u8 buffers[64][16];
+} async_chain_t;
+
+// Queues two more reads per completion, past the depth.
+static void async_chain(Ox::AsyncIO::request_t &r, void *user) {
+	async_chain_t *c = (async_chain_t *)user;
+	c->finished += r.result == 16;
+
+	// Claimed before queueing, since queueing may run this again.
+	for(int i = 0; i < 2 && c->queued < 64; i++) {
+		int at = c->queued++;
+		Ox::Error err;
+
+		c->requests[at].callback = async_chain;
+		c->requests[at].user = c;
+		c->io->read(c->requests[at], c->file, c->buffers[at], 16, at * 16, err);
+	};
+};
+
+void test_async(void) {
+	SUPERVISE("IO/Asynchronous I/O");
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-async.bin";
+
+	Ox::AsyncIO::backend_t backends[2] = { Ox::AsyncIO::backend_none, Ox::AsyncIO::backend_threads };
+
+	for(int b = 0; b < 2; b++) {
+		// Shallower than the batches below, queueing has to reap.
+		Ox::AsyncIO::options_t options;
+		options.depth = 4;
+		options.backend = backends[b];
+
+		Ox::AsyncIO io;
+		ENFORCE(io.init(options, err) == 0 && io.backend() != Ox::AsyncIO::backend_none, "Couldn't init: %s", err.c_str());
+
+		int out = io.open(path.c_str(), Ox::out, err);
+		ENFORCE(out >= 0, "Couldn't open the file: %s", err.c_str());
+
+		static Ox::u8 blocks[16][512];
+		Ox::AsyncIO::request_t writes[16];
+		int written = 0;
+
+		for(int i = 0; i < 16; i++) {
+			std::memset(blocks[i], 'a' + i, sizeof(blocks[i]));
+			writes[i].callback = async_count;
+			writes[i].user = &written;
+
+			io.write(writes[i], out, blocks[i], sizeof(blocks[i]), i * sizeof(blocks[i]), err);
+			ENFORCE(io.pending() <= 4, "%u requests pending, past the depth", io.pending());
+		};
+
+		ENFORCE(io.drain(err) == 0 && written == 16, "Only %d writes went through: %s", written, err.c_str());
+
+		Ox::AsyncIO::request_t sync;
+		ENFORCE(io.fsync(sync, out, err) == 0 && io.wait(sync, err) == 0, "Couldn't sync: %s", err.c_str());
+		io.close(out);
+
+		int in = io.open(path.c_str(), Ox::in, err);
+		ENFORCE(in >= 0, "Couldn't reopen the file: %s", err.c_str());
+
+		// Futures, read back in reverse into a registered buffer.
+		static Ox::u8 back[16 * 512];
+		Ox::io_slice_t registered = { back, sizeof(back) };
+		ENFORCE(io.register_buffers(&registered, 1, err) == 0, "Couldn't register the buffer: %s", err.c_str());
+
+		Ox::AsyncIO::request_t reads[16];
+		for(int i = 15; i >= 0; i--)
+			io.read(reads[i], in, back + i * 512, 512, i * 512, err);
+
+		ENFORCE(io.submit(err) >= 0 && reads[3].buffer == 0, "Couldn't submit: %s", err.c_str());
+
+		for(int i = 0; i < 16; i++)
+			ENFORCE(io.wait(reads[i], err) == 512 && back[i * 512 + 100] == 'a' + i, "Block %d came back wrong: %s", i, err.c_str());
+
+		// Past the end, outside the registered buffer.
+		Ox::u8 tail[1024];
+		Ox::AsyncIO::request_t last;
+		io.read(last, in, tail, sizeof(tail), 15 * 512, err);
+		ENFORCE(io.wait(last, err) == 512 && last.buffer == -1 && tail[511] == 'p', "Expecting a short read: %s", err.c_str());
+
+		ENFORCE(io.unregister_buffers(err) == 0, "Couldn't unregister the buffer: %s", err.c_str());
+
+		// Callbacks queueing past the depth reap from inside a reap.
+		{
+			Ox::AsyncIO::options_t shallow;
+			shallow.depth = 2;
+			shallow.backend = io.backend();
+
+			Ox::AsyncIO chained;
+			ENFORCE(chained.init(shallow, err) == 0, "Couldn't init: %s", err.c_str());
+
+			static async_chain_t c;
+			c = async_chain_t();
+			c.io = &chained;
+			c.file = in;
+			c.queued = 1;
+			c.requests[0].callback = async_chain;
+			c.requests[0].user = &c;
+
+			chained.read(c.requests[0], in, c.buffers[0], 16, 0, err);
+			ENFORCE(chained.drain(err) == 0 && chained.pending() == 0, "Drain failed with %u pending: %s", chained.pending(), err.c_str());
+			ENFORCE(c.finished == 64 && c.buffers[63][0] == 'a' + 63 * 16 / 512, "%d of 64 chained reads finished", c.finished);
+		}
+
+		io.close(in);
+
+		Ox::AsyncIO::request_t bad;
+		io.read(bad, -1, tail, 1, 0, err);
+		ENFORCE(io.wait(bad, err) == -1 && bad.code == EBADF && err != nullptr, "Reading a bad descriptor went through");
+		err.clear();
+
+		Ox::AsyncIO::request_t idle;
+		ENFORCE(io.wait(idle, err) == -1 && err != nullptr && io.pending() == 0, "Waited on a request never queued");
+		err.clear();
+	};
+
+	OK();
+};
+
 void test_dir_read(void) {
 	SUPERVISE("File system/Read directory");
 
@@ -150,6 +995,200 @@ void test_dir_read(void) {
 	OK();
 };
 
+void test_buffered(void) {
+	SUPERVISE("File system/Buffered streams");
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-buffered.bin";
+
+	static Ox::u8 big[300];
+	for(int i = 0; i < 300; i++)
+		big[i] = (Ox::u8)(i * 7);
+
+	{
+		Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+		ENFORCE(err == nullptr, "Couldn't open the file: %s", err.c_str());
+
+		// Odd and tiny, so fixed-width values straddle every flush.
+		Ox::BufferedWriter w;
+		w.init(fs, 7, err);
+
+		for(Ox::u32 i = 0; i < 1000; i++) {
+			w.writeU8((Ox::u8)i, err);
+			w.writeU16BE((Ox::u16)(i * 3), err);
+			w.writeU32LE(i * 100003, err);
+			w.writeI64BE(-(Ox::i64)i, err);
+		};
+
+		w.write(big, sizeof(big), err);
+		w.write((Ox::u8 *)"line\nrest", 9, err);
+		ENFORCE(w.tellp() == 1000 * 15 + 300 + 9, "Writer is at %lu", w.tellp());
+		ENFORCE(w.flush(err) == 0 && w.buffered() == 0, "Couldn't flush: %s", err.c_str());
+
+		Ox::u8 c;
+		ENFORCE(w.read(&c, 1, err) == -1 && err != nullptr, "Read from a writer");
+		err.clear();
+	}
+
+	Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::in, err);
+	ENFORCE(err == nullptr, "Couldn't open the file: %s", err.c_str());
+
+	Ox::BufferedReader r;
+	r.init(fs, 5, err);
+
+	for(Ox::u32 i = 0; i < 1000; i++) {
+		Ox::u8 a = r.readU8(err);
+		Ox::u16 b = r.readU16BE(err);
+		Ox::u32 c = r.readU32LE(err);
+		Ox::i64 d = r.readI64BE(err);
+
+		ENFORCE(err == nullptr && a == (Ox::u8)i && b == (Ox::u16)(i * 3) && c == i * 100003 && d == -(Ox::i64)i,
+			"Bad value around item %u: %s", i, err.c_str());
+	};
+
+	ENFORCE(r.tellg() == 1000 * 15, "Reader is at %lu", r.tellg());
+
+	// Back and forth within the buffer, then a read bigger than it.
+	r.seekg(2, Ox::seekdir::cur);
+	r.seekg(-2, Ox::seekdir::cur);
+
+	static Ox::u8 back[300];
+	ENFORCE(r.read(back, sizeof(back), err) == 300 && std::memcmp(back, big, 300) == 0, "Big read doesn't match");
+
+	r.seekg(1000 * 15 + 301);
+	ENFORCE(r.readU8(err) == 'i', "Absolute seek went astray");
+	r.seekg(1000 * 15 + 300);
+
+	ENFORCE(r.ignore(100, '\n', err) == 5, "Delimited ignore stopped in the wrong place");
+	ENFORCE(!r.eof(err) && r.readU32BE(err) == ((Ox::u32)'r' << 24 | 'e' << 16 | 's' << 8 | 't'), "Lost the tail");
+	ENFORCE(r.eof(err) && err == nullptr, "Expecting the end of the stream");
+
+	(void)r.readU16LE(err);
+	ENFORCE(err != nullptr, "Short read went unnoticed");
+	err.clear();
+
+	OK();
+};
+
+void test_memstream(void) {
+	SUPERVISE("IO/Memory stream");
+
+	Ox::Error err;
+	Ox::MemoryStream ms;
+
+	for(Ox::u32 i = 0; i < 1000; i++)
+		ms.writeU32BE(i, err);
+
+	ENFORCE(err == nullptr && ms.size() == 4000 && ms.tellp() == 4000, "Growing writes failed: %s", err.c_str());
+
+	// Overwrites in place, then grows past the end.
+	ms.seekp(-8, Ox::seekdir::end);
+	ms.writeU64LE(0x1122334455667788ull, err);
+	ms.writeU8(0xff, err);
+	ENFORCE(ms.size() == 4001, "Expecting 4001 bytes, got %lu", ms.size());
+
+	ms.seekg(4 * 500);
+	ENFORCE(ms.readU32BE(err) == 500, "Read the wrong value back");
+	ms.seekg(-9, Ox::seekdir::end);
+	ENFORCE(ms.readU64LE(err) == 0x1122334455667788ull && ms.readU8(err) == 0xff && ms.eof(err), "Overwrite went astray");
+
+	Ox::u8 b;
+	ENFORCE(ms.read(&b, 1, err) == 0 && err == nullptr, "Read past the end");
+
+	Ox::Span<Ox::u8> v = ms.view(4, 4, err);
+	ENFORCE(v.size() == 4 && v[3] == 1, "Bad view");
+	ms.view(3998, 4, err);
+	ENFORCE(err != nullptr, "View out of bonds went unnoticed");
+	err.clear();
+
+	// Fixed caller buffer: overwritten, never grown.
+	Ox::u8 fixed[6] = {};
+	ms.open(fixed, sizeof(fixed), err);
+	ms.writeU32LE(0xdeadbeef, err);
+	ENFORCE(err == nullptr && fixed[0] == 0xef && fixed[3] == 0xde, "Didn't write to the caller's buffer");
+	ENFORCE(ms.writeU32LE(0, err) == -1, "Wrote past the caller's buffer");
+	err.clear();
+
+	const char *text = "The quick brown fox jumps over the lazy dog";
+	ms.open((const Ox::u8 *)text, std::strlen(text), err);
+	ENFORCE(ms.writeU8(0, err) == -1, "Wrote to a read-only buffer");
+	err.clear();
+
+	ENFORCE(ms.ignore(100, ' ', err) == 4 && ms.readU8(err) == 'q', "Delimited ignore stopped in the wrong place");
+
+	Ox::CRC32 crc;
+	Ox::Span<Ox::u8> all = ms.view(0, ms.size(), err);
+	crc.update(all.data(), all.size());
+	ENFORCE(crc.digest() == 0x414fa339, "CRC over a view doesn't match");
+
+	// Caller's Elastic, fed from itself.
+	Ox::Elastic<Ox::u8> bytes;
+	ms.open(bytes, err);
+	ms.write((Ox::u8 *)"abc", 3, err);
+	ms.write(bytes.begin(), 3, err);
+	ENFORCE(err == nullptr && bytes.size() == 6 && std::memcmp(bytes.begin(), "abcabc", 6) == 0, "Elastic isn't \"abcabc\"");
+
+	OK();
+};
+
+void test_mapped(void) {
+	SUPERVISE("IO/Mapped file");
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-mapped.bin";
+	Ox::FS::rm(path.c_str(), err);
+	err.clear();
+
+	#ifdef OX_DISABLE_MMAP
+		Ox::MappedFileStream off;
+		ENFORCE(off.open(path.c_str(), Ox::out, err) == -1 && err != nullptr
+			&& std::strcmp(err.c_str(), "Flag OX_DISABLE_MMAP is set") == 0, "Mapped a file with OX_DISABLE_MMAP set");
+
+		OK();
+		return;
+	#endif
+
+	{
+		Ox::MappedFileStream ms;
+		ENFORCE(ms.open(path.c_str(), Ox::out, err) == 0 && ms.size() == 0, "Couldn't map a new file: %s", err.c_str());
+		ENFORCE(ms.writeU8(1, err) == -1, "Wrote past the end of the file");
+		err.clear();
+
+		ENFORCE(ms.resize(8, err) == 0 && ms.size() == 8, "Couldn't grow the file: %s", err.c_str());
+		ms.writeU64BE(0x0102030405060708ull, err);
+		ENFORCE(ms.sync(err) == 0, "Couldn't sync: %s", err.c_str());
+	}
+
+	ENFORCE(Ox::FS::file_size(path.c_str(), err) == 8, "The file should hold 8 bytes");
+
+	// The QOI sample, decoded straight from the mapping and from a view of it.
+	Ox::MappedFileStream::options_t options;
+	options.advice = Ox::MappedFileStream::advice_sequential;
+	options.huge_pages = true;
+
+	Ox::MappedFileStream qs;
+	ENFORCE(qs.open("./cost-cor.qoi", Ox::in, options, err) == 0, "Couldn't map the .qoi example file: %s", err.c_str());
+	ENFORCE(qs.writeU8(0, err) == -1, "Wrote to a read-only mapping");
+	err.clear();
+
+	Ox::Media::QOI::params_t a = Ox::Media::QOI::decode(qs, err, false);
+	ENFORCE(err == nullptr && a.width > 0, "QOI decode from a mapping failed: %s", err.c_str());
+
+	Ox::Span<Ox::u8> v = qs.view(0, qs.size(), err);
+	Ox::MemoryStream ms;
+	ms.open((const Ox::u8 *)v.data(), v.size(), err);
+
+	Ox::Media::QOI::params_t b = Ox::Media::QOI::decode(ms, err, false);
+	ENFORCE(err == nullptr && a.width == b.width && a.height == b.height
+		&& std::memcmp(a.pixels, b.pixels, (Ox::ulong)a.width * a.height * sizeof(Ox::rgba32p_t)) == 0,
+		"Decoding from memory and from the mapping disagree: %s", err.c_str());
+
+	Ox::exhale(a.pixels);
+	Ox::exhale(b.pixels);
+
+	OK();
+};
+
 void test_qoi_read(void) {
 	SUPERVISE("Codec/QOI");
 
@@ -171,18 +1210,542 @@ void test_qoi_read(void) {
 	OK();
 };
 
+void test_thread(void) {
+	SUPERVISE("Core/Thread");
+
+	Ox::Error err;
+	static std::atomic<long> runs { 0 };
+	static std::atomic<Ox::pointer_t> seen { 0 };
+
+	Ox::Thread::callable_t f = [](void *user) {
+		seen = (Ox::pointer_t)user;
+		runs++;
+	};
+
+	Ox::Thread::options_t named;
+	named.name = "ox-test-worker-with-a-long-name";
+	named.cpu = 0;
+
+	Ox::Thread t;
+	t.init(err, f, (void *)0x1234, named);
+	ENFORCE(err == nullptr, "Couldn't start a named, pinned thread: %s", err.c_str());
+	ENFORCE(t.init(err, f, nullptr) == -1, "Started a thread twice");
+	err.clear();
+
+	t.join();
+	t.join();
+	ENFORCE(runs.load() == 1 && seen.load() == 0x1234, "Thread didn't run once with its argument");
+
+	// Options that can't be honoured never let 'f' run.
+	Ox::Thread::options_t bad;
+	bad.cpu = 1 << 20;
+	ENFORCE(t.init(err, f, nullptr, bad) == -1 && err != nullptr, "Pinned a thread to a missing CPU");
+	err.clear();
+
+	bad = Ox::Thread::options_t();
+	bad.policy = Ox::Thread::sched_fifo;
+	bad.priority = -5;
+	ENFORCE(t.init(err, f, nullptr, bad) == -1 && err != nullptr, "Accepted an invalid priority");
+	err.clear();
+	ENFORCE(runs.load() == 1, "Thread ran despite failed options");
+
+	Ox::Thread::options_t big;
+	big.stack_size = 4 << 20;
+	if(t.init(err, f, nullptr, big) == 0)
+		t.join();
+	else
+		err.clear();	// std::thread can't size stacks.
+
+	// The destructor joins.
+	{
+		Ox::Thread scoped;
+		scoped.init(err, f, nullptr);
+	}
+
+	ENFORCE(err == nullptr && runs.load() >= 2, "Thread wasn't joined on destruction");
+
+	ENFORCE(Ox::Thread::set_name("ox-test", err) == 0, "Couldn't name the main thread: %s", err.c_str());
+
+	OK();
+};
+
+void test_threadlocal(void) {
+	SUPERVISE("Core/ThreadLocal");
+
+	Ox::Error err;
+	static std::atomic<long> folded { 0 };
+	static std::atomic<long> running { 0 };
+
+	{
+		static Ox::ThreadLocal<long> *counts;
+		Ox::ThreadLocal<long> local([](long &value, void *) {
+			folded += value;
+		}, nullptr);
+		counts = &local;
+
+		ENFORCE(local.peek() == nullptr && local.size() == 0, "ThreadLocal built a value too early");
+
+		Ox::Thread threads[4];
+		for(int t = 0; t < 4; t++)
+			threads[t].init(err, [](void *) {
+				Ox::Error err;
+
+				for(int i = 0; i < 1000; i++)
+					(*counts->get(err))++;
+
+				// Keep every thread alive until all of them made a value.
+				running++;
+				while(running.load() < 4)
+					Ox::Thread::yield();
+			}, nullptr);
+
+		while(running.load() < 4)
+			Ox::Thread::yield();
+
+		for(int t = 0; t < 4; t++)
+			threads[t].join();
+
+		ENFORCE(folded.load() == 4000 && local.size() == 0, "Values weren't folded at join: %li", folded.load());
+
+		long *mine = local.get(err);
+		*mine = 7;
+		ENFORCE(err == nullptr && local.get(err) == mine && local.peek() == mine && local.size() == 1, "ThreadLocal isn't stable");
+
+		long sum = 0;
+		local.for_each([&sum](long &value) {
+			sum += value;
+		});
+		ENFORCE(sum == 7, "for_each missed values: %li", sum);
+	}
+
+	ENFORCE(folded.load() == 4007, "Values weren't dropped with their ThreadLocal");
+
+	// Ids get recycled, slots must not leak into the next ThreadLocal.
+	for(int i = 0; i < 3; i++) {
+		Ox::ThreadLocal<long> again;
+		ENFORCE(again.peek() == nullptr && *again.get(err) == 0, "ThreadLocal saw a stale value");
+		*again.get(err) = 42;
+	};
+
+	OK();
+};
+
+void test_sync(void) {
+	SUPERVISE("Core/Sync");
+
+	Ox::Error err;
+	Ox::Stats::wait_snapshot_t before = Ox::Stats::wait_snapshot();
+
+	// Bounded queue of one slot, guarded by a Mutex and two CondVars.
+	static Ox::Mutex m;
+	static Ox::CondVar not_empty, not_full;
+	static long slot, filled;
+
+	Ox::Thread producer;
+	producer.init(err, [](void *) {
+		Ox::Error err;
+
+		for(long i = 1; i <= 2000; i++) {
+			m.lock(err);
+			while(filled)
+				not_full.wait(m, err);
+
+			slot = i;
+			filled = 1;
+			m.unlock(err);
+			not_empty.notify_one();
+		};
+	}, nullptr);
+
+	long sum = 0;
+	for(long i = 1; i <= 2000; i++) {
+		m.lock(err);
+		while(!filled)
+			not_empty.wait(m, err);
+
+		sum += slot;
+		filled = 0;
+		m.unlock(err);
+		not_full.notify_one();
+	};
+
+	producer.join();
+	ENFORCE(err == nullptr && sum == 2000 * 2001 / 2, "CondVar lost items: %li", sum);
+
+	m.lock(err);
+	int timed_out = not_empty.wait_for(m, 1000, err);
+	m.unlock(err);
+	ENFORCE(err == nullptr && timed_out == 1, "CondVar didn't time out");
+
+	static Ox::Semaphore items;
+	static Ox::Latch done(4);
+	static std::atomic<long> consumed { 0 };
+
+	Ox::Thread threads[4];
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			Ox::Error err;
+
+			for(int i = 0; i < 500; i++) {
+				items.acquire(err);
+				consumed++;
+			};
+
+			done.count_down();
+		}, nullptr);
+
+	for(int i = 0; i < 4 * 500; i += 50)
+		items.release(50);
+
+	done.wait(err);
+	ENFORCE(err == nullptr && done.try_wait() && consumed.load() == 2000, "Semaphore lost items: %li", consumed.load());
+	ENFORCE(items.try_acquire() == false && items.acquire_for(1000, err) == 1, "Semaphore didn't time out");
+
+	for(int t = 0; t < 4; t++)
+		threads[t].join();
+
+	// Every round, all threads must see every write made before the barrier.
+	static Ox::Barrier barrier(4);
+	static std::atomic<long> round_sum { 0 };
+	static std::atomic<long> leaders { 0 };
+	static std::atomic<long> mismatches { 0 };
+
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			Ox::Error err;
+
+			for(long r = 1; r <= 50; r++) {
+				round_sum += r;
+				leaders += barrier.arrive_and_wait(err);
+
+				if(round_sum.load() != 4 * r * (r + 1) / 2)
+					mismatches++;
+
+				barrier.arrive_and_wait(err);
+			};
+		}, nullptr);
+
+	for(int t = 0; t < 4; t++)
+		threads[t].join();
+
+	ENFORCE(mismatches.load() == 0 && leaders.load() == 50, "Barrier let threads through early");
+
+	static Ox::Event go;
+	static Ox::Event once(true);
+	static std::atomic<long> woken { 0 };
+
+	ENFORCE(go.wait_for(1000, err) == 1 && !go.is_set(), "Event didn't time out");
+
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			Ox::Error err;
+
+			go.wait(err);
+			once.wait(err);
+			woken++;
+		}, nullptr);
+
+	go.set();
+	for(int i = 0; i < 4; i++) {
+		once.set();
+		while(woken.load() <= i)
+			Ox::Thread::yield();
+	};
+
+	for(int t = 0; t < 4; t++)
+		threads[t].join();
+
+	ENFORCE(err == nullptr && go.is_set() && !once.is_set() && woken.load() == 4, "Event woke %li threads", woken.load());
+
+	ENFORCE(m.lock(err) == 0 && m.lock(err) == -1, "Mutex relocked by its owner");
+	err.clear();
+	ENFORCE(m.try_lock(err) && m.unlock(err) == 0 && m.unlock(err) == -1, "Mutex unlocked twice");
+	err.clear();
+
+	static long guarded = 0;
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			Ox::Error err;
+
+			for(int i = 0; i < 20'000; i++) {
+				m.lock(err);
+				guarded++;
+				m.unlock(err);
+			};
+		}, nullptr);
+
+	for(int t = 0; t < 4; t++)
+		threads[t].join();
+
+	ENFORCE(err == nullptr && guarded == 80'000, "Mutex let threads in together: %li", guarded);
+
+	// Writers keep both halves equal, readers must never see them apart.
+	static Ox::RWLock rw;
+	static long halves[2];
+	static std::atomic<long> torn { 0 };
+
+	ENFORCE(rw.try_write_lock() && !rw.try_read_lock() && !rw.try_write_lock(), "RWLock let a reader past a writer");
+	rw.write_unlock();
+	ENFORCE(rw.try_read_lock() && rw.try_read_lock() && !rw.try_write_lock(), "RWLock let a writer past readers");
+	rw.read_unlock();
+	rw.read_unlock();
+
+	for(int t = 0; t < 4; t++)
+		threads[t].init(err, [](void *) {
+			Ox::Error err;
+
+			for(int i = 0; i < 20'000; i++) {
+				if(i % 8 == 0) {
+					rw.write_lock(err);
+					halves[0]++;
+					halves[1]++;
+					rw.write_unlock();
+				} else {
+					rw.read_lock(err);
+					if(halves[0] != halves[1])
+						torn++;
+					rw.read_unlock();
+				}
+			};
+		}, nullptr);
+
+	for(int t = 0; t < 4; t++)
+		threads[t].join();
+
+	ENFORCE(err == nullptr && torn.load() == 0 && halves[0] == 4 * 2500, "RWLock let a reader see a partial write");
+
+	Ox::Stats::wait_snapshot_t after = Ox::Stats::wait_snapshot();
+	ENFORCE(after.kinds[Ox::Stats::wait_condvar].timeouts > before.kinds[Ox::Stats::wait_condvar].timeouts
+		&& after.kinds[Ox::Stats::wait_semaphore].timeouts > before.kinds[Ox::Stats::wait_semaphore].timeouts
+		&& after.kinds[Ox::Stats::wait_event].waits > before.kinds[Ox::Stats::wait_event].waits,
+		"Waits weren't accounted for");
+
+	OK();
+};
+
+#ifdef OX_USE_COROUTINES
+	#include <unistd.h>
+
+	static Ox::Task<long> task_fib(long n) {
+		if(n < 2)
+			co_return n;
+
+		long a = co_await task_fib(n - 1);
+		long b = co_await task_fib(n - 2);
+		co_return a + b;
+	};
+
+	static Ox::Elastic<int> task_order;
+	static std::atomic<long> task_hops { 0 };
+
+	static Ox::Task<void> task_sleeper(Ox::Executor &e, int id, Ox::ulong us) {
+		Ox::Error err;
+		if(co_await e.sleep_for(us, err) == 0)
+			task_order.push_end(id, err);
+	};
+
+	static Ox::Task<void> task_reader(Ox::Executor &e, int fd) {
+		Ox::Error err;
+		char c = 0;
+
+		if(co_await e.readable(fd, err) == 0 && read(fd, &c, 1) == 1)
+			task_order.push_end(c, err);
+	};
+
+	static Ox::Task<void> task_writer(Ox::Executor &e, int fd) {
+		Ox::Error err;
+		co_await e.sleep_for(2000, err);
+
+		char c = 'w';
+		if(write(fd, &c, 1) != 1)
+			task_order.push_end(-1, err);
+	};
+
+	static Ox::Task<void> task_hopper(Ox::Executor &e) {
+		for(int i = 0; i < 10; i++) {
+			co_await e.schedule();
+			task_hops++;
+		};
+	};
+#endif
+
+void test_task(void) {
+	SUPERVISE("Core/Task");
+
+	#ifdef OX_USE_COROUTINES
+		Ox::Error err;
+
+		{
+			Ox::Task<long> t = task_fib(15);
+			ENFORCE(!t.is_done(), "Task started eagerly");
+		}
+
+		Ox::Executor e;
+		e.init(err);
+		ENFORCE(err == nullptr, "Couldn't init the executor: %s", err.c_str());
+
+		int fds[2];
+		ENFORCE(pipe(fds) == 0, "Couldn't create a pipe");
+
+		e.spawn(err, task_sleeper(e, 3, 6000));
+		e.spawn(err, task_sleeper(e, 1, 1000));
+		e.spawn(err, task_reader(e, fds[0]));
+		e.spawn(err, task_writer(e, fds[1]));
+		e.spawn(err, task_sleeper(e, 2, 4000));
+		e.run(err);
+
+		close(fds[0]);
+		close(fds[1]);
+
+		ENFORCE(err == nullptr && task_order.size() == 4
+			&& task_order[0] == 1 && task_order[1] == 'w' && task_order[2] == 2 && task_order[3] == 3,
+			"Timers or readiness fired out of order");
+
+		Ox::Error bad;
+		ENFORCE(e.spawn(bad, Ox::Task<void>()) == -1, "Spawned an empty task");
+
+		e.release();
+
+		Ox::Executor pool;
+		pool.init(err, 3);
+
+		for(int i = 0; i < 50; i++)
+			pool.spawn(err, task_hopper(pool));
+
+		pool.run(err);
+		ENFORCE(err == nullptr && task_hops.load() == 500, "Tasks got lost hopping threads: %li", task_hops.load());
+
+		// Awaited from a spawned task, the result comes back through the chain.
+		static long fib = 0;
+		pool.spawn(err, []() -> Ox::Task<void> {
+			fib = co_await task_fib(12);
+		}());
+		pool.run(err);
+		ENFORCE(fib == 144, "Nested tasks returned %li", fib);
+	#endif
+
+	OK();
+};
+
+void test_clock(void) {
+	SUPERVISE("Core/Clock");
+
+	Ox::u64 a = Ox::Clock::now();
+	Ox::Stopwatch sw;
+	Ox::Thread::sleep(2000);
+	Ox::u64 b = Ox::Clock::now();
+
+	ENFORCE(b > a, "Clock went backwards: %llu then %llu", (unsigned long long)a, (unsigned long long)b);
+	ENFORCE(b - a >= 1500000 && b - a < 2000000000, "Slept 2ms, measured %llu ns", (unsigned long long)(b - a));
+	ENFORCE(sw.elapsed_us() >= 1500, "Stopwatch measured %llu us", (unsigned long long)sw.elapsed_us());
+	ENFORCE(Ox::Clock::ticks_per_ns() > 0, "Uncalibrated clock");
+
+	// Stopped spans don't count.
+	sw.stop();
+	Ox::u64 stopped = sw.elapsed_ns();
+	Ox::Thread::sleep(2000);
+	ENFORCE(sw.elapsed_ns() == stopped, "Stopped stopwatch kept running");
+
+	sw.start();
+	Ox::Thread::sleep(1000);
+	sw.stop();
+	ENFORCE(sw.elapsed_ns() >= stopped + 500000, "Stopwatch lost a span");
+
+	sw.reset();
+	ENFORCE(!sw.is_running() && sw.elapsed_ns() == 0, "Reset stopwatch isn't zero");
+
+	OK();
+};
+
+void test_profile(void) {
+	SUPERVISE("Core/Profile");
+
+	Ox::Profile::clear();
+	ENFORCE(Ox::Profile::count() == 0, "Cleared profile still has zones");
+
+	{
+		Ox::Profile::Zone outer("test/outer");
+
+		auto worker = [](void *user) -> void {
+			(void)user;
+
+			// Spills over more than one chunk.
+			for(int i = 0; i < 3000; i++) {
+				Ox::Profile::Zone z("test/\"worker\"");
+			};
+		};
+
+		Ox::Error err;
+		Ox::Thread t[2];
+		for(int i = 0; i < 2; i++)
+			t[i].init(err, worker, nullptr);
+		for(int i = 0; i < 2; i++)
+			t[i].join();
+	}
+
+	ENFORCE(Ox::Profile::count() == 6001, "Expecting 6001 zones, got %llu", (unsigned long long)Ox::Profile::count());
+
+	Ox::Error err;
+	Ox::String path = Ox::FS::temp_path(err) + "/ox-trace.json";
+	Ox::FileStream fs = Ox::FS::open(path.c_str(), Ox::out, err);
+	ENFORCE(Ox::Profile::dump_json(fs, err) == 0, "Couldn't write the trace: %s", err.c_str());
+	fs.close();
+
+	static char json[1 << 20];
+	Ox::FileStream rs = Ox::FS::open(path.c_str(), Ox::in, err);
+	long n = rs.read((Ox::u8 *)json, sizeof(json) - 1, err);
+	rs.close();
+
+	ENFORCE(n > 0, "Couldn't read the trace back");
+	json[n] = '\0';
+
+	ENFORCE(std::strncmp(json, "{\"traceEvents\":[{", 17) == 0 && std::strcmp(json + n - 2, "]}") == 0,
+		"Malformed trace");
+	ENFORCE(std::strstr(json, "\"name\":\"test/outer\",\"cat\":\"ox\",\"ph\":\"X\"") != nullptr, "Outer zone is missing");
+	ENFORCE(std::strstr(json, "\"name\":\"test/\\\"worker\\\"\"") != nullptr, "Names aren't escaped");
+
+	Ox::Profile::clear();
+	ENFORCE(Ox::Profile::count() == 0, "Cleared profile still has zones");
+
+	OK();
+};
+
 int main(void) {
 	std::printf("\x1b[0m");
 
 	test_endian();
+	test_atomic();
+	test_arena();
+	test_pool();
+	test_alloc_stats();
+	test_string();
+	test_string_simd();
+	test_string_builder();
+	test_atom();
+	test_elastic();
+	test_parallel();
+	test_hashmap();
+	test_ring();
+	test_thread();
+	test_sync();
+	test_threadlocal();
+	test_task();
+	test_clock();
+	test_profile();
 
 	test_crc32();
 
 	test_file_write();
 	test_file_read();
 	test_dir_read();
+	test_file_native();
+	test_file_vectored();
+	test_buffered();
 
 	test_qoi_read();
+	test_memstream();
+	test_mapped();
+	test_async();
 
 	return 0;
 };